@@ -7,6 +7,27 @@
 #include "ofxBezierRs.h"
 #include "bezrsToys.h"
 
+#include <chrono>
+#include <algorithm>
+
+//--------------------------------------------------------------
+// Profiling helpers
+
+inline double elapsedMs(std::chrono::steady_clock::time_point _start){
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+}
+
+// Timings of the toy being profiled (null when not profiling)
+static bezrsToyTimings* profiledTimings = nullptr;
+
+// Adds the lifetime of the scope to one phase of the profiled toy
+struct phaseTimer {
+    double bezrsToyTimings::* phase;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    phaseTimer(double bezrsToyTimings::* _phase) : phase(_phase) {}
+    ~phaseTimer(){ if(profiledTimings != nullptr) profiledTimings->*phase += elapsedMs(start); }
+};
+
 //--------------------------------------------------------------
 void bezrsToy::drawParams(const bezierShape& _sh){
     // Nothing drawn by default...
@@ -16,12 +37,79 @@ const char* bezrsToy::name_cstr(){
     return name.c_str();
 }
 
+void bezrsToy::profileFX(const bezierShape& _inShape, bezierShape& _outShape, unsigned int _iterations){
+    bezrsToyTimings frame;
+    profiledTimings = &frame;
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < std::max(_iterations, 1u); ++i){
+        _outShape = {};
+        applyFX(_inShape, _outShape);
+    }
+    double total = elapsedMs(start);
+    profiledTimings = nullptr;
+
+    // Average per call, the remainder being the C++ work around the measured phases
+    const double calls = std::max(_iterations, 1u);
+    frame.remainder = std::max(0., total - frame.ffi - frame.compute - frame.copyBack) / calls;
+    frame.ffi /= calls;
+    frame.compute /= calls;
+    frame.copyBack /= calls;
+    timings = frame;
+
+    static const std::size_t historySize = 240;
+    if(history.size() < historySize) history.push_back(frame);
+    else history[historyPos] = frame;
+    historyPos = (historyPos + 1) % historySize;
+}
+
+void bezrsToy::clearTimings(){
+    timings = {};
+    history.clear();
+    historyPos = 0;
+}
+
+void bezrsToy::drawTimings(float _x, float _y, float _width, float _height) const {
+    ofFill();
+    ofSetColor(0, 0, 0, 40);
+    ofDrawRectangle(_x, _y, _width, _height);
+    if(history.empty()) return;
+
+    // Scale on the slowest frame
+    double maxMs = 0.001;
+    for(const bezrsToyTimings& t : history) maxMs = std::max(maxMs, t.total());
+    const float barWidth = _width / history.size();
+    const float scale = _height / maxMs;
+    for(std::size_t i = 0; i < history.size(); ++i){
+        // Oldest first
+        const bezrsToyTimings& t = history[(historyPos + i) % history.size()];
+        float x = _x + i * barWidth, y = _y + _height;
+        ofSetColor(ofColor::orange);
+        ofDrawRectangle(x, y - t.ffi * scale, barWidth, t.ffi * scale);
+        y -= t.ffi * scale;
+        ofSetColor(ofColor::darkRed);
+        ofDrawRectangle(x, y - t.compute * scale, barWidth, t.compute * scale);
+        y -= t.compute * scale;
+        ofSetColor(ofColor::steelBlue);
+        ofDrawRectangle(x, y - t.copyBack * scale, barWidth, t.copyBack * scale);
+        y -= t.copyBack * scale;
+        ofSetColor(ofColor::gray);
+        ofDrawRectangle(x, y - t.remainder * scale, barWidth, t.remainder * scale);
+    }
+    ofNoFill();
+    ofDrawBitmapStringHighlight(ofToString(maxMs, 3) + " ms", _x + _width + 5, _y + 10);
+    ofDrawBitmapStringHighlight("FFI " + ofToString(timings.ffi, 3), _x, _y + _height + 15, ofColor::orange, ofColor::black);
+    ofDrawBitmapStringHighlight("Compute " + ofToString(timings.compute, 3), _x + _width * .25f, _y + _height + 15, ofColor::darkRed);
+    ofDrawBitmapStringHighlight("Copy-back " + ofToString(timings.copyBack, 3), _x + _width * .5f, _y + _height + 15, ofColor::steelBlue);
+    ofDrawBitmapStringHighlight("Remainder " + ofToString(timings.remainder, 3), _x + _width * .75f, _y + _height + 15, ofColor::gray);
+}
+
 //--------------------------------------------------------------
 // Helpers
 
 // Copies shape to raw handle then sends it to bezRS (Rust)
 // Returned handle needs to be freed later !
 inline bezrsShape* sendShapeToBezRs(const bezierShape& _inShape){
+    phaseTimer timer(&bezrsToyTimings::ffi);
     // Make raw handle
     // Note: inline is important here, as `bezRsShapeInput` needs to be guaranteed until `bezRsShape` is freed.
     bezrsShapeRaw bezRsShapeInput = { _inShape.beziers.data(), _inShape.beziers.size(), true };
@@ -33,18 +121,22 @@ inline bezrsShape* sendShapeToBezRs(const bezierShape& _inShape){
 // Retrieves bezrs shape data to oF (c++)
 // Destroys handle too
 inline void populateShapeFromBezRs(bezrsShape* bezRsShape, bezierShape& _outShape, bool destroyShape=true){
+    phaseTimer timer(&bezrsToyTimings::copyBack);
     bezrsShapeRaw offsetShapeRaw = bezrs_shape_return_handle_data(bezRsShape);
-    // Use result
-    size_t bhi = 0;
-    for (const bezrsBezierHandle* bh = offsetShapeRaw.data; bhi < offsetShapeRaw.len; bh++){
-        // Populate shape
-        _outShape.beziers.push_back(bezrsBezierHandle(*bh));
-        bhi++;
-    }
+    // Use result (bulk copy)
+    _outShape.beziers.assign(offsetShapeRaw.data, offsetShapeRaw.data + offsetShapeRaw.len);
+    _outShape.bChanged = true;
     // Destroy shape handle
     if(destroyShape) bezrs_shape_destroy(bezRsShape);
 }
 
+// Passes the input shape through, for toys that don't transform it
+inline void passShapeThrough(const bezierShape& _inShape, bezierShape& _outShape){
+    phaseTimer timer(&bezrsToyTimings::copyBack);
+    _outShape.beziers = _inShape.beziers;
+    _outShape.bChanged = true;
+}
+
 // Retrieves bezrs float data to oF (c++)
 inline std::vector<double> floatsRawToVec(bezrsFloatsRaw& _floatsRaw){
     // Copy result
@@ -86,7 +178,10 @@ void offsetToy::applyFX(const bezierShape& _inShape, bezierShape& _outShape) {
     updateParams();
 
     // Transform the shape
-    bezrs_cubic_bezier_offset(bezRsShape, offset, join, 0);
+    {
+        phaseTimer timer(&bezrsToyTimings::compute);
+        bezrs_cubic_bezier_offset(bezRsShape, offset, join, 0);
+    }
 
     // Retrieve and destroy internal handle
     populateShapeFromBezRs(bezRsShape, _outShape, true);
@@ -128,26 +223,29 @@ void offsetToy::updateParams(){
 
 //--------------------------------------------------------------
 void outlineToy::applyFX(const bezierShape& _inShape, bezierShape& _outShape) {
-    // Create internal handle
-    bezrsShape* bezRsShape = sendShapeToBezRs(_inShape);
+    // Create internal handle (RAII version, destroyed automatically)
+    ofxBezierRs::Shape bezRsShape = [&]{
+        phaseTimer timer(&bezrsToyTimings::ffi);
+        return ofxBezierRs::Shape(_inShape.beziers);
+    }();
 
     // Update vars
     updateParams();
 
-    // Transform the shape
-    bezrsShape* additionalOutlineShape = bezrs_shape_outline(bezRsShape, offset, join, bezrsCapType::Butt, 0);
+    // Transform the shape (consumes it), both outlines are owned.
+    std::pair<ofxBezierRs::Shape, ofxBezierRs::Shape> outlines = [&]{
+        phaseTimer timer(&bezrsToyTimings::compute);
+        return std::move(bezRsShape).outline(offset, join, bezrsCapType::Butt, 0);
+    }();
 
-    // Retrieve and destroy internal handle
-    populateShapeFromBezRs(bezRsShape, _outShape, true);
+    // Retrieve results
+    phaseTimer timer(&bezrsToyTimings::copyBack);
+    outlines.first.copyTo(_outShape.beziers);
+    _outShape.bChanged = true;
 
-    // Reset additional shape
+    // Store additional shape until next frame (if any)
     outlineShapeBis = {};
-
-    // Got additional shape ? (needs destruction too!)
-    if(additionalOutlineShape != nullptr){
-        // Store additional shape until next frame
-        populateShapeFromBezRs(additionalOutlineShape, outlineShapeBis, true);
-    }
+    outlines.second.copyTo(outlineShapeBis.beziers);
 }
 
 void outlineToy::drawParams(const bezierShape& _sh){
@@ -176,7 +274,10 @@ void rotationToy::applyFX(const bezierShape& _inShape, bezierShape& _outShape) {
     rotation = getModuloTime(10.f)*TWO_PI;
 
     // Transform the shape
-    bezrs_shape_rotate(bezRsShape, rotation, &center);
+    {
+        phaseTimer timer(&bezrsToyTimings::compute);
+        bezrs_shape_rotate(bezRsShape, rotation, &center);
+    }
 
     // Retrieve and destroy internal handle
     populateShapeFromBezRs(bezRsShape, _outShape, true);
@@ -205,7 +306,10 @@ void reverseWindingToy::applyFX(const bezierShape& _inShape, bezierShape& _outSh
     bezrsShape* bezRsShape = sendShapeToBezRs(_inShape);
 
     // Transform the shape
-    bezrs_shape_reverse_winding(bezRsShape);
+    {
+        phaseTimer timer(&bezrsToyTimings::compute);
+        bezrs_shape_reverse_winding(bezRsShape);
+    }
 
     // Retrieve and destroy internal handle
     populateShapeFromBezRs(bezRsShape, _outShape, true);
@@ -224,7 +328,10 @@ void boundingBoxToy::applyFX(const bezierShape& _inShape, bezierShape& _outShape
     bezrsShape* bezRsShape = sendShapeToBezRs(_inShape);
 
     // Retrieve and destroy internal handle
-    bb = bezrs_shape_boundingbox(bezRsShape);
+    {
+        phaseTimer timer(&bezrsToyTimings::compute);
+        bb = bezrs_shape_boundingbox(bezRsShape);
+    }
 
     // Place rect in shape
     _outShape.beziers = bezrs_beziers_from_rect(bb);
@@ -265,17 +372,20 @@ void hitTestToy::applyFX(const bezierShape& _inShape, bezierShape& _outShape) {
         if(simPos.y < 0 || simPos.y > ofGetHeight()) simVec.y *=-1;
     }
 
-    // Do hit tests
-    simPosHit = bezrs_shape_containspoint(bezRsShape, to_bezrsPos(simPos));
-    mousePosHit = bezrs_shape_containspoint(bezRsShape, to_bezrsPos(mousePos));
+    {
+        phaseTimer timer(&bezrsToyTimings::compute);
+
+        // Do hit tests
+        simPosHit = bezrs_shape_containspoint(bezRsShape, to_bezrsPos(simPos));
+        mousePosHit = bezrs_shape_containspoint(bezRsShape, to_bezrsPos(mousePos));
 
-    // Project points
-    mouseProjection = to_glmVec2(bezrs_shape_project_pos(bezRsShape, to_bezrsPos(mousePos)));
-    simProjection = to_glmVec2(bezrs_shape_project_pos(bezRsShape, to_bezrsPos(simPos)));
+        // Project points
+        mouseProjection = to_glmVec2(bezrs_shape_project_pos(bezRsShape, to_bezrsPos(mousePos)));
+        simProjection = to_glmVec2(bezrs_shape_project_pos(bezRsShape, to_bezrsPos(simPos)));
+    }
 
     // Place rect in shape
-    _outShape.beziers = _inShape.beziers;
-    _outShape.bChanged = true;
+    passShapeThrough(_inShape, _outShape);
 
     // Destroy manually
     bezrs_shape_destroy(bezRsShape);
@@ -305,7 +415,10 @@ void inflectionsToy::applyFX(const bezierShape& _inShape, bezierShape& _outShape
     bezrsShape* bezRsShape = sendShapeToBezRs(_inShape);
 
     // Get inflections
-    bezrsFloatsRaw tValues = bezrs_shape_inflections(bezRsShape);
+    bezrsFloatsRaw tValues = [&]{
+        phaseTimer timer(&bezrsToyTimings::compute);
+        return bezrs_shape_inflections(bezRsShape);
+    }();
     std::vector<double> floatsVec = floatsRawToVec(tValues);
     inflections.clear();
     for(const double& tval : floatsVec){
@@ -315,7 +428,10 @@ void inflectionsToy::applyFX(const bezierShape& _inShape, bezierShape& _outShape
     }
 
     // Get local extremas
-    bezrsFloatsRaw tValuesLE = bezrs_shape_localextrema(bezRsShape);
+    bezrsFloatsRaw tValuesLE = [&]{
+        phaseTimer timer(&bezrsToyTimings::compute);
+        return bezrs_shape_localextrema(bezRsShape);
+    }();
     std::vector<double> floatsVecLE = floatsRawToVec(tValuesLE);
     local_extremas.clear();
     for(const double& tval : floatsVecLE){
@@ -325,8 +441,7 @@ void inflectionsToy::applyFX(const bezierShape& _inShape, bezierShape& _outShape
     }
 
     // Place rect in shape
-    _outShape.beziers = _inShape.beziers;//bezrs_beziers_from_rect(bb);
-    _outShape.bChanged = true;
+    passShapeThrough(_inShape, _outShape);//bezrs_beziers_from_rect(bb);
 
     // Destroy manually
     bezrs_shape_destroy(bezRsShape);
@@ -365,13 +480,15 @@ void evaluateToy::applyFX(const bezierShape& _inShape, bezierShape& _outShape) {
     static const float cycle = 10.f;
     tval = getModuloTime(cycle);
     //tPos = {tval*500., 10};
-    tPos = bezrs_shape_posfromtvalue(bezRsShape, tval);
-    tNormal = bezrs_shape_normalfromtvalue(bezRsShape, tval);
-    tTangent = bezrs_shape_tangentfromtvalue(bezRsShape, tval);
-    tCurvature = bezrs_shape_curvaturefromtvalue(bezRsShape, tval);
+    {
+        phaseTimer timer(&bezrsToyTimings::compute);
+        tPos = bezrs_shape_posfromtvalue(bezRsShape, tval);
+        tNormal = bezrs_shape_normalfromtvalue(bezRsShape, tval);
+        tTangent = bezrs_shape_tangentfromtvalue(bezRsShape, tval);
+        tCurvature = bezrs_shape_curvaturefromtvalue(bezRsShape, tval);
+    }
 
-    _outShape.beziers = _inShape.beziers;
-    _outShape.bChanged = true;
+    passShapeThrough(_inShape, _outShape);
 
     // Destroy manually
     bezrs_shape_destroy(bezRsShape);
@@ -423,13 +540,21 @@ void selfIntersectToy::applyFX(const bezierShape& _inShape, bezierShape& _outSha
     offset = getSineTime(cycle)*40.f; // to animate
 
     // Transform the shape
-    bezrs_cubic_bezier_offset(bezRsShape, offset, join, 0);
+    {
+        phaseTimer timer(&bezrsToyTimings::compute);
+        bezrs_cubic_bezier_offset(bezRsShape, offset, join, 0);
+    }
 
     // Retrieve offset shape from internal handle
     populateShapeFromBezRs(bezRsShape, _outShape, false);
 
-    // Find intersections !
-    bezrsFloatsRaw intersectionTValues = bezrs_shape_selfintersections(bezRsShape, 0.001, 0.001);
+    // Find intersections ! (within a frame budget, so pathological offsets can't stall the app)
+    bezrsBudget budget = { 8.0, 1000, nullptr };
+    bezrsFloatsRaw intersectionTValues = { nullptr, 0 };
+    {
+        phaseTimer timer(&bezrsToyTimings::compute);
+        searchStatus = bezrs_shape_selfintersections_budget(bezRsShape, 0.001, 0.001, &budget, &intersectionTValues);
+    }
     floatsVec = floatsRawToVec(intersectionTValues);
 
     // Convert t-values to coordinates
@@ -457,6 +582,10 @@ void selfIntersectToy::drawParams(const bezierShape& _sh){
     textPos.y -= 30;
     ofDrawBitmapStringHighlight(std::string("Amount of self intersections: ")+ofToString(selfIntersects.size()), textPos.x, textPos.y, ofColor(ofColor::purple, 200));
     textPos.y -= 30;
+    if(searchStatus != bezrsStatus::Complete){
+        ofDrawBitmapStringHighlight(searchStatus == bezrsStatus::Truncated ? "Search stopped at 1000 intersections" : "Search stopped at its 8ms budget", textPos.x, textPos.y, ofColor(ofColor::red, 200));
+        textPos.y -= 30;
+    }
 
     // Draw self intersects
     ofSetColor(ofColor::purple);
@@ -474,3 +603,87 @@ void selfIntersectToy::drawParams(const bezierShape& _sh){
     }
 
 }
+
+//--------------------------------------------------------------
+void singlePrecisionToy::applyFX(const bezierShape& _inShape, bezierShape& _outShape) {
+    static const std::size_t numSamples = 100000;
+    static const std::size_t numPoints = 20000;
+
+    // Create internal handles : f64 shape and its f32 copy
+    bezrsShape* shapeD = sendShapeToBezRs(_inShape);
+    {
+        phaseTimer timer(&bezrsToyTimings::ffi);
+        bezrs_shapef_set_shape(shapeF.get(), shapeD);
+    }
+
+    // Batch evaluation : f32 batch vs f64 per call (the f64 reference and comparison aren't part of the compute timings)
+    ts.resize(numSamples);
+    for(std::size_t i = 0; i < numSamples; ++i) ts[i] = float(i) / float(numSamples - 1);
+    auto start = std::chrono::steady_clock::now();
+    {
+        phaseTimer timer(&bezrsToyTimings::compute);
+        shapeF.evaluate(ts, positions);
+    }
+    evalMsF = elapsedMs(start);
+    start = std::chrono::steady_clock::now();
+    maxError = 0;
+    for(std::size_t i = 0; i < numSamples; ++i){
+        bezrsPos p = bezrs_shape_posfromtvalue(shapeD, ts[i]);
+        maxError = std::max(maxError, std::max(std::abs(p.x - positions[i].x), std::abs(p.y - positions[i].y)));
+    }
+    evalMsD = elapsedMs(start);
+
+    // Hit testing random points in the window
+    points.resize(numPoints);
+    for(bezrsPosF& p : points) p = { ofRandom(0, ofGetWidth()), ofRandom(0, ofGetHeight()) };
+    start = std::chrono::steady_clock::now();
+    {
+        phaseTimer timer(&bezrsToyTimings::compute);
+        shapeF.contains(points, hits);
+    }
+    hitMsF = elapsedMs(start);
+    // The per point f64 reference is far slower than the batch, only run it for display
+    hitMismatches = 0;
+    hitMsD = 0;
+    if(!benchmarking){
+        start = std::chrono::steady_clock::now();
+        for(std::size_t i = 0; i < numPoints; ++i){
+            bool hit = bezrs_shape_containspoint(shapeD, { points[i].x, points[i].y });
+            if(hit != (hits[i] != 0)) ++hitMismatches;
+        }
+        hitMsD = elapsedMs(start);
+    }
+
+    // Flattening
+    start = std::chrono::steady_clock::now();
+    {
+        phaseTimer timer(&bezrsToyTimings::compute);
+        shapeF.flatten(0.25f, polyline);
+    }
+    flattenMs = elapsedMs(start);
+
+    passShapeThrough(_inShape, _outShape);
+
+    // Destroy manually
+    bezrs_shape_destroy(shapeD);
+}
+
+void singlePrecisionToy::drawParams(const bezierShape& _sh){
+    glm::vec2 textPos = {50, ofGetHeight() - 50};
+    ofDrawBitmapStringHighlight("Compares the single precision batch API (f32) to double precision calls (f64).", textPos.x, textPos.y);
+    textPos.y -= 30;
+    ofDrawBitmapStringHighlight("Evaluate "+ofToString(ts.size())+" t-values : f32 "+ofToString(evalMsF, 2)+" ms, f64 "+ofToString(evalMsD, 2)+" ms, max error "+ofToString(maxError, 6), textPos.x, textPos.y);
+    textPos.y -= 30;
+    ofDrawBitmapStringHighlight("Hit test "+ofToString(points.size())+" points : f32 "+ofToString(hitMsF, 2)+" ms, f64 "+ofToString(hitMsD, 2)+" ms, mismatches "+ofToString(hitMismatches), textPos.x, textPos.y);
+    textPos.y -= 30;
+    ofDrawBitmapStringHighlight("Flatten : "+ofToString(polyline.size())+" points in "+ofToString(flattenMs, 3)+" ms, f32 shape memory "+ofToString(shapeF.memorySize())+" bytes", textPos.x, textPos.y);
+    textPos.y -= 30;
+
+    // Draw the f32 polyline
+    ofSetColor(ofColor::darkCyan);
+    for(std::size_t i = 0; i < polyline.size(); ++i){
+        const bezrsPosF& a = polyline[i];
+        const bezrsPosF& b = polyline[(i + 1) % polyline.size()];
+        ofDrawLine(a.x, a.y, b.x, b.y);
+    }
+}
@@ -6,6 +6,15 @@
 #include <vector>
 
 
+// Time spent in applyFX(), split by phase (milliseconds per call)
+struct bezrsToyTimings {
+	double ffi = 0.;       // Crossing into Rust : building internal shapes from C++ handles
+	double compute = 0.;   // Rust computation : the `bezrs_*` calls of the effect
+	double copyBack = 0.;  // Copying results back into C++ shapes
+	double remainder = 0.; // Not measured directly : total minus the other phases, the C++ work of the effect
+	double total() const { return ffi + compute + copyBack + remainder; }
+};
+
 class bezrsToy {
 	const std::string name;
 
@@ -17,6 +26,21 @@ class bezrsToy {
 	virtual void applyFX(const bezierShape& _inShape, bezierShape& _outShape) = 0;
 	//virtual void renderShape(const bezrsShape& _sh);
 	virtual void drawParams(const bezierShape& _sh);
+
+	// Stress mode : runs applyFX() `_iterations` times and records the average timings
+	void profileFX(const bezierShape& _inShape, bezierShape& _outShape, unsigned int _iterations = 1);
+	const bezrsToyTimings& getTimings() const { return timings; }
+	void clearTimings();
+	// Stacked graph of the recorded timings (FFI, compute, copy-back, remainder)
+	void drawTimings(float _x, float _y, float _width, float _height) const;
+	// Headless benchmark : toys skip the work only needed for display (reference comparisons, ...)
+	void setBenchmarking(bool _benchmarking){ benchmarking = _benchmarking; }
+
+	protected:
+	bezrsToyTimings timings;
+	std::vector<bezrsToyTimings> history; // Ring buffer of the last profiled frames
+	std::size_t historyPos = 0;
+	bool benchmarking = false;
 };
 
 
@@ -121,6 +145,23 @@ class selfIntersectToy : public offsetToy {
 	protected:
 	std::vector<bezrsPos> selfIntersects;
 	std::vector<double> floatsVec;
+	bezrsStatus searchStatus = bezrsStatus::Complete;
+};
+
+class singlePrecisionToy : public bezrsToy {
+	public:
+	singlePrecisionToy() : bezrsToy("Single Precision Bench"){};
+	void applyFX(const bezierShape& _inShape, bezierShape& _outShape) override;
+	void drawParams(const bezierShape& _sh) override;
+
+	protected:
+	ofxBezierRs::ShapeF shapeF;
+	std::vector<float> ts;
+	std::vector<bezrsPosF> positions, points, polyline;
+	std::vector<std::uint8_t> hits;
+	double evalMsF = 0, evalMsD = 0, hitMsF = 0, hitMsD = 0, flattenMs = 0;
+	double maxError = 0;
+	std::size_t hitMismatches = 0;
 };
 
 // Todo : Global vs Euclidean tvalues
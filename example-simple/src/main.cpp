@@ -1,8 +1,31 @@
 #include "ofMain.h"
 #include "ofApp.h"
+#include "ofAppNoWindow.h"
 
 //========================================================================
-int main( ){
+int main(int argc, char* argv[]){
+	// Headless benchmark ? (--bench [--iterations N])
+	bool bench = false;
+	unsigned int iterations = 10;
+	for(int i = 1; i < argc; i++){
+		std::string arg = argv[i];
+		if(arg == "--bench") bench = true;
+		else if(arg == "--iterations" && i + 1 < argc) iterations = std::max(1, std::atoi(argv[++i]));
+	}
+
+	if(bench){
+		// Same size as the interactive window : the stress shapes and toys scale with it
+		ofWindowSettings settings;
+		settings.setSize(1024, 768);
+		auto window = std::make_shared<ofAppNoWindow>();
+		window->setup(settings);
+		auto app = std::make_shared<ofApp>();
+		app->bBench = true;
+		app->benchIterations = iterations;
+		ofRunApp(window, app);
+		return ofRunMainLoop();
+	}
+
 	ofSetupOpenGL(1024,768,OF_WINDOW);			// <-------- setup the GL context
 
 	// this kicks off the running of my app
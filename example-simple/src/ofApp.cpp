@@ -1,4 +1,7 @@
 #include "ofApp.h"
+#include <iostream>
+
+const std::vector<std::size_t> ofApp::stressSizes = { 1000, 10000, 100000 };
 
 //--------------------------------------------------------------
 void ofApp::setup(){
@@ -12,6 +15,14 @@ void ofApp::setup(){
     toys.push_back(new inflectionsToy());
     toys.push_back(new evaluateToy());
     toys.push_back(new selfIntersectToy());
+    toys.push_back(new singlePrecisionToy());
+
+    // Headless ?
+    if(bBench){
+        runBench();
+        ofExit();
+        return;
+    }
 
     // Generate an initial drawing
     generateNewShape();
@@ -30,7 +41,8 @@ void ofApp::update(){
         if(shape.beziers.size()>1){ // BezRs needs at least 2 points not to panic
             bezrsToy* toy = toys[currentToy];
             if(toy){
-                toy->applyFX(shape, fxShape);
+                if(bStress) toy->profileFX(shape, fxShape, stressIterations);
+                else toy->applyFX(shape, fxShape);
             }
         }
 
@@ -57,6 +69,8 @@ void ofApp::draw(){
         textY+=30;
         ofDrawBitmapStringHighlight("Use arrows to change toy. (--> <--)", 50, textY, ofColor(0,0,0,100), ofColor(255,255,255));
         textY+=30;
+        ofDrawBitmapStringHighlight("Stress mode: S=Toggle, +/-=Handles, [/]=Iterations per frame", 50, textY, ofColor(0,0,0,100), ofColor(255,255,255));
+        textY+=30;
     }
 
     glm::vec2 infoTextPos(ofGetWidth()-50-200, 50);
@@ -70,6 +84,37 @@ void ofApp::draw(){
         ofDrawBitmapStringHighlight(ofToString("Points: ")+ofToString(fxShape.beziers.size()), infoTextPos.x, infoTextPos.y, ofColor(0,0,0,100), ofColor(255,255,255));
     }
 
+    // Stress mode : anchors only (drawing every handle is slower than the toys)
+    if(bStress){
+        ofNoFill();
+        ofSetColor(ofColor::black);
+        ofPolyline anchors;
+        for(const bezrsBezierHandle& bh : shape.beziers) anchors.addVertex(bh.pos.x, bh.pos.y);
+        anchors.close();
+        anchors.draw();
+        if(fxShape.beziers.size()>1){
+            ofSetColor(ofColor::red);
+            ofPolyline fxAnchors;
+            for(const bezrsBezierHandle& bh : fxShape.beziers) fxAnchors.addVertex(bh.pos.x, bh.pos.y);
+            fxAnchors.close();
+            fxAnchors.draw();
+        }
+
+        // Timings of the current toy, then the last ones of all toys
+        bezrsToy* toy = toys[currentToy];
+        ofDrawBitmapStringHighlight(ofToString(toy->name_cstr()) + " : " + ofToString(shape.beziers.size()) + " handles, " + ofToString(stressIterations) + " iterations/frame", 50, textY, ofColor(0,0,0,100), ofColor(255,255,255));
+        textY+=20;
+        toy->drawTimings(50, textY, 480, 120);
+        textY+=160;
+        for(bezrsToy* t : toys){
+            const bezrsToyTimings& timings = t->getTimings();
+            if(timings.total() <= 0.) continue;
+            ofDrawBitmapStringHighlight(ofToString(t->name_cstr()) + " : " + ofToString(timings.total(), 3) + " ms (FFI " + ofToString(timings.ffi, 3) + ", compute " + ofToString(timings.compute, 3) + ", copy-back " + ofToString(timings.copyBack, 3) + ", remainder " + ofToString(timings.remainder, 3) + ")", 50, textY, ofColor(ofColor::black, t==toy?255:100));
+            textY+=20;
+        }
+        return;
+    }
+
     // Draw the main shape
     shape.draw();
 
@@ -166,7 +211,26 @@ void ofApp::keyReleased(int key){
         bezierShape::bShowNumbers = !bezierShape::bShowNumbers;
     }
     else if(key==OF_KEY_PAGE_DOWN){
-        generateNewShape();
+        if(bStress) generateStressShape(stressSizes[stressSize]);
+        else generateNewShape();
+    }
+    else if(key=='s' || key=='S'){
+        // Toggle stress mode
+        bStress = !bStress;
+        for(bezrsToy* t : toys) t->clearTimings();
+        if(bStress) generateStressShape(stressSizes[stressSize]);
+        else generateNewShape();
+    }
+    else if(bStress && (key=='+' || key=='=' || key=='-')){
+        if(key=='-') stressSize = stressSize==0 ? 0 : stressSize-1;
+        else stressSize = std::min<unsigned int>(stressSize+1, stressSizes.size()-1);
+        for(bezrsToy* t : toys) t->clearTimings();
+        generateStressShape(stressSizes[stressSize]);
+    }
+    else if(bStress && (key=='[' || key==']')){
+        if(key=='[') stressIterations = std::max(1u, stressIterations/2);
+        else stressIterations = std::min(1024u, stressIterations*2);
+        toys[currentToy]->clearTimings();
     }
 
     // Handle toy slider
@@ -282,3 +346,43 @@ void ofApp::generateNewShape(){
     shape.bChanged = true;
 }
 
+//--------------------------------------------------------------
+void ofApp::generateStressShape(std::size_t _numHandles){
+    // Noisy closed star with smooth handles, filling the window
+    shape.beziers.clear();
+    shape.beziers.reserve(_numHandles);
+    glm::vec2 center = {ofGetWidth()*.5, ofGetHeight()*.5};
+    const float radius = std::min(ofGetWidth(), ofGetHeight())*.4f;
+    const float step = TWO_PI/_numHandles;
+    for(std::size_t i=0; i<_numHandles; i++){
+        float angle = i*step;
+        float r = radius*(.8f + .15f*(i%2) + ofRandom(0.f,.05f));
+        glm::vec2 dir = {cos(angle), sin(angle)};
+        glm::vec2 pos = center + dir*r;
+        glm::vec2 tan = glm::vec2(-dir.y, dir.x) * (r*step*.3f);
+        bezrsBezierHandle bh = {
+            {pos.x, pos.y},
+            {pos.x-tan.x, pos.y-tan.y},
+            {pos.x+tan.x, pos.y+tan.y}
+        };
+        shape.beziers.push_back(bh);
+    }
+    shape.bChanged = true;
+}
+
+//--------------------------------------------------------------
+void ofApp::runBench(){
+    // One warm-up call per toy and size, then the averaged timings
+    std::cout << "toy,handles,iterations,ffi_ms,compute_ms,copyback_ms,remainder_ms,total_ms" << std::endl;
+    for(bezrsToy* toy : toys) toy->setBenchmarking(true);
+    for(std::size_t size : stressSizes){
+        generateStressShape(size);
+        for(bezrsToy* toy : toys){
+            toy->profileFX(shape, fxShape, 1);
+            toy->profileFX(shape, fxShape, benchIterations);
+            const bezrsToyTimings& timings = toy->getTimings();
+            std::cout << toy->name_cstr() << ',' << size << ',' << benchIterations << ','
+                << timings.ffi << ',' << timings.compute << ',' << timings.copyBack << ',' << timings.remainder << ',' << timings.total() << std::endl;
+        }
+    }
+}
@@ -26,6 +26,8 @@ class ofApp : public ofBaseApp{
 		void dragEvent(ofDragInfo dragInfo);
 		void gotMessage(ofMessage msg);
 		void generateNewShape();
+		void generateStressShape(std::size_t _numHandles);
+		void runBench();
 		
 		bezierShape shape;
 		bezierShape fxShape;
@@ -41,4 +43,14 @@ class ofApp : public ofBaseApp{
 		bool bShowInfo = true;
 		bool bAnimate = true;
 		//bool bShowNumbers = true;
+
+		// Stress mode : large synthetic shapes, profiled every frame
+		bool bStress = false;
+		unsigned int stressSize = 0; // Index in stressSizes
+		unsigned int stressIterations = 1; // applyFX() calls per frame
+		static const std::vector<std::size_t> stressSizes;
+
+		// Headless benchmark (--bench) : prints a CSV of every toy at every stress size, then exits
+		bool bBench = false;
+		unsigned int benchIterations = 10;
 };
@@ -21,6 +21,12 @@ enum class bezrsCapType {
   Square,
 };
 
+/// Fill rule enum
+enum class bezrsFillRule {
+  NonZero,
+  EvenOdd,
+};
+
 /// Join type enum
 enum class bezrsJoinType {
   Bevel,
@@ -28,10 +34,75 @@ enum class bezrsJoinType {
   Round,
 };
 
+/// Scalar type of strided point data
+enum class bezrsScalarType {
+  Float,
+  Double,
+};
+
+/// Outcome of an operation running within a budget (see `bezrsBudget`)
+enum class bezrsStatus {
+  /// Finished
+  Complete,
+  /// Stopped at the result cap : the first `max_results` results are returned
+  Truncated,
+  /// Stopped at the deadline
+  TimedOut,
+  /// Stopped by its cancellation token
+  Cancelled,
+};
+
+/// Placement of the samples of a width profile (see `bezrs_shape_outline_variable()`)
+enum class bezrsWidthMode {
+  /// At global t-values (0 -> 1, each segment spanning an equal part)
+  GlobalT,
+  /// At normalized arc length (0 -> 1)
+  ArcLength,
+  /// One sample per anchor, in order (t is ignored)
+  PerHandle,
+};
+
+/// Winding direction, from the sign of the enclosed area : clockwise on screen (y axis down) is positive.
+enum class bezrsWinding {
+  /// Null area (lines, degenerate shapes), or keeping the given direction
+  None,
+  Clockwise,
+  CounterClockwise,
+};
+
+/// Opaque cancellation token, shared between the thread running an operation and the one cancelling it (see `bezrsBudget`).
+/// (allocated on rust side, needs to be freed properly)
+struct bezrsCancelToken;
+
+/// Opaque compound shape : several subpaths filled together with a fill rule (for shapes with holes).
+/// (allocated on rust side, needs to be freed properly)
+struct bezrsCompoundShape;
+
+/// Opaque packed multi-shape container, for operations that produce many shapes.
+/// Reuse it across calls : its buffers are recycled. (allocated on rust side, needs to be freed properly)
+struct bezrsMultiShape;
+
+/// Opaque incremental offset state : keeps per-segment offset results of a shape being edited (see `bezrs_incremental_offset_create()`).
+/// (allocated on rust side, needs to be freed properly)
+struct bezrsIncrementalOffset;
+
+/// Opaque morph between keyframe shapes, keeping their handle correspondence across frames (see `bezrs_morph_create()`).
+/// (allocated on rust side, needs to be freed properly)
+struct bezrsMorph;
+
 /// Opaque internal shape data handle
 /// (use only as pointer! allocated on rust side, needs to be freed properly)
 struct bezrsShape;
 
+/// Opaque single precision shape : segments stored and evaluated in f32, using half the memory of a `bezrsShape`.
+/// For batch evaluation, hit testing and flattening where f32 accuracy is enough (see `bezrs_shapef_create()`).
+/// (allocated on rust side, needs to be freed properly)
+struct bezrsShapeF;
+
+/// Opaque incremental curve fitter, turning a growing stroke into cubic segments (see `bezrs_stroke_fitter_create()`).
+/// (allocated on rust side, needs to be freed properly)
+struct bezrsStrokeFitter;
+
 /// A simple position wrapper (x, y)
 struct bezrsPos {
   double x;
@@ -50,6 +121,19 @@ struct bezrsBezierHandle {
   }
 };
 
+/// Single precision position (x, y), same layout as `glm::vec2` (see `bezrs_shapef_create()`).
+struct bezrsPosF {
+  float x;
+  float y;
+};
+
+/// Single precision bezier handle
+struct bezrsBezierHandleF {
+  bezrsPosF pos;
+  bezrsPosF in_bez;
+  bezrsPosF out_bez;
+};
+
 using SizeTC = unsigned long;
 
 /// Raw vector handle representing a bezier shape
@@ -63,11 +147,98 @@ struct bezrsShapeRaw {
   bool closed;
 };
 
+/// Limits for long running operations. Zeroed fields mean no limit.
+struct bezrsBudget {
+  /// Time allowed for the call, in milliseconds (<= 0 : unlimited)
+  double time_limit_ms;
+  /// Maximum amount of results (0 : unlimited)
+  SizeTC max_results;
+  /// Optional token for cancelling the call from another thread (can be null)
+  const bezrsCancelToken *cancel;
+};
+
 struct bezrsRect {
   bezrsPos pos;
   bezrsPos size;
 };
 
+/// Infinite line through `origin` along `direction`. Positions along it are parameters t, at origin + t * direction.
+struct bezrsLine {
+  bezrsPos origin;
+  bezrsPos direction;
+};
+
+/// One move of a toolpath : a line or a circular arc, starting where the previous move ended (the first one at the start of the shape).
+struct bezrsToolpathMove {
+  /// End point
+  bezrsPos end;
+  /// Center of the arc (the end point for lines)
+  bezrsPos center;
+  /// Signed angle swept by the arc in radians, 0 for lines. Positive turns from +x towards +y :
+  /// counter-clockwise with the y axis up (G-code G3), clockwise on screen (y axis down, G2 once flipped).
+  double sweep;
+};
+
+/// Receives toolpath moves by chunks (see `bezrs_shape_biarcs_stream()`). Returning false stops the approximation.
+using bezrsToolpathCallback = bool(*)(const bezrsToolpathMove *_moves, SizeTC _len, void *_user_data);
+
+/// Metrics of a shape, computed in a single pass (see `bezrs_shape_metrics()`).
+struct bezrsShapeMetrics {
+  /// Enclosed area, positive when winding clockwise on screen (open paths are implicitly closed by a line)
+  double signed_area;
+  /// Winding direction (from the sign of the area)
+  bezrsWinding winding;
+  /// Centroid of the enclosed area (of the curve itself when the area is null)
+  bezrsPos centroid;
+  /// Arc length
+  double length;
+  /// Tight bounding box of the curve
+  bezrsRect bounds;
+};
+
+/// Rust owned polyline of a shape (see `bezrs_shape_lod_polyline()`).
+struct bezrsPolylineRaw {
+  /// Points, closed shapes ending with their start point (null when empty)
+  const bezrsPos *data;
+  /// count of points
+  SizeTC len;
+  /// Tolerance of the cached level, in shape units
+  double tolerance;
+};
+
+/// One sample of a width profile (see `bezrs_shape_outline_variable()`).
+struct bezrsWidthSample {
+  /// Position along the shape, as set by `bezrsWidthMode`
+  double t;
+  /// Stroke width : each side is offset by half of it
+  double width;
+};
+
+/// Compiled shape segment, for evaluating the shape without crossing the FFI.
+/// Power basis : pos(t) = c[0] + c[1]*t + c[2]*t^2 + c[3]*t^3, with t local to the segment (0->1).
+struct bezrsCompiledSegment {
+  /// x coefficients, from constant to cubic term
+  double x[4];
+  /// y coefficients, from constant to cubic term
+  double y[4];
+  /// Arc length of all previous segments (length prefix)
+  double length_start;
+  /// Arc length of this segment
+  double length;
+};
+
+/// 2x3 affine matrix, laid out like SVG's `matrix(a,b,c,d,e,f)` :
+/// x' = a*x + c*y + tx
+/// y' = b*x + d*y + ty
+struct bezrsAffine {
+  double a;
+  double b;
+  double c;
+  double d;
+  double tx;
+  double ty;
+};
+
 /// Raw vector of floats
 /// Used for sending owned data from Rust to C++ in both directions.
 struct bezrsFloatsRaw {
@@ -77,15 +248,77 @@ struct bezrsFloatsRaw {
   SizeTC len;
 };
 
+/// Location of one shape within a packed multi-shape handle buffer
+struct bezrsShapeSpan {
+  /// index of the first handle
+  SizeTC offset;
+  /// count of handles
+  SizeTC len;
+  /// if true, behave as shape, otherwise behave as path.
+  bool closed;
+};
+
+/// Raw packed multi-shape : all handles in one buffer, plus one span per shape.
+/// When Rust owned, valid until the multi-shape (or compound shape) is modified or destroyed.
+/// Also used for sending packed subpaths from C++ in one copy (see `bezrs_compound_create()`).
+struct bezrsMultiShapeRaw {
+  /// All handles of all shapes, contiguous
+  const bezrsBezierHandle *handles;
+  /// count of handles
+  SizeTC handles_len;
+  /// One span per shape
+  const bezrsShapeSpan *shapes;
+  /// count of shapes
+  SizeTC shapes_len;
+};
+
+/// Strided stream of 2D points in caller memory : x then y (floats or doubles), one point every `stride` bytes.
+/// Any extra components (like z in `glm::vec3`, stride 12) are skipped. A stride of 0 means tightly packed x,y pairs.
+struct bezrsPointStream {
+  /// First point (can be null for an absent stream)
+  const void *data;
+  /// Bytes between 2 consecutive points
+  SizeTC stride;
+  /// Type of x and y
+  bezrsScalarType scalar;
+};
+
+/// Bezier handles as separate strided streams, read in place (see `bezrs_shape_create_strided()`).
+struct bezrsStridedHandles {
+  /// Anchor positions
+  bezrsPointStream anchors;
+  /// In handles (null data : collapsed onto the anchors)
+  bezrsPointStream in_handles;
+  /// Out handles (null data : collapsed onto the anchors)
+  bezrsPointStream out_handles;
+  /// count of handles in each stream
+  SizeTC len;
+  /// if true, behave as shape, otherwise behave as path.
+  bool closed;
+};
+
 extern "C" {
 
 /// Create a shape instance in rust memory : needs to be freed afterwards. Also, `beziers_opt` needs to remain valid (and static) until freed.
 bezrsShape *bezrs_shape_create(const bezrsShapeRaw *beziers_opt,
                                bool closed);
 
+/// Creates a shape like `bezrs_shape_create()`, reversing the handles if needed so that it winds in `_winding`
+/// (`bezrsWinding::Clockwise` is what offsets and outlines expect). A cheap signed area test, `bezrsWinding::None` keeps them as given.
+bezrsShape *bezrs_shape_create_oriented(const bezrsShapeRaw *beziers_opt,
+                                        bool closed,
+                                        bezrsWinding _winding);
+
 /// To destroy an internal shape handle when you don't need it anymore.
 void bezrs_shape_destroy(bezrsShape *_bezier);
 
+/// Creates a new shape sharing the geometry of `_shape` in O(1) : the geometry is only copied when one of them is mutated (copy on write).
+/// Cheap snapshots for undo history or non-destructive operations. Clones are independent shapes, to destroy separately.
+bezrsShape *bezrs_shape_clone(bezrsShape *_shape);
+
+/// Returns true while the geometry of `_shape` is shared with clones (see `bezrs_shape_clone()`) : its next mutation will copy it.
+bool bezrs_shape_is_shared(bezrsShape *_shape);
+
 /// Inserts a bezier to the shape at a given position
 void bezrs_shape_insert_bezier(bezrsShape *_shape, bezrsBezierHandle _bez, SizeTC _pos);
 
@@ -102,17 +335,409 @@ SizeTC bezrs_shape_info_segments(bezrsShape *_shape);
 void bezrs_shape_reverse_winding(bezrsShape *_shape);
 
 /// To retrieve the data of an internal shape handle.
+/// The data stays valid (and is returned again without conversion) until the shape is mutated or destroyed.
 bezrsShapeRaw bezrs_shape_return_handle_data(bezrsShape *_shape);
 
+/// Returns whether the shape is closed (without returning its data).
+bool bezrs_shape_is_closed(bezrsShape *_shape);
+
+/// Replaces all bezier handles of an existing shape in one bulk copy.
+/// The internal storage is reused, so re-assigning similarly sized data doesn't allocate.
+void bezrs_shape_set_handle_data(bezrsShape *_shape, const bezrsShapeRaw *beziers_opt, bool closed);
+
+/// Create a shape instance from strided streams, reading the caller's layout directly (no conversion to `bezrsBezierHandle` needed).
+/// The data is copied : it doesn't need to outlive the call. Needs to be freed afterwards.
+bezrsShape *bezrs_shape_create_strided(const bezrsStridedHandles *_handles);
+
+/// Replaces all bezier handles of an existing shape from strided streams, in one pass. The internal storage is reused.
+void bezrs_shape_set_strided(bezrsShape *_shape, const bezrsStridedHandles *_handles);
+
+/// Creates an empty multi-shape container : needs to be freed afterwards.
+bezrsMultiShape *bezrs_multishape_create();
+
+/// To destroy a multi-shape container when you don't need it anymore.
+void bezrs_multishape_destroy(bezrsMultiShape *_multi_shape);
+
+/// To retrieve the packed data of a multi-shape container.
+bezrsMultiShapeRaw bezrs_multishape_return_data(bezrsMultiShape *_multi_shape);
+
+/// Creates a shape instance from one shape of a multi-shape container (or an empty one if out of range) : needs to be freed afterwards.
+bezrsShape *bezrs_multishape_extract_shape(bezrsMultiShape *_multi_shape, SizeTC _index);
+
+/// Creates a compound shape from packed subpaths (copied, can be null for an empty one) : needs to be freed afterwards.
+/// The output of `bezrs_multishape_return_data()` or `bezrs_compound_return_data()` can be passed directly.
+bezrsCompoundShape *bezrs_compound_create(const bezrsMultiShapeRaw *_subpaths, bezrsFillRule _fill_rule);
+
+/// To destroy a compound shape when you don't need it anymore.
+void bezrs_compound_destroy(bezrsCompoundShape *_compound);
+
+/// Replaces all subpaths of a compound shape from packed subpaths, in one bulk copy.
+void bezrs_compound_set_data(bezrsCompoundShape *_compound, const bezrsMultiShapeRaw *_subpaths);
+
+/// Appends a copy of a shape as a new subpath of the compound shape.
+void bezrs_compound_add_shape(bezrsCompoundShape *_compound, bezrsShape *_shape);
+
+/// To retrieve the packed subpaths of a compound shape.
+bezrsMultiShapeRaw bezrs_compound_return_data(bezrsCompoundShape *_compound);
+
+/// Returns the amount of subpaths in the compound shape
+SizeTC bezrs_compound_info_size(bezrsCompoundShape *_compound);
+
+/// Returns the fill rule of the compound shape
+bezrsFillRule bezrs_compound_get_fill_rule(bezrsCompoundShape *_compound);
+
+/// Sets the fill rule of the compound shape
+void bezrs_compound_set_fill_rule(bezrsCompoundShape *_compound, bezrsFillRule _fill_rule);
+
+/// Returns if a point is within the filled area of the compound shape (holes excluded), in a single call.
+bool bezrs_compound_containspoint(bezrsCompoundShape *_compound, bezrsPos _pos);
+
+/// Returns the bounding box of all subpaths of the compound shape
+bezrsRect bezrs_compound_boundingbox(bezrsCompoundShape *_compound);
+
+/// Applies an affine transformation to all subpaths of the compound shape, in place.
+void bezrs_compound_transform(bezrsCompoundShape *_compound, bezrsAffine _matrix);
+
+/// Offsets the filled area of the compound shape : positive offsets shrink it (holes grow), negative offsets grow it.
+/// Subpaths are re-oriented according to their role : outer contours wind clockwise, holes counter-clockwise.
+void bezrs_compound_offset(bezrsCompoundShape *_compound,
+                           double offset,
+                           bezrsJoinType join_type,
+                           double join_mitter);
+
+/// Replaces every subpath of the compound shape by its outline (closed subpaths give 2 rings), in place.
+/// The fill rule becomes non-zero, with rings oriented so that overlapping outlines merge.
+void bezrs_compound_outline(bezrsCompoundShape *_compound,
+                            double distance,
+                            bezrsJoinType join,
+                            bezrsCapType cap,
+                            double miter_limit);
+
+/// Hatch fill of the compound shape, holes included, using its fill rule (see `bezrs_shape_hatch()`, including its cap on the amount of lines).
+/// Returns the amount of hatch segments.
+SizeTC bezrs_compound_hatch(bezrsCompoundShape *_compound,
+                            double _angle,
+                            double _spacing,
+                            double _phase,
+                            bool _alternate,
+                            bezrsMultiShape *_out);
+
+/// Replaces the shape by the fewest cubic segments fitting a dense polyline (pen strokes, traced bitmaps) within `_tolerance` (distance).
+/// Points turning more than `_corner_angle` radians are kept as sharp corners (0 disables corner detection).
+/// When `_closed`, the polyline loops back to its first point.
+void bezrs_shape_fit_points(bezrsShape *_shape,
+                            const bezrsPos *_points,
+                            SizeTC _len,
+                            double _tolerance,
+                            double _corner_angle,
+                            bool _closed);
+
+/// Merges runs of adjacent segments that a single cubic re-fits within `_tolerance` (distance), in place. Returns the new amount of segments.
+/// Use it after offsets and outlines, which split curves : repeated operations then keep a stable size.
+/// Joins turning more than `_corner_angle` radians are never merged (0 lets the tolerance alone decide).
+SizeTC bezrs_shape_simplify(bezrsShape *_shape, double _tolerance, double _corner_angle);
+
+/// Creates an incremental offset state, for offsetting a shape that is edited a few handles at a time.
+/// Each update only recomputes the segments whose handles changed, plus the joins around them, then splices the result.
+/// Segments are offset within `_tolerance` (distance), joins behave like `bezrs_cubic_bezier_offset()`. Needs to be freed afterwards.
+bezrsIncrementalOffset *bezrs_incremental_offset_create(double _offset,
+                                                        bezrsJoinType _join_type,
+                                                        double _join_mitter,
+                                                        double _tolerance);
+
+/// To destroy an incremental offset state when you don't need it anymore.
+void bezrs_incremental_offset_destroy(bezrsIncrementalOffset *_incremental);
+
+/// Changes the offset parameters. Any change discards the cached results : the next update recomputes everything.
+void bezrs_incremental_offset_set_params(bezrsIncrementalOffset *_incremental,
+                                         double _offset,
+                                         bezrsJoinType _join_type,
+                                         double _join_mitter,
+                                         double _tolerance);
+
+/// Offsets `_source` into `_out` (which is replaced), reusing the results of the previous update for unchanged segments.
+/// Returns the amount of segments that had to be recomputed.
+SizeTC bezrs_incremental_offset_update(bezrsIncrementalOffset *_incremental,
+                                       bezrsShape *_source,
+                                       bezrsShape *_out);
+
+/// Creates an incremental curve fitter : feed it points as a stroke grows, only the tail of the stroke is refitted on each update.
+/// Same parameters as `bezrs_shape_fit_points()`. Needs to be freed afterwards.
+bezrsStrokeFitter *bezrs_stroke_fitter_create(double _tolerance, double _corner_angle);
+
+/// To destroy a stroke fitter when you don't need it anymore.
+void bezrs_stroke_fitter_destroy(bezrsStrokeFitter *_fitter);
+
+/// Forgets all points, to start a new stroke.
+void bezrs_stroke_fitter_clear(bezrsStrokeFitter *_fitter);
+
+/// Appends points to the stroke and refits its tail. Returns the total amount of points of the stroke.
+SizeTC bezrs_stroke_fitter_add_points(bezrsStrokeFitter *_fitter, const bezrsPos *_points, SizeTC _len);
+
+/// Writes the current fit of the stroke into a shape (as an open path). Returns the amount of segments.
+SizeTC bezrs_stroke_fitter_to_shape(bezrsStrokeFitter *_fitter, bezrsShape *_shape);
+
+/// Creates a morph, for interpolating shapes between keyframes (see `bezrs_morph_set_keyframes()`). Needs to be freed afterwards.
+bezrsMorph *bezrs_morph_create();
+
+/// To destroy a morph when you don't need it anymore.
+void bezrs_morph_destroy(bezrsMorph *_morph);
+
+/// Sets the keyframe shapes, evenly spread over the morph (t=0 : first keyframe, t=1 : last keyframe) and copied.
+/// Keyframes with the same amount of handles correspond handle by handle. Otherwise, they get resampled to the
+/// largest amount of segments and closed ones are aligned on each other (winding and start anchor).
+/// This correspondence is only computed here : call it again when the keyframes change, not every frame.
+/// Returns false and keeps the previous keyframes when a shape is null or degenerate (no segments), as dropping it would shift the timing of the next ones.
+/// Use `bezrs_morph_info_size()` for the amount of handles of the morphed shape.
+bool bezrs_morph_set_keyframes(bezrsMorph *_morph, const bezrsShape *const *_shapes, SizeTC _count);
+
+/// Eases the blend between two keyframes with a CSS-like timing curve from (0,0) to (1,1), `_c1` and `_c2` being its control points.
+/// Pass null control points for a linear blend (the default).
+void bezrs_morph_set_easing(bezrsMorph *_morph, const bezrsPos *_c1, const bezrsPos *_c2);
+
+/// Amount of handles of the morphed shape
+SizeTC bezrs_morph_info_size(bezrsMorph *_morph);
+
+/// Returns true when the keyframes needed resampling to correspond, so the morphed handles don't match the keyframe handles.
+bool bezrs_morph_is_resampled(bezrsMorph *_morph);
+
+/// Writes the shape at `_t` (0 -> 1 over all keyframes) into `_target`, in place when it already has the right amount of handles.
+void bezrs_morph_apply(bezrsMorph *_morph, double _t, bezrsShape *_target);
+
+/// Writes the handles at `_t` straight into caller memory (for drawing them without a shape).
+/// Writes at most `_capacity` handles and returns the total amount of handles : call with a null `_out` to query the required size.
+SizeTC bezrs_morph_apply_handles(bezrsMorph *_morph,
+                                 double _t,
+                                 bezrsBezierHandle *_out,
+                                 SizeTC _capacity);
+
+/// Applies many morphs at once, `_targets[i]` receiving `_morphs[i]` at `_ts[i]`.
+/// Large batches are spread over multiple threads : all target shapes must be distinct (morphs can be shared).
+void bezrs_morphs_apply(const bezrsMorph *const *_morphs,
+                        const double *_ts,
+                        bezrsShape *const *_targets,
+                        SizeTC _count);
+
+/// Creates a single precision copy of a shape (or an empty one from a null shape). Needs to be freed afterwards.
+bezrsShapeF *bezrs_shapef_create(bezrsShape *_shape);
+
+/// Creates a single precision shape straight from float handles (no double precision copy involved). Needs to be freed afterwards.
+bezrsShapeF *bezrs_shapef_create_from_handles(const bezrsBezierHandleF *_handles,
+                                              SizeTC _len,
+                                              bool _closed);
+
+/// To destroy a single precision shape when you don't need it anymore.
+void bezrs_shapef_destroy(bezrsShapeF *_shapef);
+
+/// Replaces the geometry by a single precision copy of `_shape`. The internal storage is reused.
+void bezrs_shapef_set_shape(bezrsShapeF *_shapef, bezrsShape *_shape);
+
+/// Replaces the geometry from float handles. The internal storage is reused.
+void bezrs_shapef_set_handles(bezrsShapeF *_shapef,
+                              const bezrsBezierHandleF *_handles,
+                              SizeTC _len,
+                              bool _closed);
+
+/// Amount of segments of the single precision shape
+SizeTC bezrs_shapef_info_segments(bezrsShapeF *_shapef);
+
+/// Bytes used by the geometry of the single precision shape (including the containment data, once built)
+SizeTC bezrs_shapef_memory_size(bezrsShapeF *_shapef);
+
+/// Evaluates positions at many global t-values (0->1 over the whole shape) into `_out` (`_count` positions). Multithreaded for large batches.
+void bezrs_shapef_evaluate(bezrsShapeF *_shapef, const float *_ts, SizeTC _count, bezrsPosF *_out);
+
+/// Hit tests many points at once, writing 1 (inside) or 0 (outside) per point into `_out`. Paths are implicitly closed.
+/// The containment data is built on the first call. Multithreaded for large batches.
+void bezrs_shapef_containspoints(bezrsShapeF *_shapef,
+                                 const bezrsPosF *_points,
+                                 SizeTC _count,
+                                 bezrsFillRule _fill_rule,
+                                 uint8_t *_out);
+
+/// Flattens the shape into a polyline whose chords stay within `_tolerance` of the curve. Closed shapes don't repeat their start point.
+/// Writes at most `_capacity` points and returns the total amount of points : call with a null `_out` to query the required size.
+SizeTC bezrs_shapef_flatten(bezrsShapeF *_shapef, float _tolerance, bezrsPosF *_out, SizeTC _capacity);
+
+/// Creates a cancellation token, for stopping operations running within a `bezrsBudget` from another thread. Needs to be freed afterwards.
+bezrsCancelToken *bezrs_cancel_token_create();
+
+/// To destroy a cancellation token, once no operation uses it anymore.
+void bezrs_cancel_token_destroy(bezrsCancelToken *_token);
+
+/// Requests the operations using this token to stop (thread safe). They return `bezrsStatus::Cancelled` at their next check.
+void bezrs_cancel_token_cancel(const bezrsCancelToken *_token);
+
+/// Clears a cancellation, for reusing the token (thread safe).
+void bezrs_cancel_token_reset(const bezrsCancelToken *_token);
+
+/// Returns true once the token has been cancelled (thread safe).
+bool bezrs_cancel_token_is_cancelled(const bezrsCancelToken *_token);
+
 /// Offset a shape. When the shape is winded clockwise : positive offset goes inside, negative is outside.
 void bezrs_cubic_bezier_offset(bezrsShape *_shape,
                                double offset,
                                bezrsJoinType join_type,
                                double join_mitter);
 
+/// Offsets a shape within a budget, using the curve fitting offset of `bezrs_incremental_offset_create()` rather than bezier-rs' offset
+/// (`bezrs_cubic_bezier_offset()`) : segments are offset one by one within `_tolerance`, and the budget is checked between them.
+/// `max_results` caps the amount of output segments : when `Truncated`, the shape becomes the (open) chain of the first `max_results` ones.
+/// When `TimedOut` or `Cancelled`, the shape is left untouched.
+bezrsStatus bezrs_shape_offset_budget(bezrsShape *_shape,
+                                      double _offset,
+                                      bezrsJoinType _join_type,
+                                      double _join_mitter,
+                                      double _tolerance,
+                                      const bezrsBudget *_budget);
+
 /// Rotates the whole shape
 void bezrs_shape_rotate(bezrsShape *_shape, double _angle, bezrsPos *_center_point);
 
+/// Applies an affine transformation to all anchors and handles of the shape, in place.
+/// Covers translation, scaling, rotation and skewing.
+void bezrs_shape_transform(bezrsShape *_shape, bezrsAffine _matrix);
+
+/// Transforms many shapes at once, `_shapes[i]` being transformed by `_matrices[i]`.
+/// Large batches are spread over multiple threads : all shape handles must be distinct.
+void bezrs_shapes_transform(bezrsShape *const *_shapes,
+                            const bezrsAffine *_matrices,
+                            SizeTC _count);
+
+/// Exports the shape as compiled segments into caller memory (see `bezrsCompiledSegment`), for evaluating it locally.
+/// Writes at most `_capacity` segments and returns the total amount of segments : call with a null `_out` to query the required size.
+/// `_length_tolerance` is the absolute arc length error allowed per segment.
+SizeTC bezrs_shape_compile(bezrsShape *_shape,
+                           bezrsCompiledSegment *_out,
+                           SizeTC _capacity,
+                           double _length_tolerance);
+
+/// Resamples the shape at equal arc length intervals, writing positions, unit tangents and global t-values to caller buffers (each one can be null).
+/// - `_count` > 0 : places `_count` samples evenly (closed shapes don't repeat the start point, paths include both ends).
+/// - otherwise, `_spacing` is the distance between samples.
+/// `_start_offset` shifts all samples along the shape, for scrolling. Closed shapes wrap around, paths drop samples that fall off the ends.
+/// Writes at most `_capacity` samples and returns the total amount of samples : call with null buffers to query the required size.
+SizeTC bezrs_shape_resample(bezrsShape *_shape,
+                            SizeTC _count,
+                            double _spacing,
+                            double _start_offset,
+                            bezrsPos *_out_positions,
+                            bezrsPos *_out_tangents,
+                            double *_out_tvalues,
+                            SizeTC _capacity);
+
+/// Dashes the shape into trimmed cubic pieces, written as open paths into `_out` (its previous content is replaced).
+/// `_pattern` alternates "on" and "off" lengths (odd-sized patterns are repeated twice, like SVG), `_phase` is the distance into the pattern at which the shape starts.
+/// On closed shapes, a dash running over the start point is joined with the first one. Zero-length dashes are skipped.
+/// Returns the amount of dashes, 0 (with `_out` emptied) when the pattern is so short that it would take more than 1048576 (2^20)
+/// dashes and gaps to cover the shape.
+SizeTC bezrs_shape_dash(bezrsShape *_shape,
+                        const double *_pattern,
+                        SizeTC _pattern_len,
+                        double _phase,
+                        bezrsMultiShape *_out);
+
+/// Cuts the shape at many global t-values (0->1, like the output of `bezrs_shape_selfintersections()`) into `_out`, in one pass.
+/// Unsorted t-values are sorted, duplicates are ignored. An open path cut n times gives n+1 pieces, a closed shape cut n times
+/// gives n pieces (the last one running over the start point). Returns the amount of pieces.
+SizeTC bezrs_shape_split(bezrsShape *_shape, const double *_ts, SizeTC _len, bezrsMultiShape *_out);
+
+/// Extracts many pieces of the shape into `_out`, in one pass. `_ranges` holds `_count` pairs of global t-values (t0, t1).
+/// On closed shapes, t0 > t1 runs over the start point. Degenerate ranges are skipped. Returns the amount of pieces.
+SizeTC bezrs_shape_extract_ranges(bezrsShape *_shape,
+                                  const double *_ranges,
+                                  SizeTC _count,
+                                  bezrsMultiShape *_out);
+
+/// Trims the shape to the piece between global t-values `_t0` and `_t1`, in place. The result is an open path.
+/// On closed shapes, `_t0` > `_t1` runs over the start point. Returns false (leaving the shape untouched) when the piece is degenerate.
+bool bezrs_shape_trim(bezrsShape *_shape, double _t0, double _t1);
+
+/// Rasterizes a signed distance field of the shape into a caller-provided float grid (row-major, `_width` x `_height`).
+/// `_grid_to_shape` maps pixel coordinates to shape coordinates (pixel centers are at +0.5), distances are in shape units.
+/// Inside is negative (non-zero winding rule, paths are implicitly closed), outside is positive.
+/// Distances are clamped to `_max_distance` when positive, which also speeds up the computation.
+/// Multithreaded. Returns false if the grid is empty, its size overflows or the transform can't be inverted.
+bool bezrs_shape_sdf(bezrsShape *_shape,
+                     float *_out,
+                     SizeTC _width,
+                     SizeTC _height,
+                     bezrsAffine _grid_to_shape,
+                     double _max_distance);
+
+/// Rasterizes an anti-aliased 8-bit coverage mask of the shape into caller memory (`_height` rows of `_stride` bytes).
+/// `_grid_to_shape` maps pixel coordinates to shape coordinates. Paths are implicitly closed.
+/// Rendered on the CPU in horizontal bands, multithreaded. Returns false if the mask is empty, its size overflows or the transform can't be inverted.
+bool bezrs_shape_rasterize(bezrsShape *_shape,
+                           uint8_t *_out,
+                           SizeTC _width,
+                           SizeTC _height,
+                           SizeTC _stride,
+                           bezrsAffine _grid_to_shape,
+                           bezrsFillRule _fill_rule);
+
+/// Intersects many lines with the shape in one sweep (parallel lines share it, each line only testing the segments spanning it).
+/// The crossings of line i are `_out_params[_out_offsets[i] .. _out_offsets[i+1]]`, sorted parameters along the line
+/// (keep t >= 0 for rays, 0 <= t <= 1 for line segments). `_out_offsets` needs `_count + 1` entries and is always filled.
+/// Writes at most `_capacity` parameters and returns the total amount of crossings : call with a null `_out_params` to query the required size.
+SizeTC bezrs_shape_intersect_lines(bezrsShape *_shape,
+                                   const bezrsLine *_lines,
+                                   SizeTC _count,
+                                   SizeTC *_out_offsets,
+                                   double *_out_params,
+                                   SizeTC _capacity);
+
+/// Fills the shape with parallel hatch lines (pen plotters, lasers) : lines at `_angle` radians, `_spacing` apart, shifted by `_phase`
+/// across their direction. Paths are implicitly closed. `_alternate` reverses every other line (serpentine order, less pen travel).
+/// Writes one straight 2-handle path per hatch segment into `_out` and returns their amount.
+/// Returns 0 (with `_out` emptied) when `_spacing` would need more than 1048576 (2^20) lines across the shape, against degenerate spacings.
+SizeTC bezrs_shape_hatch(bezrsShape *_shape,
+                         double _angle,
+                         double _spacing,
+                         double _phase,
+                         bezrsFillRule _fill_rule,
+                         bool _alternate,
+                         bezrsMultiShape *_out);
+
+/// Clips the shape to a rectangle grown by `_margin` (stroke widths, offsets), for culling zoomed views before drawing,
+/// flattening or offsetting. Writes one open path per visible run of the shape into `_out` (a closed shape entirely within the
+/// rectangle stays closed) and returns their amount. Segments are accepted or rejected by their bounds before any splitting,
+/// and prepared shapes (see `bezrs_shape_prepare()`) only visit the segments near the rectangle.
+SizeTC bezrs_shape_clip_rect(bezrsShape *_shape, bezrsRect _rect, double _margin, bezrsMultiShape *_out);
+
+/// Finds all segments of the shape crossing or within a rectangle grown by `_margin`, like `bezrs_shape_clip_rect()`.
+/// Writes at most `_capacity` segment indices (increasing) into `_out_indices` and returns the total amount :
+/// call with a null `_out_indices` to query the required size.
+SizeTC bezrs_shape_segments_in_rect(bezrsShape *_shape,
+                                    bezrsRect _rect,
+                                    double _margin,
+                                    SizeTC *_out_indices,
+                                    SizeTC _capacity);
+
+/// Approximates the shape by lines and circular arcs within `_tolerance`, for machine toolpaths (G-code G1 / G2 / G3) :
+/// controllers run arcs natively instead of thousands of tiny lines. Collinear lines and arcs of the same circle are merged.
+/// Writes at most `_capacity` moves into `_out` and returns the total amount : call with a null `_out` to query the required size.
+SizeTC bezrs_shape_biarcs(bezrsShape *_shape,
+                          double _tolerance,
+                          bezrsToolpathMove *_out,
+                          SizeTC _capacity);
+
+/// Streams the approximation of `bezrs_shape_biarcs()` through `_callback`, by chunks of a few hundred moves, so that long
+/// toolpaths never need to be held in memory. `_user_data` is passed back to the callback, which can return false to stop.
+/// Returns the amount of moves delivered.
+SizeTC bezrs_shape_biarcs_stream(bezrsShape *_shape,
+                                 double _tolerance,
+                                 bezrsToolpathCallback _callback,
+                                 void *_user_data);
+
+/// Precomputes acceleration data (monotonic pieces in a bounding volume tree, cached bounds, extrema and inflections)
+/// for shapes that are queried many times between edits : containment, projection, bounding box, extrema and inflections become cheaper.
+/// Any mutation of the shape drops it : call this again after editing.
+void bezrs_shape_prepare(bezrsShape *_shape);
+
+/// Returns true if the shape has valid prepared data (see `bezrs_shape_prepare()`).
+bool bezrs_shape_is_prepared(bezrsShape *_shape);
+
 /// Outlines a shape or path.
 /// Important: Closed shapes will return a new shape instance, to be destroyed correctly.
 bezrsShape *bezrs_shape_outline(bezrsShape *_shape,
@@ -121,9 +746,53 @@ bezrsShape *bezrs_shape_outline(bezrsShape *_shape,
                                 bezrsCapType cap,
                                 double miter_limit);
 
+/// Outlines the shape with a variable width into `_out` (replacing its content), for calligraphic and pressure sensitive strokes.
+/// The width varies linearly between the `_count` samples of `_profile`, placed by `_mode`, and stays constant beyond the first
+/// and last ones. Both sides are fitted within `_tolerance`, then joined and capped like `bezrs_shape_outline()` : inner joins go
+/// through the anchor, so fill the result with the non-zero rule. The shape is left untouched.
+/// Paths give 1 closed outline, closed shapes 2 rings of opposite directions. Returns the amount of paths.
+SizeTC bezrs_shape_outline_variable(bezrsShape *_shape,
+                                    const bezrsWidthSample *_profile,
+                                    SizeTC _count,
+                                    bezrsWidthMode _mode,
+                                    bezrsJoinType join,
+                                    bezrsCapType cap,
+                                    double miter_limit,
+                                    double _tolerance,
+                                    bezrsMultiShape *_out);
+
+/// Returns the shape flattened within `_screen_tolerance` once drawn at `_scale` (screen units per shape unit), from a per-shape
+/// level of detail cache : polylines are cached at tolerances of powers of 2, the requested one mapping to its level in O(1)
+/// (the finer one, so the error stays within the request, as long as that takes at most 4096 lines per segment : flattening caps
+/// there). Missing levels are flattened when `_build` is set, otherwise the nearest cached level is returned (empty when there's
+/// none) : draw that while zooming and build in idle time. A null or non-finite `_scale` returns an empty polyline.
+/// The data stays valid until the shape is mutated, destroyed or queried again. Any mutation drops the cache.
+bezrsPolylineRaw bezrs_shape_lod_polyline(bezrsShape *_shape,
+                                          double _screen_tolerance,
+                                          double _scale,
+                                          bool _build);
+
+/// Caps the memory of the level of detail cache of the shape to `_max_points` points (16 bytes each, 262144 by default).
+/// The least recently used levels are evicted beyond it, except the one being requested.
+void bezrs_shape_lod_set_max_points(bezrsShape *_shape, SizeTC _max_points);
+
+/// Returns the amount of points held by the level of detail cache of the shape.
+SizeTC bezrs_shape_lod_cached_points(bezrsShape *_shape);
+
 /// Returns the bounding box of the shape
 bezrsRect bezrs_shape_boundingbox(bezrsShape *_shape);
 
+/// Returns the signed area, winding direction, centroid, arc length and tight bounds of the shape, in a single pass over its segments.
+/// `_length_tolerance` is the absolute arc length error allowed per segment.
+bezrsShapeMetrics bezrs_shape_metrics(bezrsShape *_shape, double _length_tolerance);
+
+/// Computes the metrics of many shapes at once (see `bezrs_shape_metrics()`), `_out[i]` receiving the ones of `_shapes[i]`.
+/// Large batches are spread over multiple threads.
+void bezrs_shapes_metrics(bezrsShape *const *_shapes,
+                          SizeTC _count,
+                          double _length_tolerance,
+                          bezrsShapeMetrics *_out);
+
 /// Returns the inflection points on a shape
 bezrsFloatsRaw bezrs_shape_inflections(bezrsShape *_shape);
 
@@ -138,6 +807,15 @@ bezrsFloatsRaw bezrs_shape_selfintersections(bezrsShape *_shape,
                                              double _error_treshold,
                                              double _min_dist);
 
+/// Returns positions where the shape self intersects, like `bezrs_shape_selfintersections()`, within a budget.
+/// Segment pairs are searched one by one, checking the deadline and cancellation token between them : the search stops
+/// early instead of stalling, and at `max_results` intersections. `_out` receives the (global) t-values found so far.
+bezrsStatus bezrs_shape_selfintersections_budget(bezrsShape *_shape,
+                                                 double _error_treshold,
+                                                 double _min_dist,
+                                                 const bezrsBudget *_budget,
+                                                 bezrsFloatsRaw *_out);
+
 /// Returns the position on the shape from a t-value (0->1) using `evaluate()`.
 bezrsPos bezrs_shape_posfromtvalue(bezrsShape *_shape, double _t);
 
@@ -0,0 +1,151 @@
+
+// In-place affine transformation kernels.
+// Applies a 2x3 matrix to every anchor and handle of a subpath without rebuilding it.
+
+use bezier_rs::Subpath;
+use glam::f64::DVec2;
+
+use crate::{EmptyId, bezrsAffine};
+
+// Matrix layout (same as SVG's `matrix(a,b,c,d,e,f)`) :
+// x' = a*x + c*y + tx
+// y' = b*x + d*y + ty
+
+// Points are transformed in place by slices, 2 per iteration : the x and y coordinates of a pair are
+// deinterleaved into one register each, so every lane holds a different point.
+
+#[derive(Debug, Copy, Clone)]
+pub(crate) struct AffineKernel {
+	m : bezrsAffine,
+}
+
+impl AffineKernel {
+	pub(crate) fn new(m : &bezrsAffine) -> Self {
+		AffineKernel { m: *m }
+	}
+
+	// Single point (rasterizers, tails of slices)
+	#[inline(always)]
+	pub(crate) fn apply(&self, p : DVec2) -> DVec2 {
+		DVec2::new(
+			self.m.a * p.x + self.m.c * p.y + self.m.tx,
+			self.m.b * p.x + self.m.d * p.y + self.m.ty,
+		)
+	}
+
+	pub(crate) fn apply_slice(&self, points : &mut [DVec2]) {
+		let pairs = points.len() / 2;
+		lanes::apply_pairs(&self.m, points.as_mut_ptr() as *mut f64, pairs);
+		if points.len() % 2 == 1 {
+			let last = points.len() - 1;
+			points[last] = self.apply(points[last]);
+		}
+	}
+}
+
+#[cfg(target_arch = "x86_64")]
+mod lanes {
+	use std::arch::x86_64::*;
+	use crate::bezrsAffine;
+
+	// SSE2 is part of the x86_64 baseline, no runtime detection needed.
+	// `data` holds `pairs` * 2 interleaved points (DVec2 is repr(C) x, y).
+	pub(crate) fn apply_pairs(m : &bezrsAffine, data : *mut f64, pairs : usize) {
+		unsafe {
+			let (a, b, c, d) = (_mm_set1_pd(m.a), _mm_set1_pd(m.b), _mm_set1_pd(m.c), _mm_set1_pd(m.d));
+			let (tx, ty) = (_mm_set1_pd(m.tx), _mm_set1_pd(m.ty));
+			for i in 0..pairs {
+				let ptr = data.add(i * 4);
+				let (p0, p1) = (_mm_loadu_pd(ptr), _mm_loadu_pd(ptr.add(2)));
+				let (xs, ys) = (_mm_unpacklo_pd(p0, p1), _mm_unpackhi_pd(p0, p1));
+				let rx = _mm_add_pd(_mm_add_pd(_mm_mul_pd(a, xs), _mm_mul_pd(c, ys)), tx);
+				let ry = _mm_add_pd(_mm_add_pd(_mm_mul_pd(b, xs), _mm_mul_pd(d, ys)), ty);
+				_mm_storeu_pd(ptr, _mm_unpacklo_pd(rx, ry));
+				_mm_storeu_pd(ptr.add(2), _mm_unpackhi_pd(rx, ry));
+			}
+		}
+	}
+}
+
+#[cfg(target_arch = "aarch64")]
+mod lanes {
+	use std::arch::aarch64::*;
+	use crate::bezrsAffine;
+
+	// NEON is part of the aarch64 baseline. vld2 / vst2 (de)interleave the pairs.
+	pub(crate) fn apply_pairs(m : &bezrsAffine, data : *mut f64, pairs : usize) {
+		unsafe {
+			let (tx, ty) = (vdupq_n_f64(m.tx), vdupq_n_f64(m.ty));
+			for i in 0..pairs {
+				let ptr = data.add(i * 4);
+				let p = vld2q_f64(ptr);
+				let rx = vfmaq_n_f64(vfmaq_n_f64(tx, p.0, m.a), p.1, m.c);
+				let ry = vfmaq_n_f64(vfmaq_n_f64(ty, p.0, m.b), p.1, m.d);
+				vst2q_f64(ptr, float64x2x2_t(rx, ry));
+			}
+		}
+	}
+}
+
+#[cfg(not(any(target_arch = "x86_64", target_arch = "aarch64")))]
+mod lanes {
+	use crate::bezrsAffine;
+
+	// Scalar fallback, in pairs so the compiler may still widen it
+	pub(crate) fn apply_pairs(m : &bezrsAffine, data : *mut f64, pairs : usize) {
+		let values = unsafe { std::slice::from_raw_parts_mut(data, pairs * 4) };
+		for pair in values.chunks_exact_mut(4) {
+			let (x0, y0, x1, y1) = (pair[0], pair[1], pair[2], pair[3]);
+			pair[0] = m.a * x0 + m.c * y0 + m.tx;
+			pair[1] = m.b * x0 + m.d * y0 + m.ty;
+			pair[2] = m.a * x1 + m.c * y1 + m.tx;
+			pair[3] = m.b * x1 + m.d * y1 + m.ty;
+		}
+	}
+}
+
+
+impl bezrsAffine {
+	pub(crate) fn from_rotation(_angle: f64, _center: DVec2) -> Self {
+		// Same orientation as bezier-rs's `rotate_about_point()`
+		let (sin, cos) = _angle.sin_cos();
+		bezrsAffine {
+			a: cos,
+			b: sin,
+			c: -sin,
+			d: cos,
+			tx: _center.x - (cos * _center.x - sin * _center.y),
+			ty: _center.y - (sin * _center.x + cos * _center.y),
+		}
+	}
+}
+
+// Manipulator groups gathered per chunk : up to 3 points each, on the stack
+const GROUPS_PER_CHUNK : usize = 64;
+
+// Rewrites anchors and handles in place (no reallocation of the manipulator groups).
+// Points are gathered by chunks into a contiguous buffer, transformed by slice, then written back.
+pub(crate) fn transform_subpath(sub_path: &mut Subpath<EmptyId>, matrix: &bezrsAffine) {
+	let kernel = AffineKernel::new(matrix);
+	let mut buffer = [DVec2::ZERO; GROUPS_PER_CHUNK * 3];
+	for chunk in sub_path.manipulator_groups_mut().chunks_mut(GROUPS_PER_CHUNK) {
+		let mut len = 0;
+		for mg in chunk.iter() {
+			for p in [Some(mg.anchor), mg.in_handle, mg.out_handle].into_iter().flatten() {
+				buffer[len] = p;
+				len += 1;
+			}
+		}
+		kernel.apply_slice(&mut buffer[..len]);
+		let mut points = buffer[..len].iter();
+		for mg in chunk.iter_mut() {
+			mg.anchor = *points.next().unwrap();
+			if let Some(h) = mg.in_handle.as_mut() {
+				*h = *points.next().unwrap();
+			}
+			if let Some(h) = mg.out_handle.as_mut() {
+				*h = *points.next().unwrap();
+			}
+		}
+	}
+}
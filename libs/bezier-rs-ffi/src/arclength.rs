@@ -0,0 +1,108 @@
+
+// Arc length parametrisation helpers.
+// Converts distances along a shape to (segment, t) positions, walking forward over the segments once.
+
+use bezier_rs::Subpath;
+
+use crate::EmptyId;
+use crate::segments::{self, Cubic};
+
+// Uniform t-subdivisions per segment used for the arc length table
+const TABLE_STEPS : usize = 16;
+
+// Cumulated arc lengths of a single segment, at uniform t-steps.
+#[derive(Debug, Copy, Clone)]
+pub(crate) struct ArcTable {
+	pub(crate) cubic : Cubic,
+	lengths : [f64; TABLE_STEPS + 1],
+}
+
+impl ArcTable {
+
+	pub(crate) fn new(cubic : Cubic) -> Self {
+		let mut lengths = [0.0; TABLE_STEPS + 1];
+		let step = 1.0 / TABLE_STEPS as f64;
+		for i in 0..TABLE_STEPS {
+			let t0 = i as f64 * step;
+			lengths[i + 1] = lengths[i] + cubic.length_gauss(t0, t0 + step);
+		}
+		ArcTable { cubic, lengths }
+	}
+
+	pub(crate) fn length(&self) -> f64 {
+		self.lengths[TABLE_STEPS]
+	}
+
+	// Distance from the segment start to a local t-value.
+	pub(crate) fn length_at_t(&self, t : f64) -> f64 {
+		let t = t.clamp(0.0, 1.0);
+		let step = ((t * TABLE_STEPS as f64) as usize).min(TABLE_STEPS - 1);
+		self.lengths[step] + self.cubic.length_gauss(step as f64 / TABLE_STEPS as f64, t)
+	}
+
+	// Local t-value at a given distance from the segment start (clamped to the segment).
+	pub(crate) fn t_at_length(&self, distance : f64) -> f64 {
+		let total = self.length();
+		if distance <= 0.0 || total <= 0.0 {
+			return 0.0;
+		}
+		if distance >= total {
+			return 1.0;
+		}
+
+		// Find the table step, then refine with Newton iterations
+		let step = self.lengths.partition_point(|&l| l <= distance).clamp(1, TABLE_STEPS) - 1;
+		let (l0, l1) = (self.lengths[step], self.lengths[step + 1]);
+		let t0 = step as f64 / TABLE_STEPS as f64;
+		let t1 = t0 + 1.0 / TABLE_STEPS as f64;
+		let mut t = if l1 > l0 { t0 + (t1 - t0) * (distance - l0) / (l1 - l0) } else { t0 };
+		for _ in 0..3 {
+			let error = l0 + self.cubic.length_gauss(t0, t) - distance;
+			let speed = self.cubic.derivative(t).length();
+			if speed <= 1e-12 || error.abs() <= 1e-9 {
+				break;
+			}
+			t = (t - error / speed).clamp(t0, t1);
+		}
+		t
+	}
+}
+
+// Builds the arc length tables of all segments of a subpath
+pub(crate) fn build_tables(sub_path : &Subpath<EmptyId>) -> Vec<ArcTable> {
+	segments::iter_cubics(sub_path).map(ArcTable::new).collect()
+}
+
+// Position along the shape found by a `PathWalker`
+#[derive(Debug, Copy, Clone)]
+pub(crate) struct WalkPos {
+	pub(crate) segment : usize,
+	pub(crate) t : f64,
+}
+
+// Locates increasing distances along a set of segment tables, in a single forward pass.
+pub(crate) struct PathWalker<'a> {
+	tables : &'a [ArcTable],
+	segment : usize,
+	segment_start : f64,
+}
+
+impl<'a> PathWalker<'a> {
+
+	pub(crate) fn new(tables : &'a [ArcTable]) -> Self {
+		PathWalker { tables, segment: 0, segment_start: 0.0 }
+	}
+
+	// `distance` must not decrease between calls. Distances past the end resolve to the end of the last segment.
+	pub(crate) fn locate(&mut self, distance : f64) -> Option<WalkPos> {
+		if self.tables.is_empty() {
+			return None;
+		}
+		while self.segment + 1 < self.tables.len() && distance > self.segment_start + self.tables[self.segment].length() {
+			self.segment_start += self.tables[self.segment].length();
+			self.segment += 1;
+		}
+		let t = self.tables[self.segment].t_at_length(distance - self.segment_start);
+		Some(WalkPos { segment: self.segment, t })
+	}
+}
@@ -0,0 +1,348 @@
+
+// Biarc approximation of subpaths into lines and circular arcs, for machine toolpaths (G-code G1 / G2 / G3).
+// Segments are first split at their inflections (an arc can't turn both ways), then each piece is fitted by two arcs
+// keeping its end tangents (the biarc whose control points are equally distant from the end points), halved until within tolerance.
+// Moves go through a sink in small chunks, so long toolpaths are streamed without ever being collected.
+
+use bezier_rs::Subpath;
+use glam::f64::DVec2;
+
+use crate::{EmptyId, bezrsPos, bezrsToolpathMove};
+use crate::segments::{self, Cubic};
+
+// Halvings of one piece before emitting it as is
+const MAX_DEPTH : u32 = 16;
+// Curve samples per piece for measuring the error
+const ERROR_SAMPLES : usize = 8;
+// Moves per chunk handed to the sink
+const CHUNK_SIZE : usize = 256;
+
+#[inline]
+fn cross(a : DVec2, b : DVec2) -> f64 {
+	a.x * b.y - a.y * b.x
+}
+
+#[inline]
+fn perp(v : DVec2) -> DVec2 {
+	DVec2::new(-v.y, v.x)
+}
+
+#[derive(Debug, Copy, Clone)]
+enum Move {
+	Line { end : DVec2 },
+	Arc { end : DVec2, center : DVec2, sweep : f64 },
+}
+
+impl Move {
+	fn end(&self) -> DVec2 {
+		match self {
+			Move::Line { end } | Move::Arc { end, .. } => *end,
+		}
+	}
+
+	fn to_raw(&self) -> bezrsToolpathMove {
+		match self {
+			Move::Line { end } => bezrsToolpathMove { end: bezrsPos::from_dvec2(end), center: bezrsPos::from_dvec2(end), sweep: 0.0 },
+			Move::Arc { end, center, sweep } => bezrsToolpathMove { end: bezrsPos::from_dvec2(end), center: bezrsPos::from_dvec2(center), sweep: *sweep },
+		}
+	}
+}
+
+// Arc from `start` with tangent `tangent` ending at `end`. Falls back to a line when (nearly) straight.
+fn arc_from_tangent(start : DVec2, tangent : DVec2, end : DVec2) -> Move {
+	let chord = end - start;
+	let normal = perp(tangent);
+	let offset = normal.dot(chord);
+	let chord_sq = chord.length_squared();
+	if offset.abs() <= 1e-9 * chord_sq.sqrt() || chord_sq == 0.0 {
+		return Move::Line { end };
+	}
+	let center = start + normal * (0.5 * chord_sq / offset);
+	let (a, b) = (start - center, end - center);
+	let mut sweep = cross(a, b).atan2(a.dot(b));
+	// The tangent gives the turning direction, the arc may exceed half a turn
+	let direction = cross(a, tangent);
+	if direction > 0.0 && sweep < 0.0 {
+		sweep += std::f64::consts::TAU;
+	}
+	else if direction < 0.0 && sweep > 0.0 {
+		sweep -= std::f64::consts::TAU;
+	}
+	Move::Arc { end, center, sweep }
+}
+
+// Arc as (start, end), ending with the given tangent : the reversed arc starting at `end` with the opposite tangent.
+fn arc_to_tangent(start : DVec2, end : DVec2, tangent : DVec2) -> Move {
+	match arc_from_tangent(end, -tangent, start) {
+		Move::Arc { center, sweep, .. } => Move::Arc { end, center, sweep: -sweep },
+		Move::Line { .. } => Move::Line { end },
+	}
+}
+
+// Distance from `p` to a move starting at `start`
+fn distance_to_move(start : DVec2, m : &Move, p : DVec2) -> f64 {
+	match m {
+		Move::Line { end } => {
+			let d = *end - start;
+			let t = if d.length_squared() > 0.0 { ((p - start).dot(d) / d.length_squared()).clamp(0.0, 1.0) } else { 0.0 };
+			(start + d * t - p).length()
+		}
+		Move::Arc { end, center, sweep } => {
+			let (a, q) = (start - *center, p - *center);
+			let mut angle = cross(a, q).atan2(a.dot(q));
+			if *sweep < 0.0 {
+				angle = -angle;
+			}
+			if angle < 0.0 {
+				angle += std::f64::consts::TAU;
+			}
+			if angle <= sweep.abs() {
+				(q.length() - a.length()).abs()
+			} else {
+				(p - start).length().min((p - *end).length())
+			}
+		}
+	}
+}
+
+// Equal-distance biarc of a piece without inflection. None when its end tangents don't allow one.
+fn biarc(cubic : &Cubic) -> Option<(Move, Move)> {
+	let (p0, p3) = (cubic.p0, cubic.p3);
+	let (t0, t3) = (cubic.tangent(0.0), cubic.tangent(1.0));
+	let v = p3 - p0;
+	if t0 == DVec2::ZERO || t3 == DVec2::ZERO || v.length_squared() == 0.0 {
+		return None;
+	}
+	// Both arcs share the distance d from their end point to their control point : |v - d (t0 + t3)| = 2d
+	let t = t0 + t3;
+	let denominator = 2.0 * (1.0 - t0.dot(t3));
+	let d = if denominator.abs() < 1e-12 {
+		let vt = v.dot(t3);
+		if vt.abs() < 1e-12 {
+			return None;
+		}
+		v.length_squared() / (4.0 * vt)
+	} else {
+		let vt = v.dot(t);
+		(-vt + (vt * vt + denominator * v.length_squared()).sqrt()) / denominator
+	};
+	if !(d > 0.0) || !d.is_finite() {
+		return None;
+	}
+	let joint = ((p0 + t0 * d) + (p3 - t3 * d)) * 0.5;
+	Some((arc_from_tangent(p0, t0, joint), arc_to_tangent(joint, p3, t3)))
+}
+
+// Largest distance from the curve samples to the biarc
+fn biarc_error(cubic : &Cubic, first : &Move, second : &Move) -> f64 {
+	let joint = first.end();
+	(1..ERROR_SAMPLES).map(|i| {
+		let p = cubic.evaluate(i as f64 / ERROR_SAMPLES as f64);
+		distance_to_move(cubic.p0, first, p).min(distance_to_move(joint, second, p))
+	}).fold(0.0, f64::max)
+}
+
+// Directions from the start of a run of merged lines that keep every vertex of the run within `half_width` of the chord
+#[derive(Debug, Copy, Clone)]
+struct LineCone {
+	axis : DVec2, // direction of the first line of the run
+	min : f64, // allowed angles around `axis`
+	max : f64,
+	reach : f64, // distance of the farthest vertex from the start
+}
+
+impl LineCone {
+
+	fn new(axis : DVec2) -> Self {
+		LineCone { axis, min: -std::f64::consts::PI, max: std::f64::consts::PI, reach: 0.0 }
+	}
+
+	fn angle(&self, v : DVec2) -> f64 {
+		cross(self.axis, v).atan2(self.axis.dot(v))
+	}
+
+	// Narrows the cone to the chords passing within `half_width` of the vertex at `v` (relative to the start)
+	fn narrowed(&self, v : DVec2, half_width : f64) -> Self {
+		let mut cone = *self;
+		let r = v.length();
+		if r > half_width {
+			let (angle, spread) = (self.angle(v), (half_width / r).asin());
+			cone.min = cone.min.max(angle - spread);
+			cone.max = cone.max.min(angle + spread);
+		}
+		cone.reach = cone.reach.max(r);
+		cone
+	}
+
+	// A chord ending at `v` (relative to the start) passes near every vertex, and they all project within it
+	fn contains(&self, v : DVec2) -> bool {
+		let angle = self.angle(v);
+		v.length() >= self.reach && self.min <= angle && angle <= self.max
+	}
+}
+
+// Collects moves, merging consecutive collinear lines and arcs of the same circle, and hands them to the sink by chunks.
+pub(crate) struct Emitter<F : FnMut(&[bezrsToolpathMove]) -> bool> {
+	sink : F,
+	tolerance : f64,
+	chunk : Vec<bezrsToolpathMove>,
+	pending : Option<(DVec2, Move)>, // Last move and its start point, until the next one can't extend it
+	cone : Option<LineCone>, // When the pending move is merged lines : chords keeping them all within tolerance
+	pub(crate) count : usize,
+	stopped : bool,
+}
+
+impl<F : FnMut(&[bezrsToolpathMove]) -> bool> Emitter<F> {
+
+	pub(crate) fn new(tolerance : f64, sink : F) -> Self {
+		Emitter { sink, tolerance, chunk: Vec::with_capacity(CHUNK_SIZE), pending: None, cone: None, count: 0, stopped: false }
+	}
+
+	fn merged(&mut self, start : DVec2, last : &Move, next : &Move) -> Option<Move> {
+		match (last, next) {
+			(Move::Line { end: a }, Move::Line { end: b }) => {
+				// Every vertex merged so far has to stay close to the new chord, not only the last one
+				let (d, e) = (*a - start, *b - *a);
+				if d.dot(e) <= 0.0 {
+					return None;
+				}
+				let cone = self.cone.unwrap_or_else(|| LineCone::new(d.normalize())).narrowed(d, 0.5 * self.tolerance);
+				if !cone.contains(*b - start) {
+					return None;
+				}
+				self.cone = Some(cone);
+				Some(Move::Line { end: *b })
+			}
+			(Move::Arc { center: c0, sweep: s0, .. }, Move::Arc { end, center: c1, sweep: s1 }) => {
+				let (r0, r1) = ((start - *c0).length(), (*end - *c1).length());
+				let total = s0 + s1;
+				if (*s0 > 0.0) == (*s1 > 0.0) && total.abs() < std::f64::consts::TAU && (*c0 - *c1).length() <= 0.25 * self.tolerance && (r0 - r1).abs() <= 0.25 * self.tolerance {
+					return Some(Move::Arc { end: *end, center: *c0, sweep: total });
+				}
+				None
+			}
+			_ => None,
+		}
+	}
+
+	fn push(&mut self, start : DVec2, next : Move) {
+		if let Some((pending_start, last)) = self.pending {
+			if let Some(merged) = self.merged(pending_start, &last, &next) {
+				self.pending = Some((pending_start, merged));
+				return;
+			}
+			self.chunk.push(last.to_raw());
+			if self.chunk.len() == CHUNK_SIZE {
+				self.flush_chunk();
+			}
+		}
+		self.pending = Some((start, next));
+		self.cone = None;
+	}
+
+	fn flush_chunk(&mut self) {
+		if !self.chunk.is_empty() && !self.stopped {
+			self.count += self.chunk.len();
+			self.stopped = !(self.sink)(&self.chunk);
+		}
+		self.chunk.clear();
+	}
+
+	// Emits the pending move and the last chunk
+	pub(crate) fn finish(&mut self) {
+		if let Some((_, last)) = self.pending.take() {
+			self.chunk.push(last.to_raw());
+		}
+		self.cone = None;
+		self.flush_chunk();
+	}
+
+	// Approximates a piece without inflection
+	fn push_piece(&mut self, cubic : &Cubic, depth : u32) {
+		if self.stopped {
+			return;
+		}
+		let straight = [cubic.p1, cubic.p2].iter().all(|p| distance_to_move(cubic.p0, &Move::Line { end: cubic.p3 }, *p) <= 0.25 * self.tolerance);
+		if straight {
+			if cubic.p3 != cubic.p0 {
+				self.push(cubic.p0, Move::Line { end: cubic.p3 });
+			}
+			return;
+		}
+		match biarc(cubic) {
+			Some((first, second)) if depth >= MAX_DEPTH || biarc_error(cubic, &first, &second) <= self.tolerance => {
+				let joint = first.end();
+				self.push(cubic.p0, first);
+				self.push(joint, second);
+			}
+			None if depth >= MAX_DEPTH => self.push(cubic.p0, Move::Line { end: cubic.p3 }),
+			_ => {
+				let (left, right) = cubic.split(0.5);
+				self.push_piece(&left, depth + 1);
+				self.push_piece(&right, depth + 1);
+			}
+		}
+	}
+
+	pub(crate) fn push_subpath(&mut self, sub_path : &Subpath<EmptyId>) {
+		let mut cuts : Vec<f64> = Vec::with_capacity(4);
+		for cubic in segments::iter_cubics(sub_path) {
+			cuts.clear();
+			cuts.push(0.0);
+			cuts.extend(cubic.inflections());
+			cuts.push(1.0);
+			cuts.sort_unstable_by(|a, b| a.total_cmp(b));
+			for range in cuts.windows(2) {
+				if range[1] - range[0] > 1e-9 {
+					self.push_piece(&cubic.trim(range[0], range[1]), 0);
+				}
+			}
+			if self.stopped {
+				return;
+			}
+		}
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use bezier_rs::ManipulatorGroup;
+
+	// Largest distance from `points` to the toolpath starting at `start`
+	fn deviation(start : DVec2, moves : &[bezrsToolpathMove], points : &[DVec2]) -> f64 {
+		points.iter().map(|p| {
+			let mut from = start;
+			let mut best = f64::INFINITY;
+			for m in moves {
+				let end = m.end.to_dvec2();
+				let path_move = if m.sweep == 0.0 { Move::Line { end } } else { Move::Arc { end, center: m.center.to_dvec2(), sweep: m.sweep } };
+				best = best.min(distance_to_move(from, &path_move, *p));
+				from = end;
+			}
+			best
+		}).fold(0.0, f64::max)
+	}
+
+	// Merged runs of lines used to drift away from their earlier vertices, past the tolerance
+	#[test]
+	fn merged_lines_stay_within_tolerance() {
+		let (radius, count, tolerance) = (100.0, 6000, 0.01);
+		let points : Vec<DVec2> = (0..count).map(|i| {
+			let (s, c) = (i as f64 / count as f64 * std::f64::consts::PI).sin_cos();
+			DVec2::new(c, s) * radius
+		}).collect();
+		let groups = points.iter().map(|&anchor| ManipulatorGroup { anchor, in_handle: None, out_handle: None, id: EmptyId }).collect();
+		let sub_path = Subpath::new(groups, false);
+
+		let mut moves : Vec<bezrsToolpathMove> = Vec::new();
+		let mut emitter = Emitter::new(tolerance, |chunk : &[bezrsToolpathMove]| { moves.extend_from_slice(chunk); true });
+		emitter.push_subpath(&sub_path);
+		emitter.finish();
+		drop(emitter);
+
+		assert!(moves.len() > 1 && moves.len() < count / 10, "{} moves", moves.len());
+		let error = deviation(points[0], &moves, &points);
+		assert!(error <= tolerance, "deviation {} over tolerance {} ({} moves)", error, tolerance, moves.len());
+	}
+}
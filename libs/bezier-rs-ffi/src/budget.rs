@@ -0,0 +1,66 @@
+
+// Time budgets and cooperative cancellation for long running operations.
+// Operations poll their budget between units of work (segment pairs, segments, subdivision steps), so a deadline
+// is honoured within the cost of one unit and a cancellation requested from another thread is seen promptly.
+
+use std::cell::Cell;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::time::{Duration, Instant};
+
+use crate::{bezrsBudget, bezrsStatus};
+
+// Polls between two reads of the clock (cancellation is checked on every poll)
+const POLLS_PER_CLOCK : u32 = 32;
+
+pub(crate) struct Budget<'a> {
+	deadline : Option<Instant>,
+	cancel : Option<&'a AtomicBool>,
+	pub(crate) max_results : usize, // 0 : unlimited
+	polls : Cell<u32>,
+	expired : Cell<bool>,
+}
+
+impl<'a> Budget<'a> {
+
+	pub(crate) fn unlimited() -> Self {
+		Budget { deadline: None, cancel: None, max_results: 0, polls: Cell::new(0), expired: Cell::new(false) }
+	}
+
+	// Starts the clock now. A null budget is unlimited.
+	pub(crate) fn from_raw(raw : Option<&'a bezrsBudget>) -> Self {
+		let mut budget = Self::unlimited();
+		if let Some(raw) = raw {
+			if raw.time_limit_ms > 0.0 && raw.time_limit_ms.is_finite() {
+				budget.deadline = Some(Instant::now() + Duration::from_secs_f64(raw.time_limit_ms * 1e-3));
+			}
+			budget.cancel = unsafe { raw.cancel.as_ref() }.map(|token| &token.cancelled);
+			budget.max_results = raw.max_results as usize;
+		}
+		budget
+	}
+
+	// Returns why the operation has to stop, if it does
+	#[inline]
+	pub(crate) fn interrupted(&self) -> Option<bezrsStatus> {
+		if self.cancel.map_or(false, |cancelled| cancelled.load(Ordering::Relaxed)) {
+			return Some(bezrsStatus::Cancelled);
+		}
+		if let Some(deadline) = self.deadline {
+			let polls = self.polls.get();
+			self.polls.set(polls.wrapping_add(1));
+			if !self.expired.get() && polls % POLLS_PER_CLOCK == 0 && Instant::now() >= deadline {
+				self.expired.set(true);
+			}
+			if self.expired.get() {
+				return Some(bezrsStatus::TimedOut);
+			}
+		}
+		None
+	}
+
+	// True once `count` results reach the cap
+	#[inline]
+	pub(crate) fn is_full(&self, count : usize) -> bool {
+		self.max_results > 0 && count >= self.max_results
+	}
+}
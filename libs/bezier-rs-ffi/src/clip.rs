@@ -0,0 +1,188 @@
+
+// Clipping to an axis aligned rectangle, for culling zoomed views before drawing, flattening or offsetting.
+// A first pass accepts or rejects whole segments by the bounds of their control points. Only the segments straddling
+// an edge of the rectangle are split into x/y-monotonic pieces, which cross each edge at most once.
+// Prepared shapes skip that pass : their bounding volume tree only yields the pieces near the rectangle.
+
+use bezier_rs::Subpath;
+use glam::f64::DVec2;
+
+use crate::{EmptyId, bezrsRect};
+use crate::multishape::MultiShapeData;
+use crate::prepared::Prepared;
+use crate::segments::{self, Bounds, Cubic};
+
+// Local t-values closer than this are the same point
+const T_EPSILON : f64 = 1e-9;
+
+// Part of a segment within the rectangle (local t-values)
+#[derive(Debug, Copy, Clone)]
+struct Span {
+	segment : usize,
+	t0 : f64,
+	t1 : f64,
+}
+
+impl Span {
+	// The next span continues this one
+	fn continues(&self, next : &Span) -> bool {
+		(next.segment == self.segment && next.t0 - self.t1 <= T_EPSILON)
+			|| (next.segment == self.segment + 1 && self.t1 >= 1.0 - T_EPSILON && next.t0 <= T_EPSILON)
+	}
+}
+
+// Bounds of a rectangle (negative sizes allowed) grown by `margin`. None when empty or not finite.
+pub(crate) fn rect_bounds(rect : &bezrsRect, margin : f64) -> Option<Bounds> {
+	let (a, b) = (rect.pos.to_dvec2(), rect.pos.to_dvec2() + rect.size.to_dvec2());
+	let margin = DVec2::splat(if margin.is_finite() { margin } else { 0.0 });
+	let bounds = Bounds { min: a.min(b) - margin, max: a.max(b) + margin };
+	if !bounds.min.is_finite() || !bounds.max.is_finite() || bounds.min.x > bounds.max.x || bounds.min.y > bounds.max.y {
+		return None;
+	}
+	Some(bounds)
+}
+
+fn push_span(spans : &mut Vec<Span>, segment : usize, t0 : f64, t1 : f64) {
+	if let Some(last) = spans.last_mut() {
+		if last.segment == segment && t0 - last.t1 <= T_EPSILON {
+			last.t1 = last.t1.max(t1);
+			return;
+		}
+	}
+	spans.push(Span { segment, t0, t1 });
+}
+
+// Appends the parts of a monotonic piece (`t0` to `t1` of `segment`) within `rect`
+fn clip_monotonic(piece : &Cubic, segment : usize, t0 : f64, t1 : f64, rect : &Bounds, spans : &mut Vec<Span>) {
+	let bounds = Bounds::from_points(&[piece.p0, piece.p3]);
+	if !rect.overlaps(&bounds) {
+		return;
+	}
+	if rect.contains(&bounds) {
+		push_span(spans, segment, t0, t1);
+		return;
+	}
+	let mut cuts : [f64; 6] = [0.0; 6];
+	let mut count = 0;
+	for axis in 0..2 {
+		let (v0, v3) = (piece.p0[axis], piece.p3[axis]);
+		for edge in [rect.min[axis], rect.max[axis]] {
+			if (v0 < edge) != (v3 < edge) && v0 != edge && v3 != edge {
+				cuts[count] = piece.solve_monotonic(axis, edge);
+				count += 1;
+			}
+		}
+	}
+	cuts[count] = 1.0;
+	let cuts = &mut cuts[..count + 1];
+	cuts.sort_unstable_by(|a, b| a.total_cmp(b));
+
+	let mut start = 0.0;
+	for end in cuts.iter().copied() {
+		if end - start > T_EPSILON && rect.contains_point(piece.evaluate(0.5 * (start + end))) {
+			push_span(spans, segment, t0 + start * (t1 - t0), t0 + end * (t1 - t0));
+		}
+		start = end;
+	}
+}
+
+// Parts of the subpath within `rect`, in path order
+fn visible_spans(sub_path : &Subpath<EmptyId>, prepared : Option<&Prepared>, rect : &Bounds, spans : &mut Vec<Span>) {
+	spans.clear();
+	if let Some(prepared) = prepared {
+		let mut candidates : Vec<usize> = Vec::new();
+		prepared.pieces_overlapping(rect, &mut candidates);
+		for piece in candidates.iter().map(|i| &prepared.pieces[*i]) {
+			clip_monotonic(&piece.cubic, piece.segment, piece.t0, piece.t1, rect, spans);
+		}
+		return;
+	}
+
+	let mut splits : Vec<f64> = Vec::new();
+	for (segment, cubic) in segments::iter_cubics(sub_path).enumerate() {
+		// Pre-pass on the control points (the curve lies within their bounds)
+		let hull = Bounds::from_points(&[cubic.p0, cubic.p1, cubic.p2, cubic.p3]);
+		if !rect.overlaps(&hull) {
+			continue;
+		}
+		if rect.contains(&hull) {
+			push_span(spans, segment, 0.0, 1.0);
+			continue;
+		}
+		let [x_extrema, y_extrema] = cubic.extrema();
+		splits.clear();
+		splits.push(0.0);
+		splits.extend(x_extrema.iter().chain(y_extrema.iter()));
+		splits.push(1.0);
+		splits.sort_unstable_by(|a, b| a.total_cmp(b));
+		for range in splits.windows(2) {
+			if range[1] - range[0] > T_EPSILON {
+				clip_monotonic(&cubic.trim(range[0], range[1]), segment, range[0], range[1], rect, spans);
+			}
+		}
+	}
+}
+
+// Clips the subpath to `rect` into `out` (which is cleared first) : one open path per visible run of the curve,
+// runs crossing the start point of closed subpaths being joined. A closed subpath entirely within the rectangle is kept closed.
+// Returns the amount of paths.
+pub(crate) fn clip_to_rect(sub_path : &Subpath<EmptyId>, prepared : Option<&Prepared>, rect : &Bounds, out : &mut MultiShapeData) -> usize {
+	out.clear();
+	let count = segments::segment_count(sub_path);
+	if count == 0 {
+		return 0;
+	}
+	let mut spans : Vec<Span> = Vec::new();
+	visible_spans(sub_path, prepared, rect, &mut spans);
+	if spans.is_empty() {
+		return 0;
+	}
+
+	let mut chain : Vec<Cubic> = Vec::with_capacity(spans.len());
+	let closed = sub_path.closed();
+	if closed && spans.len() == count && spans.iter().all(|span| span.t0 <= T_EPSILON && span.t1 >= 1.0 - T_EPSILON) {
+		chain.extend(segments::iter_cubics(sub_path));
+		out.push_chain(&chain, true);
+		return 1;
+	}
+
+	// Runs of connected spans, as ranges of `spans`
+	let mut runs : Vec<(usize, usize)> = Vec::new();
+	let mut start = 0;
+	for i in 1..=spans.len() {
+		if i == spans.len() || !spans[i - 1].continues(&spans[i]) {
+			runs.push((start, i));
+			start = i;
+		}
+	}
+	// The last run continues into the first one over the start point
+	let (first, last) = (spans[0], spans[spans.len() - 1]);
+	let wraps = closed && runs.len() > 1 && last.segment == count - 1 && last.t1 >= 1.0 - T_EPSILON && first.segment == 0 && first.t0 <= T_EPSILON;
+
+	let to_cubic = |span : &Span| segments::segment(sub_path, span.segment).trim(span.t0, span.t1);
+	for (k, run) in runs.iter().enumerate() {
+		if wraps && k == runs.len() - 1 {
+			break;
+		}
+		chain.clear();
+		if wraps && k == 0 {
+			let tail = runs[runs.len() - 1];
+			chain.extend(spans[tail.0..tail.1].iter().map(to_cubic));
+		}
+		chain.extend(spans[run.0..run.1].iter().map(to_cubic));
+		out.push_chain(&chain, false);
+	}
+	out.spans.len()
+}
+
+// Indices of the segments crossing or within `rect`, in increasing order
+pub(crate) fn segments_in_rect(sub_path : &Subpath<EmptyId>, prepared : Option<&Prepared>, rect : &Bounds, out : &mut Vec<usize>) {
+	out.clear();
+	let mut spans : Vec<Span> = Vec::new();
+	visible_spans(sub_path, prepared, rect, &mut spans);
+	for span in &spans {
+		if out.last() != Some(&span.segment) {
+			out.push(span.segment);
+		}
+	}
+}
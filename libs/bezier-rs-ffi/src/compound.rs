@@ -0,0 +1,174 @@
+
+// Compound shapes : several subpaths filled together with a fill rule (letters, shapes with holes).
+// Per-subpath prepared geometry is built lazily on the first query and dropped on mutation.
+
+use bezier_rs::{Subpath, Join, Cap};
+use glam::f64::DVec2;
+
+use crate::{EmptyId, bezrsBezierHandle, bezrsFillRule, bezrsShapeSpan, SizeTC, sub_path_to_vec};
+use crate::multishape::MultiShapeData;
+use crate::prepared::Prepared;
+use crate::segments::{self, Bounds};
+
+// Role of a subpath within the filled area
+#[derive(Debug, Copy, Clone, PartialEq)]
+enum Role {
+	Outer, // Filled on its inside
+	Hole, // Filled on its outside
+	Other, // Not a boundary of the filled area (overlapping or open contours)
+}
+
+#[derive(Debug)]
+pub(crate) struct CompoundData {
+	pub(crate) sub_paths : Vec<Subpath<EmptyId>>,
+	pub(crate) fill_rule : bezrsFillRule,
+	prepared : Vec<Prepared>, // Empty when dirty
+	pub(crate) mirror : MultiShapeData, // Packed handles for returning the data to c++
+}
+
+impl CompoundData {
+
+	pub(crate) fn new(fill_rule : bezrsFillRule) -> Self {
+		CompoundData { sub_paths: Vec::new(), fill_rule, prepared: Vec::new(), mirror: MultiShapeData::default() }
+	}
+
+	// To call on any mutation of the subpaths
+	pub(crate) fn mark_changed(&mut self) {
+		self.prepared.clear();
+	}
+
+	// Replaces all subpaths from packed handles, recycling the previous allocations when possible.
+	pub(crate) fn assign(&mut self, handles : &[bezrsBezierHandle], spans : &[bezrsShapeSpan]) {
+		let mut recycled : Vec<Subpath<EmptyId>> = std::mem::take(&mut self.sub_paths);
+		for span in spans {
+			let start = (span.offset as usize).min(handles.len());
+			let end = (span.offset as usize + span.len as usize).min(handles.len());
+			let mut manipulator_groups = match recycled.pop() {
+				Some(mut sub_path) => std::mem::take(sub_path.manipulator_groups_mut()),
+				None => Vec::new(),
+			};
+			manipulator_groups.clear();
+			manipulator_groups.extend(handles[start..end].iter().map(|h| h.to_internal()));
+
+			// Note : Bezier-rs panics when < 2 subpath items and closed = false
+			let safe_closed = span.closed && (end - start > 1);
+			self.sub_paths.push(Subpath::new(manipulator_groups, safe_closed));
+		}
+		self.mark_changed();
+	}
+
+	// Packs all subpaths into the mirror buffers
+	pub(crate) fn update_mirror(&mut self) {
+		self.mirror.clear();
+		for sub_path in &self.sub_paths {
+			let offset = self.mirror.handles.len();
+			self.mirror.handles.extend(sub_path_to_vec(sub_path));
+			self.mirror.spans.push(bezrsShapeSpan {
+				offset: offset as SizeTC,
+				len: (self.mirror.handles.len() - offset) as SizeTC,
+				closed: sub_path.closed(),
+			});
+		}
+	}
+
+	fn prepare(&mut self) {
+		if self.prepared.len() != self.sub_paths.len() {
+			self.prepared = self.sub_paths.iter().map(|sub_path| Prepared::new(sub_path)).collect();
+		}
+	}
+
+	fn is_filled(&self, winding : i32) -> bool {
+		match self.fill_rule {
+			bezrsFillRule::NonZero => winding != 0,
+			bezrsFillRule::EvenOdd => winding % 2 != 0,
+		}
+	}
+
+	// Single-call containment over all subpaths, applying the fill rule
+	pub(crate) fn contains_point(&mut self, p : DVec2) -> bool {
+		self.prepare();
+		let winding : i32 = self.prepared.iter().map(|prepared| prepared.winding(p)).sum();
+		self.is_filled(winding)
+	}
+
+	pub(crate) fn bounding_box(&mut self) -> Option<[DVec2; 2]> {
+		self.prepare();
+		self.prepared.iter()
+			.filter_map(|prepared| prepared.bounds)
+			.reduce(|a, b| a.union(&b))
+			.map(|b : Bounds| [b.min, b.max])
+	}
+
+	// Classifies each subpath by comparing the fill just inside and just outside of it.
+	fn roles(&mut self) -> Vec<Role> {
+		self.prepare();
+		(0..self.sub_paths.len()).map(|i| {
+			let sub_path = &self.sub_paths[i];
+			if !sub_path.closed() || sub_path.len() < 2 {
+				return Role::Other;
+			}
+			let area = segments::signed_area(sub_path);
+			if area == 0.0 {
+				return Role::Other;
+			}
+			// Sample on the contour itself : only the other subpaths count
+			let p = sub_path.manipulator_groups()[0].anchor;
+			let others : i32 = self.prepared.iter().enumerate()
+				.filter(|(j, _)| *j != i)
+				.map(|(_, prepared)| prepared.winding(p))
+				.sum();
+			let own = if area > 0.0 { 1 } else { -1 };
+			match (self.is_filled(others), self.is_filled(others + own)) {
+				(false, true) => Role::Outer,
+				(true, false) => Role::Hole,
+				_ => Role::Other,
+			}
+		}).collect()
+	}
+
+	// Offsets all subpaths so that the filled area grows or shrinks uniformly (positive goes inside the filled area).
+	// Outer contours end up winding clockwise and holes counter-clockwise.
+	pub(crate) fn offset(&mut self, distance : f64, join : Join) {
+		let roles = self.roles();
+		for (sub_path, role) in self.sub_paths.iter_mut().zip(roles) {
+			if sub_path.len() < 2 {
+				continue;
+			}
+			let area = segments::signed_area(sub_path);
+			let reverse = match role {
+				Role::Outer => area < 0.0,
+				Role::Hole => area > 0.0,
+				Role::Other => false,
+			};
+			if reverse {
+				*sub_path = sub_path.reverse();
+			}
+			*sub_path = sub_path.offset(distance, join);
+		}
+		self.mark_changed();
+	}
+
+	// Replaces every subpath by its outline. Each outline ring is oriented (outer clockwise, inner counter-clockwise)
+	// and the fill rule becomes non-zero, so overlapping rings merge instead of cancelling out.
+	pub(crate) fn outline(&mut self, distance : f64, join : Join, cap : Cap) {
+		let mut outlines : Vec<Subpath<EmptyId>> = Vec::with_capacity(self.sub_paths.len() * 2);
+		for sub_path in self.sub_paths.drain(..) {
+			if sub_path.len() < 2 {
+				continue;
+			}
+			let (first, second) = sub_path.outline(distance, join, cap);
+			let mut rings = vec![(segments::signed_area(&first), first)];
+			if let Some(second) = second {
+				rings.push((segments::signed_area(&second), second));
+			}
+			let outer_area = rings.iter().map(|(area, _)| area.abs()).fold(0.0, f64::max);
+			for (area, ring) in rings {
+				let is_outer = area.abs() >= outer_area;
+				outlines.push(if is_outer == (area < 0.0) { ring.reverse() } else { ring });
+			}
+		}
+		self.sub_paths = outlines;
+		self.fill_rule = bezrsFillRule::NonZero;
+		self.mark_changed();
+	}
+}
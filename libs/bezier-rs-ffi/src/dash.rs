@@ -0,0 +1,135 @@
+
+// Dash pattern generation : trims the shape into real cubic pieces at the dash boundaries.
+
+use bezier_rs::Subpath;
+
+use crate::EmptyId;
+use crate::arclength::{self, ArcTable, PathWalker};
+use crate::multishape::MultiShapeData;
+use crate::segments::Cubic;
+
+// Below this length (in local t), a trimmed segment end is considered degenerate and dropped.
+const T_EPSILON : f64 = 1e-9;
+// Upper bound of pattern steps (dashes and gaps) per call, against negligible pattern lengths
+const MAX_DASH_STEPS : usize = 1 << 20;
+
+// Appends the pieces of the shape between distances `from` and `to` (from <= to) to `chain`.
+fn collect_range(tables : &[ArcTable], walker : &mut PathWalker, from : f64, to : f64, chain : &mut Vec<Cubic>) {
+	let (start, end) = match (walker.locate(from), walker.locate(to)) {
+		(Some(start), Some(end)) => (start, end),
+		_ => return,
+	};
+	if start.segment == end.segment {
+		chain.push(tables[start.segment].cubic.trim(start.t, end.t));
+		return;
+	}
+	if start.t < 1.0 - T_EPSILON {
+		chain.push(tables[start.segment].cubic.trim(start.t, 1.0));
+	}
+	for table in &tables[start.segment + 1..end.segment] {
+		chain.push(table.cubic);
+	}
+	if end.t > T_EPSILON {
+		chain.push(tables[end.segment].cubic.trim(0.0, end.t));
+	}
+}
+
+// Dashes the subpath into `out` (which is cleared first). Returns the amount of dashes.
+// `pattern` alternates "on" and "off" lengths, an odd-sized pattern is repeated twice (like SVG).
+// `phase` is the distance into the pattern at which the shape starts.
+// Returns 0 when the pattern is so short that covering the shape would take more than `MAX_DASH_STEPS` steps.
+pub(crate) fn dash_subpath(sub_path : &Subpath<EmptyId>, pattern : &[f64], phase : f64, out : &mut MultiShapeData) -> usize {
+	out.clear();
+
+	let pattern : Vec<f64> = if pattern.len() % 2 == 1 { pattern.iter().chain(pattern.iter()).copied().collect() } else { pattern.to_vec() };
+	let pattern_length : f64 = pattern.iter().sum();
+	if pattern.is_empty() || pattern.iter().any(|l| *l < 0.0 || !l.is_finite()) || pattern_length <= 0.0 {
+		return 0;
+	}
+
+	let tables = arclength::build_tables(sub_path);
+	let total : f64 = tables.iter().map(|table| table.length()).sum();
+	if !(total > 0.0) || (total / pattern_length + 2.0) * pattern.len() as f64 > MAX_DASH_STEPS as f64 {
+		return 0;
+	}
+
+	// Find where the shape starts in the pattern (within one cycle, even when rounding leaves `remaining` at the pattern length)
+	let mut index = 0;
+	let mut remaining = phase.rem_euclid(pattern_length);
+	for _ in 0..pattern.len() {
+		if remaining < pattern[index] {
+			break;
+		}
+		remaining -= pattern[index];
+		index = (index + 1) % pattern.len();
+	}
+	let mut intervals : Vec<(f64, f64)> = Vec::new();
+	let mut distance = -remaining;
+	let mut cycle_start = distance;
+	for _ in 0..MAX_DASH_STEPS {
+		if distance >= total {
+			break;
+		}
+		let next = distance + pattern[index];
+		if index % 2 == 0 && next > 0.0 && next > distance {
+			intervals.push((distance.max(0.0), next.min(total)));
+		}
+		distance = next;
+		index = (index + 1) % pattern.len();
+		// Lengths lost in rounding at this distance : a whole cycle stops moving forward
+		if index == 0 {
+			if distance <= cycle_start {
+				break;
+			}
+			cycle_start = distance;
+		}
+	}
+
+	// On closed shapes, a dash running over the start point continues the last one.
+	let wraps = sub_path.closed() && intervals.len() > 1
+		&& intervals[0].0 <= 0.0 && intervals[intervals.len() - 1].1 >= total;
+
+	let mut walker = PathWalker::new(&tables);
+	let mut chain : Vec<Cubic> = Vec::new();
+	let mut first_chain : Vec<Cubic> = Vec::new();
+	for (i, &(from, to)) in intervals.iter().enumerate() {
+		if wraps && i == 0 {
+			collect_range(&tables, &mut walker, from, to, &mut first_chain);
+			continue;
+		}
+		chain.clear();
+		collect_range(&tables, &mut walker, from, to, &mut chain);
+		if wraps && i == intervals.len() - 1 {
+			chain.extend_from_slice(&first_chain);
+		}
+		out.push_chain(&chain, false);
+	}
+
+	out.spans.len()
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use bezier_rs::ManipulatorGroup;
+	use glam::f64::DVec2;
+
+	fn line(length : f64) -> Subpath<EmptyId> {
+		let group = |anchor : DVec2| ManipulatorGroup { anchor, in_handle: None, out_handle: None, id: EmptyId };
+		Subpath::new(vec![group(DVec2::ZERO), group(DVec2::new(length, 0.0))], false)
+	}
+
+	// Negligible pattern lengths used to spin forever
+	#[test]
+	fn negligible_patterns_terminate() {
+		let mut out = MultiShapeData::default();
+		assert_eq!(dash_subpath(&line(1000.0), &[1e-20, 1e-20], 0.0, &mut out), 0);
+		assert_eq!(dash_subpath(&line(1000.0), &[1e-4, 1e-4], 0.0, &mut out), 0);
+
+		// Dashes lost in rounding far along the path are skipped, the gaps still advance
+		let count = dash_subpath(&line(1000.0), &[1e-20, 10.0], 0.0, &mut out);
+		assert!(count >= 1 && count <= 100, "{}", count);
+
+		assert_eq!(dash_subpath(&line(1000.0), &[10.0, 10.0], 5.0, &mut out), 51);
+	}
+}
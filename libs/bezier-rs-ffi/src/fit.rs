@@ -0,0 +1,317 @@
+
+// Curve fitting : dense polylines to a minimal chain of cubic segments.
+// Based on Philip J. Schneider's "An Algorithm for Automatically Fitting Digitized Curves" (Graphics Gems, 1990) :
+// chord-length parametrisation, least-squares control points along fixed end tangents,
+// Newton-Raphson reparametrisation, then recursive splitting at the worst point.
+// Sharp corners are detected beforehand and kept as tangent discontinuities.
+
+use glam::f64::DVec2;
+
+use crate::segments::Cubic;
+
+// Reparametrisation passes before splitting
+const MAX_ITERATIONS : usize = 8;
+// Consecutive points closer than this are merged
+const MIN_POINT_DISTANCE : f64 = 1e-9;
+// Amount of points used for estimating the tangent at the ends of a run
+const TANGENT_SPAN : usize = 3;
+// Trailing segments kept live by the incremental fitter, refitted as the stroke grows
+const LIVE_SEGMENTS : usize = 2;
+
+// A fitted segment, with the index of the input point where it ends
+#[derive(Debug, Copy, Clone)]
+pub(crate) struct FittedCubic {
+	pub(crate) cubic : Cubic,
+	pub(crate) end : usize,
+}
+
+fn direction(from : DVec2, to : DVec2) -> DVec2 {
+	(to - from).normalize_or_zero()
+}
+
+// Tangent leaving points[0], estimated over a few points to resist noise
+fn start_tangent(points : &[DVec2]) -> DVec2 {
+	direction(points[0], points[TANGENT_SPAN.min(points.len() - 1)])
+}
+
+// Tangent leaving points[last] backwards
+fn end_tangent(points : &[DVec2]) -> DVec2 {
+	let last = points.len() - 1;
+	direction(points[last], points[last - TANGENT_SPAN.min(last)])
+}
+
+// Indexes of the interior points where the polyline turns more than `corner_angle` radians (disabled when <= 0)
+fn corners(points : &[DVec2], corner_angle : f64, out : &mut Vec<usize>) {
+	out.clear();
+	if corner_angle <= 0.0 || points.len() < 3 {
+		return;
+	}
+	let cos_limit = corner_angle.cos();
+	for i in 1..points.len() - 1 {
+		let (a, b) = (direction(points[i - 1], points[i]), direction(points[i], points[i + 1]));
+		if a.dot(b) < cos_limit {
+			out.push(i);
+		}
+	}
+}
+
+fn chord_length_parametrize(points : &[DVec2], u : &mut Vec<f64>) {
+	u.clear();
+	u.push(0.0);
+	for i in 1..points.len() {
+		let previous = u[i - 1];
+		u.push(previous + points[i].distance(points[i - 1]));
+	}
+	let total = u[u.len() - 1];
+	if total > 0.0 {
+		for value in u.iter_mut() {
+			*value /= total;
+		}
+	}
+}
+
+// Least-squares control points for fixed end points and tangent directions
+fn generate_cubic(points : &[DVec2], u : &[f64], tangent_start : DVec2, tangent_end : DVec2) -> Cubic {
+	let (first, last) = (points[0], points[points.len() - 1]);
+	let mut c = [[0.0f64; 2]; 2];
+	let mut x = [0.0f64; 2];
+	for (p, t) in points.iter().zip(u.iter()) {
+		let mt = 1.0 - t;
+		let (b0, b1, b2, b3) = (mt * mt * mt, 3.0 * t * mt * mt, 3.0 * t * t * mt, t * t * t);
+		let (a0, a1) = (tangent_start * b1, tangent_end * b2);
+		c[0][0] += a0.dot(a0);
+		c[0][1] += a0.dot(a1);
+		c[1][1] += a1.dot(a1);
+		let rest = *p - (first * (b0 + b1) + last * (b2 + b3));
+		x[0] += a0.dot(rest);
+		x[1] += a1.dot(rest);
+	}
+	c[1][0] = c[0][1];
+
+	let det_c0_c1 = c[0][0] * c[1][1] - c[1][0] * c[0][1];
+	let det_c0_x = c[0][0] * x[1] - c[1][0] * x[0];
+	let det_x_c1 = x[0] * c[1][1] - x[1] * c[0][1];
+	let (mut alpha_start, mut alpha_end) = if det_c0_c1 == 0.0 { (0.0, 0.0) } else { (det_x_c1 / det_c0_c1, det_c0_x / det_c0_c1) };
+
+	// Degenerate or flipped handles : fall back to the Wu/Barsky heuristic
+	let segment_length = first.distance(last);
+	let epsilon = 1e-6 * segment_length;
+	if alpha_start < epsilon || alpha_end < epsilon {
+		alpha_start = segment_length / 3.0;
+		alpha_end = alpha_start;
+	}
+	Cubic { p0: first, p1: first + tangent_start * alpha_start, p2: last + tangent_end * alpha_end, p3: last }
+}
+
+// Largest squared distance between the points and their parameter on the cubic, with its index
+fn max_error(points : &[DVec2], cubic : &Cubic, u : &[f64]) -> (f64, usize) {
+	let mut worst = (0.0, points.len() / 2);
+	for i in 1..points.len() - 1 {
+		let error = cubic.evaluate(u[i]).distance_squared(points[i]);
+		if error >= worst.0 {
+			worst = (error, i);
+		}
+	}
+	worst
+}
+
+// One Newton-Raphson step per point on the distance to the cubic
+fn reparametrize(points : &[DVec2], cubic : &Cubic, u : &mut [f64]) {
+	for (p, t) in points.iter().zip(u.iter_mut()) {
+		let offset = cubic.evaluate(*t) - *p;
+		let d1 = cubic.derivative(*t);
+		let numerator = offset.dot(d1);
+		let denominator = d1.dot(d1) + offset.dot(cubic.second_derivative(*t));
+		if denominator.abs() > 1e-18 {
+			*t = (*t - numerator / denominator).clamp(0.0, 1.0);
+		}
+	}
+}
+
+// Working buffers, reused across fits
+#[derive(Debug, Default)]
+pub(crate) struct Fitter {
+	u : Vec<f64>,
+	corners : Vec<usize>,
+}
+
+impl Fitter {
+
+	// Fits points[..] between two tangent directions (pointing inwards), appending segments with absolute end indexes.
+	fn fit_run(&mut self, points : &[DVec2], base : usize, tangent_start : DVec2, tangent_end : DVec2, tolerance_sq : f64, out : &mut Vec<FittedCubic>) {
+		let (first, last) = (points[0], points[points.len() - 1]);
+		if points.len() == 2 {
+			let third = first.distance(last) / 3.0;
+			out.push(FittedCubic { cubic: Cubic { p0: first, p1: first + tangent_start * third, p2: last + tangent_end * third, p3: last }, end: base + 1 });
+			return;
+		}
+
+		chord_length_parametrize(points, &mut self.u);
+		let mut cubic = generate_cubic(points, &self.u, tangent_start, tangent_end);
+		let (mut error, mut split) = max_error(points, &cubic, &self.u);
+		if error <= tolerance_sq {
+			out.push(FittedCubic { cubic, end: base + points.len() - 1 });
+			return;
+		}
+
+		// Close enough : try improving the parametrisation before splitting
+		if error <= tolerance_sq * 16.0 {
+			for _ in 0..MAX_ITERATIONS {
+				reparametrize(points, &cubic, &mut self.u);
+				cubic = generate_cubic(points, &self.u, tangent_start, tangent_end);
+				(error, split) = max_error(points, &cubic, &self.u);
+				if error <= tolerance_sq {
+					out.push(FittedCubic { cubic, end: base + points.len() - 1 });
+					return;
+				}
+			}
+		}
+
+		// Split at the worst point, keeping the tangent continuous there
+		let mut tangent_center = direction(points[split + 1], points[split - 1]);
+		if tangent_center == DVec2::ZERO {
+			tangent_center = direction(points[split], points[split - 1]);
+		}
+		self.fit_run(&points[..=split], base, tangent_start, tangent_center, tolerance_sq, out);
+		self.fit_run(&points[split..], base + split, -tangent_center, tangent_end, tolerance_sq, out);
+	}
+
+	// Fits a single cubic through the points between two tangent directions, or None if it can't stay within the tolerance.
+	pub(crate) fn fit_single(&mut self, points : &[DVec2], tangent_start : DVec2, tangent_end : DVec2, tolerance_sq : f64) -> Option<Cubic> {
+		if points.len() < 3 {
+			return None;
+		}
+		chord_length_parametrize(points, &mut self.u);
+		let mut cubic = generate_cubic(points, &self.u, tangent_start, tangent_end);
+		for _ in 0..MAX_ITERATIONS {
+			let (error, _) = max_error(points, &cubic, &self.u);
+			if error <= tolerance_sq {
+				return Some(cubic);
+			}
+			if error > tolerance_sq * 16.0 {
+				break;
+			}
+			reparametrize(points, &cubic, &mut self.u);
+			cubic = generate_cubic(points, &self.u, tangent_start, tangent_end);
+		}
+		None
+	}
+
+	// Fits an open polyline, split at corners. `tangent_start` forces the starting direction (for G1 continuation) when given.
+	pub(crate) fn fit_open(&mut self, points : &[DVec2], base : usize, tolerance : f64, corner_angle : f64, tangent_start : Option<DVec2>, out : &mut Vec<FittedCubic>) {
+		if points.len() < 2 {
+			return;
+		}
+		let tolerance_sq = (tolerance * tolerance).max(1e-18);
+		let mut corners = std::mem::take(&mut self.corners);
+		crate::fit::corners(points, corner_angle, &mut corners);
+		let mut start = 0;
+		for end in corners.iter().copied().chain(std::iter::once(points.len() - 1)) {
+			let run = &points[start..=end];
+			let tangent = match tangent_start {
+				Some(tangent) if start == 0 && tangent != DVec2::ZERO => tangent,
+				_ => start_tangent(run),
+			};
+			self.fit_run(run, base + start, tangent, end_tangent(run), tolerance_sq, out);
+			start = end;
+		}
+		self.corners = corners;
+	}
+
+	// Fits a closed polyline (the closing segment being implied), returning segments forming a loop.
+	pub(crate) fn fit_closed(&mut self, points : &[DVec2], tolerance : f64, corner_angle : f64, out : &mut Vec<FittedCubic>) {
+		if points.len() < 3 {
+			return self.fit_open(points, 0, tolerance, corner_angle, None, out);
+		}
+		let mut looped : Vec<DVec2> = Vec::with_capacity(points.len() + 1);
+		looped.extend_from_slice(points);
+		looped.push(points[0]);
+
+		// Smooth start unless the closing point is a corner
+		let n = points.len();
+		let incoming = direction(points[n - 1], points[0]);
+		let outgoing = direction(points[0], points[1]);
+		let is_corner = corner_angle > 0.0 && incoming.dot(outgoing) < corner_angle.cos();
+		let tangent = if is_corner { None } else { Some(direction(points[n - 1], points[1])) };
+
+		let tolerance_sq = (tolerance * tolerance).max(1e-18);
+		let mut corners = std::mem::take(&mut self.corners);
+		crate::fit::corners(&looped, corner_angle, &mut corners);
+		let mut start = 0;
+		for end in corners.iter().copied().chain(std::iter::once(looped.len() - 1)) {
+			let run = &looped[start..=end];
+			let tangent_start = if start == 0 { tangent.unwrap_or_else(|| start_tangent(run)) } else { start_tangent(run) };
+			let tangent_end = if end == looped.len() - 1 { tangent.map(|t| -t).unwrap_or_else(|| end_tangent(run)) } else { end_tangent(run) };
+			self.fit_run(run, start, tangent_start, tangent_end, tolerance_sq, out);
+			start = end;
+		}
+		self.corners = corners;
+	}
+}
+
+// Drops consecutive duplicates, which would break the parametrisation
+pub(crate) fn push_points(points : &mut Vec<DVec2>, input : impl Iterator<Item = DVec2>) {
+	for p in input {
+		if points.last().map_or(true, |last| last.distance_squared(p) > MIN_POINT_DISTANCE * MIN_POINT_DISTANCE) {
+			points.push(p);
+		}
+	}
+}
+
+// Incremental fitting of a growing stroke : all segments but the last few are frozen,
+// so each update only refits the tail of the stroke (continuing the frozen part's tangent).
+#[derive(Debug, Default)]
+pub(crate) struct StrokeFitter {
+	pub(crate) tolerance : f64,
+	pub(crate) corner_angle : f64,
+	points : Vec<DVec2>,
+	frozen : Vec<Cubic>,
+	frozen_end : usize, // Index of the point where the frozen segments end
+	tail : Vec<FittedCubic>,
+	fitter : Fitter,
+}
+
+impl StrokeFitter {
+
+	pub(crate) fn new(tolerance : f64, corner_angle : f64) -> Self {
+		StrokeFitter { tolerance, corner_angle, ..Default::default() }
+	}
+
+	pub(crate) fn clear(&mut self) {
+		self.points.clear();
+		self.frozen.clear();
+		self.frozen_end = 0;
+		self.tail.clear();
+	}
+
+	pub(crate) fn add_points(&mut self, input : impl Iterator<Item = DVec2>) {
+		let previous_len = self.points.len();
+		push_points(&mut self.points, input);
+		if self.points.len() == previous_len {
+			return;
+		}
+
+		// Refit the tail, continuing the frozen part smoothly
+		let tangent_start = self.frozen.last().map(|cubic| direction(cubic.p2, cubic.p3));
+		self.tail.clear();
+		let tail_points = &self.points[self.frozen_end..];
+		self.fitter.fit_open(tail_points, self.frozen_end, self.tolerance, self.corner_angle, tangent_start, &mut self.tail);
+
+		// Freeze the settled segments
+		if self.tail.len() > LIVE_SEGMENTS {
+			let settled = self.tail.len() - LIVE_SEGMENTS;
+			self.frozen.extend(self.tail[..settled].iter().map(|fitted| fitted.cubic));
+			self.frozen_end = self.tail[settled - 1].end;
+			self.tail.drain(..settled);
+		}
+	}
+
+	// Frozen then live segments
+	pub(crate) fn segments(&self) -> impl Iterator<Item = Cubic> + '_ {
+		self.frozen.iter().copied().chain(self.tail.iter().map(|fitted| fitted.cubic))
+	}
+
+	pub(crate) fn points_len(&self) -> usize {
+		self.points.len()
+	}
+}
@@ -0,0 +1,27 @@
+
+// Flattening of cubic segments into polylines, with a bounded chord error.
+
+use glam::f64::DVec2;
+
+use crate::segments::Cubic;
+
+// Upper bound on the amount of lines emitted per segment
+const MAX_LINES_PER_SEGMENT : usize = 4096;
+
+// Amount of uniform t-steps needed so that the chords stay within `tolerance` of the curve.
+// The chord error of a step h is bounded by max|B''| * h^2 / 8.
+pub(crate) fn lines_for_tolerance(cubic : &Cubic, tolerance : f64) -> usize {
+	let dd = (cubic.p0 - cubic.p1 * 2.0 + cubic.p2).length().max((cubic.p1 - cubic.p2 * 2.0 + cubic.p3).length()) * 6.0;
+	let lines = (dd / (8.0 * tolerance.max(1e-12))).sqrt().ceil();
+	if lines.is_finite() { (lines as usize).clamp(1, MAX_LINES_PER_SEGMENT) } else { 1 }
+}
+
+// Appends the flattened segment to `points`, excluding its start point (so segments can be chained).
+pub(crate) fn flatten_cubic_into(cubic : &Cubic, tolerance : f64, points : &mut Vec<DVec2>) {
+	let lines = lines_for_tolerance(cubic, tolerance);
+	let step = 1.0 / lines as f64;
+	for i in 1..lines {
+		points.push(cubic.evaluate(i as f64 * step));
+	}
+	points.push(cubic.p3);
+}
@@ -0,0 +1,194 @@
+
+// Line crossings and hatch fills, sharing one scanline sweep.
+// The subpaths are rotated so that the lines become horizontal, then split into y-monotonic edges sorted by their lowest y.
+// Lines are visited in increasing y while an active edge list is kept up to date, so each line only tests the edges spanning it.
+
+use bezier_rs::Subpath;
+use glam::f64::DVec2;
+
+use crate::{EmptyId, bezrsFillRule, bezrsLine};
+use crate::multishape::MultiShapeData;
+use crate::segments::{self, Cubic};
+
+// Upper bound of hatch lines per call, against degenerate spacings (documented in `bezrs_shape_hatch()`)
+const MAX_HATCH_LINES : usize = 1 << 20;
+
+#[derive(Debug)]
+struct Edge {
+	cubic : Cubic, // In the sweep frame, y-monotonic
+	y_min : f64,
+	y_max : f64,
+	direction : i32, // +1 when y increases along the edge
+}
+
+// Maps a point to the frame where `u` is the x axis
+#[inline]
+fn to_frame(u : DVec2, p : DVec2) -> DVec2 {
+	DVec2::new(u.x * p.x + u.y * p.y, u.x * p.y - u.y * p.x)
+}
+
+#[inline]
+fn from_frame(u : DVec2, q : DVec2) -> DVec2 {
+	u * q.x + DVec2::new(-u.y, u.x) * q.y
+}
+
+pub(crate) struct Sweep {
+	edges : Vec<Edge>, // Sorted by y_min
+}
+
+impl Sweep {
+
+	// `u` is the (unit) direction of the lines. Open paths are implicitly closed by a line when `close_open_paths`.
+	pub(crate) fn new(sub_paths : &[&Subpath<EmptyId>], u : DVec2, close_open_paths : bool) -> Self {
+		let mut edges : Vec<Edge> = Vec::new();
+		let mut push = |cubic : Cubic, t0 : f64, t1 : f64| {
+			let piece = cubic.trim(t0, t1);
+			let (y0, y1) = (piece.p0.y, piece.p3.y);
+			if y0 != y1 {
+				edges.push(Edge { cubic: piece, y_min: y0.min(y1), y_max: y0.max(y1), direction: if y1 > y0 { 1 } else { -1 } });
+			}
+		};
+		for sub_path in sub_paths {
+			for cubic in segments::iter_cubics(sub_path) {
+				let cubic = Cubic { p0: to_frame(u, cubic.p0), p1: to_frame(u, cubic.p1), p2: to_frame(u, cubic.p2), p3: to_frame(u, cubic.p3) };
+				let mut t0 = 0.0;
+				for t1 in cubic.extrema()[1].iter().copied().chain(std::iter::once(1.0)) {
+					push(cubic, t0, t1);
+					t0 = t1;
+				}
+			}
+			let groups = sub_path.manipulator_groups();
+			if close_open_paths && !sub_path.closed() && groups.len() > 1 {
+				let (a, b) = (to_frame(u, groups[groups.len() - 1].anchor), to_frame(u, groups[0].anchor));
+				push(Cubic { p0: a, p1: a.lerp(b, 1.0 / 3.0), p2: a.lerp(b, 2.0 / 3.0), p3: b }, 0.0, 1.0);
+			}
+		}
+		edges.sort_unstable_by(|a, b| a.y_min.total_cmp(&b.y_min));
+		Sweep { edges }
+	}
+
+	// Range of y covered by the edges, in the sweep frame
+	pub(crate) fn y_range(&self) -> Option<(f64, f64)> {
+		let y_max = self.edges.iter().map(|edge| edge.y_max).fold(f64::NEG_INFINITY, f64::max);
+		self.edges.first().map(|edge| (edge.y_min, y_max))
+	}
+
+	// Calls `visit(i, crossings)` for every line y = `ys[i]` (sorted in increasing order), with its crossings
+	// as (x, direction) sorted by x. Edge end points follow the half-open rule, so shared vertices count once.
+	pub(crate) fn scan<F : FnMut(usize, &[(f64, i32)])>(&self, ys : &[f64], mut visit : F) {
+		let mut next_edge = 0;
+		let mut active : Vec<usize> = Vec::new();
+		let mut crossings : Vec<(f64, i32)> = Vec::new();
+		for (i, y) in ys.iter().copied().enumerate() {
+			while next_edge < self.edges.len() && self.edges[next_edge].y_min <= y {
+				active.push(next_edge);
+				next_edge += 1;
+			}
+			active.retain(|e| self.edges[*e].y_max > y);
+
+			crossings.clear();
+			for e in &active {
+				let edge = &self.edges[*e];
+				crossings.push((edge.cubic.evaluate(edge.cubic.solve_monotonic(1, y)).x, edge.direction));
+			}
+			crossings.sort_unstable_by(|a, b| a.0.total_cmp(&b.0));
+			visit(i, &crossings);
+		}
+	}
+}
+
+fn is_filled(winding : i32, fill_rule : bezrsFillRule) -> bool {
+	match fill_rule {
+		bezrsFillRule::NonZero => winding != 0,
+		bezrsFillRule::EvenOdd => winding % 2 != 0,
+	}
+}
+
+// Crossings of many lines with the subpaths (not closing open paths), as (line index, t) sorted by line then t,
+// t being the parameter along each line (origin + t * direction). Parallel lines share one sweep.
+pub(crate) fn intersect_lines(sub_paths : &[&Subpath<EmptyId>], lines : &[bezrsLine], out : &mut Vec<(usize, f64)>) {
+	out.clear();
+
+	// Group the lines by direction (opposite directions share a frame), keeping the sign and length of each direction
+	let mut frames : Vec<(DVec2, usize, f64, f64)> = Vec::with_capacity(lines.len()); // (frame direction, line, sign / length, y)
+	for (i, line) in lines.iter().enumerate() {
+		let d = line.direction.to_dvec2();
+		let length = d.length();
+		if !(length > 0.0) || !length.is_finite() {
+			continue;
+		}
+		let mut u = d / length;
+		let mut scale = 1.0 / length;
+		if u.x < 0.0 || (u.x == 0.0 && u.y < 0.0) {
+			u = -u;
+			scale = -scale;
+		}
+		frames.push((u, i, scale, to_frame(u, line.origin.to_dvec2()).y));
+	}
+	frames.sort_unstable_by(|a, b| a.0.x.total_cmp(&b.0.x).then(a.0.y.total_cmp(&b.0.y)).then(a.3.total_cmp(&b.3)));
+
+	let mut ys : Vec<f64> = Vec::new();
+	let mut start = 0;
+	while start < frames.len() {
+		let u = frames[start].0;
+		let end = start + frames[start..].iter().take_while(|frame| frame.0 == u).count();
+		let group = &frames[start..end];
+		let sweep = Sweep::new(sub_paths, u, false);
+		ys.clear();
+		ys.extend(group.iter().map(|frame| frame.3));
+		sweep.scan(&ys, |i, crossings| {
+			let (_, line, scale, _) = group[i];
+			let origin_x = to_frame(u, lines[line].origin.to_dvec2()).x;
+			out.extend(crossings.iter().map(|(x, _)| (line, (x - origin_x) * scale)));
+		});
+		start = end;
+	}
+	out.sort_unstable_by(|a, b| a.0.cmp(&b.0).then(a.1.total_cmp(&b.1)));
+}
+
+// Hatch segments filling the subpaths (open paths implicitly closed) with lines at `angle` radians, `spacing` apart.
+// Lines are placed at `phase + k * spacing` across the lines direction. When `alternate`, every other line is reversed
+// (serpentine order for plotters). Writes one 2-handle path per segment into `out` (cleared first) and returns their count,
+// 0 when there would be more than `MAX_HATCH_LINES` lines.
+pub(crate) fn hatch(sub_paths : &[&Subpath<EmptyId>], angle : f64, spacing : f64, phase : f64, fill_rule : bezrsFillRule, alternate : bool, out : &mut MultiShapeData) -> usize {
+	out.clear();
+	if !(spacing > 0.0) || !angle.is_finite() || !phase.is_finite() {
+		return 0;
+	}
+	let u = DVec2::new(angle.cos(), angle.sin());
+	let sweep = Sweep::new(sub_paths, u, true);
+	let (y_min, y_max) = match sweep.y_range() {
+		Some(range) => range,
+		None => return 0,
+	};
+	let first = ((y_min - phase) / spacing).ceil();
+	let count = ((y_max - phase) / spacing).floor() - first + 1.0;
+	if !(count >= 1.0) || count > MAX_HATCH_LINES as f64 {
+		return 0;
+	}
+	let ys : Vec<f64> = (0..count as usize).map(|k| phase + (first + k as f64) * spacing).collect();
+
+	let mut row = 0;
+	sweep.scan(&ys, |i, crossings| {
+		let y = ys[i];
+		let row_start = out.spans.len();
+		let mut winding = 0;
+		let mut span_start = 0.0;
+		for (x, direction) in crossings {
+			let was_filled = is_filled(winding, fill_rule);
+			winding += direction;
+			match (was_filled, is_filled(winding, fill_rule)) {
+				(false, true) => span_start = *x,
+				(true, false) if *x > span_start => out.push_line(from_frame(u, DVec2::new(span_start, y)), from_frame(u, DVec2::new(*x, y))),
+				_ => {}
+			}
+		}
+		if out.spans.len() > row_start {
+			if alternate && row % 2 == 1 {
+				out.reverse_from(row_start);
+			}
+			row += 1;
+		}
+	});
+	out.spans.len()
+}
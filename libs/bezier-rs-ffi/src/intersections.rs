@@ -0,0 +1,159 @@
+
+// Self intersections of a subpath, searched segment pair by segment pair within a budget.
+// Pairs are intersected by recursive bounding box subdivision down to `error`, then the hits of one crossing are merged.
+// Loops within a segment are found by splitting it into x/y-monotonic pieces (which can't cross themselves).
+// Curves sharing an anchor always touch there : crossings merged with that contact are not reported.
+
+use bezier_rs::Subpath;
+use glam::f64::DVec2;
+
+use crate::{EmptyId, bezrsStatus};
+use crate::budget::Budget;
+use crate::segments::{self, Cubic, Bounds};
+
+// Subdivision depth limit (t-ranges of 2^-32)
+const MAX_DEPTH : u32 = 32;
+
+// Pair of sub-curves closer than the error
+#[derive(Copy, Clone)]
+struct Leaf {
+	a : (f64, f64),
+	b : (f64, f64),
+	joint : bool, // Touches an end point shared by both curves
+}
+
+// Collects the leaves (t-ranges on both curves) where `a` and `b` are closer than `error`. Returns false when interrupted.
+fn subdivide(a : &Cubic, ra : (f64, f64), b : &Cubic, rb : (f64, f64), error : f64, joints : &[DVec2], depth : u32, budget : &Budget, leaves : &mut Vec<Leaf>) -> bool {
+	let (ba, bb) = (Bounds::from_points(&[a.p0, a.p1, a.p2, a.p3]), Bounds::from_points(&[b.p0, b.p1, b.p2, b.p3]));
+	if ba.distance_to_bounds(&bb) > 0.0 {
+		return true;
+	}
+	if budget.interrupted().is_some() {
+		return false;
+	}
+	let size = |bounds : &Bounds| (bounds.max - bounds.min).max_element();
+	if depth >= MAX_DEPTH || (size(&ba) <= error && size(&bb) <= error) {
+		let joint = joints.iter().any(|p| ba.distance_to_point(*p) <= error && bb.distance_to_point(*p) <= error);
+		leaves.push(Leaf { a: ra, b: rb, joint });
+		return true;
+	}
+	let (am, bm) = (0.5 * (ra.0 + ra.1), 0.5 * (rb.0 + rb.1));
+	let (a_left, a_right) = a.split(0.5);
+	let (b_left, b_right) = b.split(0.5);
+	for (a_half, a_range) in [(a_left, (ra.0, am)), (a_right, (am, ra.1))] {
+		for (b_half, b_range) in [(b_left, (rb.0, bm)), (b_right, (bm, rb.1))] {
+			if !subdivide(&a_half, a_range, &b_half, b_range, error, joints, depth + 1, budget, leaves) {
+				return false;
+			}
+		}
+	}
+	true
+}
+
+// Crossings of 2 curves as (ta, tb). Leaves closer than `min_separation` (in t) on both curves belong to the same crossing.
+// Curves sharing end points (`joints`) always touch there : crossings including them are not reported.
+fn intersect_pair(a : &Cubic, b : &Cubic, error : f64, min_separation : f64, joints : &[DVec2], budget : &Budget, leaves : &mut Vec<Leaf>, out : &mut Vec<(f64, f64)>) -> bool {
+	leaves.clear();
+	let complete = subdivide(a, (0.0, 1.0), b, (0.0, 1.0), error, joints, 0, budget, leaves);
+	leaves.sort_unstable_by(|l, r| l.a.0.total_cmp(&r.a.0));
+
+	let mut push = |cluster : &Leaf| {
+		if !cluster.joint {
+			out.push((0.5 * (cluster.a.0 + cluster.a.1), 0.5 * (cluster.b.0 + cluster.b.1)));
+		}
+	};
+	let mut cluster : Option<Leaf> = None;
+	for leaf in leaves.iter() {
+		match &mut cluster {
+			Some(c) if leaf.a.0 <= c.a.1 + min_separation && leaf.b.0 <= c.b.1 + min_separation && leaf.b.1 >= c.b.0 - min_separation => {
+				c.a.1 = c.a.1.max(leaf.a.1);
+				c.b = (c.b.0.min(leaf.b.0), c.b.1.max(leaf.b.1));
+				c.joint |= leaf.joint;
+			}
+			_ => {
+				if let Some(c) = &cluster {
+					push(c);
+				}
+				cluster = Some(*leaf);
+			}
+		}
+	}
+	if let Some(c) = &cluster {
+		push(c);
+	}
+	complete
+}
+
+// Loops within one segment, as local t-values of the crossing (on its later part)
+fn intersect_self(cubic : &Cubic, error : f64, min_separation : f64, budget : &Budget, leaves : &mut Vec<Leaf>, out : &mut Vec<f64>) -> bool {
+	let [x, y] = cubic.extrema();
+	let mut cuts : Vec<f64> = x.into_iter().chain(y).collect();
+	if cuts.len() < 2 {
+		return true; // A loop turns both ways in x and y
+	}
+	cuts.sort_unstable_by(|a, b| a.total_cmp(b));
+	cuts.insert(0, 0.0);
+	cuts.push(1.0);
+	let pieces : Vec<(Cubic, f64, f64)> = cuts.windows(2).filter(|range| range[1] - range[0] > 1e-12).map(|range| (cubic.trim(range[0], range[1]), range[0], range[1])).collect();
+
+	let mut crossings : Vec<(f64, f64)> = Vec::new();
+	for k in 0..pieces.len() {
+		for l in k + 1..pieces.len() {
+			let joints : &[DVec2] = if l == k + 1 { &[pieces[l].0.p0] } else { &[] };
+			crossings.clear();
+			let complete = intersect_pair(&pieces[k].0, &pieces[l].0, error, min_separation, joints, budget, leaves, &mut crossings);
+			let (t0, t1) = (pieces[l].1, pieces[l].2);
+			out.extend(crossings.iter().map(|(_, tb)| t0 + (t1 - t0) * tb));
+			if !complete {
+				return false;
+			}
+		}
+	}
+	true
+}
+
+// Self intersections as (segment index, local t), like bezier-rs `Subpath::self_intersections()` : one t-value per crossing,
+// on the later segment. Stops between segment pairs (or within long subdivisions) when the budget runs out, and once
+// `max_results` crossings are found. Returns the status of the search along with what was found.
+pub(crate) fn self_intersections(sub_path : &Subpath<EmptyId>, error : f64, min_separation : f64, budget : &Budget, out : &mut Vec<(usize, f64)>) -> bezrsStatus {
+	out.clear();
+	let cubics : Vec<Cubic> = segments::iter_cubics(sub_path).collect();
+	let count = cubics.len();
+	let closed = sub_path.closed();
+	let error = if error > 0.0 { error } else { 1e-3 };
+	let min_separation = if min_separation > 0.0 { min_separation } else { 1e-3 };
+
+	let mut leaves : Vec<Leaf> = Vec::new();
+	let mut joints : Vec<DVec2> = Vec::with_capacity(2);
+	let mut crossings : Vec<(f64, f64)> = Vec::new();
+	let mut loops : Vec<f64> = Vec::new();
+	for j in 0..count {
+		// Loops within segment j, then crossings with the previous segments
+		loops.clear();
+		let mut complete = intersect_self(&cubics[j], error, min_separation, budget, &mut leaves, &mut loops);
+		out.extend(loops.iter().map(|t| (j, *t)));
+		for i in 0..j {
+			if !complete || budget.is_full(out.len()) {
+				break;
+			}
+			joints.clear();
+			if j == i + 1 {
+				joints.push(cubics[j].p0);
+			}
+			if closed && i == 0 && j == count - 1 {
+				joints.push(cubics[i].p0);
+			}
+			crossings.clear();
+			complete = intersect_pair(&cubics[i], &cubics[j], error, min_separation, &joints, budget, &mut leaves, &mut crossings);
+			out.extend(crossings.iter().map(|(_, tb)| (j, *tb)));
+		}
+		if budget.is_full(out.len()) {
+			out.truncate(budget.max_results);
+			return bezrsStatus::Truncated;
+		}
+		if !complete {
+			return budget.interrupted().unwrap_or(bezrsStatus::TimedOut);
+		}
+	}
+	bezrsStatus::Complete
+}
@@ -24,6 +24,8 @@
 use std::slice;
 use std::ptr;
 use std::ffi::c_ulong;
+use std::ffi::c_void;
+use std::sync::Arc;
 use bezier_rs::SubpathTValue; // Warns unused, but doesn't compile without this import !
 //use bezier_rs::TValue;
 
@@ -34,6 +36,34 @@ use bezier_rs::{Cap, Join};
 // Included for conversions
 use glam::f64::DVec2; // point class, already defined repr(C)
 
+// Internal modules
+mod parallel;
+mod affine;
+mod segments;
+mod arclength;
+mod multishape;
+mod dash;
+mod flatten;
+mod sdf;
+mod raster;
+mod prepared;
+mod compound;
+mod fit;
+mod simplify;
+mod offset;
+mod strided;
+mod morph;
+mod split;
+mod hatch;
+mod single;
+mod budget;
+mod intersections;
+mod clip;
+mod biarc;
+mod metrics;
+mod lod;
+mod outline;
+
 // Typedef : C -> std::size_t, Rust -> usize
 // Binding might be defined depending on target platform ?
 // usize becomes uintptr_t while std:size_t is u64 on osx-64 and linux-64
@@ -42,20 +72,74 @@ type SizeTC = c_ulong;//usize;//u64; // A type compatible with `std::size_t`, th
 
 /// Join type enum
 #[repr(C)]
+#[derive(Debug, Copy, Clone, PartialEq)]
 pub enum bezrsJoinType {
 	Bevel,
 	Mitter,
 	Round,
 }
 
+/// Scalar type of strided point data
+#[repr(C)]
+#[derive(Debug, Copy, Clone, PartialEq)]
+pub enum bezrsScalarType {
+	Float,
+	Double,
+}
+
 /// Cap type enum
 #[repr(C)]
+#[derive(Debug, Copy, Clone, PartialEq)]
 pub enum bezrsCapType {
 	Butt,
 	Round,
 	Square,
 }
 
+/// Fill rule enum
+#[repr(C)]
+#[derive(Debug, Copy, Clone, PartialEq)]
+pub enum bezrsFillRule {
+	NonZero,
+	EvenOdd,
+}
+
+/// Outcome of an operation running within a budget (see `bezrsBudget`)
+#[repr(C)]
+#[derive(Debug, Copy, Clone, PartialEq)]
+pub enum bezrsStatus {
+	/// Finished
+	Complete,
+	/// Stopped at the result cap : the first `max_results` results are returned
+	Truncated,
+	/// Stopped at the deadline
+	TimedOut,
+	/// Stopped by its cancellation token
+	Cancelled,
+}
+
+/// Winding direction, from the sign of the enclosed area : clockwise on screen (y axis down) is positive.
+#[repr(C)]
+#[derive(Debug, Copy, Clone, PartialEq)]
+pub enum bezrsWinding {
+	/// Null area (lines, degenerate shapes), or keeping the given direction
+	None,
+	Clockwise,
+	CounterClockwise,
+}
+
+/// Placement of the samples of a width profile (see `bezrs_shape_outline_variable()`)
+#[repr(C)]
+#[derive(Debug, Copy, Clone, PartialEq)]
+pub enum bezrsWidthMode {
+	/// At global t-values (0 -> 1, each segment spanning an equal part)
+	GlobalT,
+	/// At normalized arc length (0 -> 1)
+	ArcLength,
+	/// One sample per anchor, in order (t is ignored)
+	PerHandle,
+}
+
 pub fn parse_join(join: bezrsJoinType, miter_limit: Option<f64>) -> Join {
 	match join {
 		bezrsJoinType::Bevel => Join::Bevel,
@@ -151,6 +235,35 @@ pub struct bezrsBezierHandle {
     pub out_bez : bezrsPos,
 }
 
+/// Single precision position (x, y), same layout as `glm::vec2` (see `bezrs_shapef_create()`).
+#[repr(C)]
+#[derive(Debug, Copy, Clone, Default)]
+pub struct bezrsPosF {
+    pub x : f32,
+    pub y : f32,
+}
+
+/// Single precision bezier handle
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct bezrsBezierHandleF {
+    pub pos : bezrsPosF,
+    pub in_bez : bezrsPosF,
+    pub out_bez : bezrsPosF,
+}
+
+/// Limits for long running operations. Zeroed fields mean no limit.
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct bezrsBudget {
+    /// Time allowed for the call, in milliseconds (<= 0 : unlimited)
+    pub time_limit_ms : f64,
+    /// Maximum amount of results (0 : unlimited)
+    pub max_results : SizeTC,
+    /// Optional token for cancelling the call from another thread (can be null)
+    pub cancel : *const bezrsCancelToken,
+}
+
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct bezrsRect {
@@ -158,6 +271,97 @@ pub struct bezrsRect {
     pub size : bezrsPos,
 }
 
+/// Infinite line through `origin` along `direction`. Positions along it are parameters t, at origin + t * direction.
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct bezrsLine {
+    pub origin : bezrsPos,
+    pub direction : bezrsPos,
+}
+
+/// One move of a toolpath : a line or a circular arc, starting where the previous move ended (the first one at the start of the shape).
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct bezrsToolpathMove {
+    /// End point
+    pub end : bezrsPos,
+    /// Center of the arc (the end point for lines)
+    pub center : bezrsPos,
+    /// Signed angle swept by the arc in radians, 0 for lines. Positive turns from +x towards +y :
+    /// counter-clockwise with the y axis up (G-code G3), clockwise on screen (y axis down, G2 once flipped).
+    pub sweep : f64,
+}
+
+/// Receives toolpath moves by chunks (see `bezrs_shape_biarcs_stream()`). Returning false stops the approximation.
+pub type bezrsToolpathCallback = Option<extern "C" fn(_moves: *const bezrsToolpathMove, _len: SizeTC, _user_data: *mut c_void) -> bool>;
+
+/// Metrics of a shape, computed in a single pass (see `bezrs_shape_metrics()`).
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct bezrsShapeMetrics {
+    /// Enclosed area, positive when winding clockwise on screen (open paths are implicitly closed by a line)
+    pub signed_area : f64,
+    /// Winding direction (from the sign of the area)
+    pub winding : bezrsWinding,
+    /// Centroid of the enclosed area (of the curve itself when the area is null)
+    pub centroid : bezrsPos,
+    /// Arc length
+    pub length : f64,
+    /// Tight bounding box of the curve
+    pub bounds : bezrsRect,
+}
+
+/// Rust owned polyline of a shape (see `bezrs_shape_lod_polyline()`).
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct bezrsPolylineRaw {
+    /// Points, closed shapes ending with their start point (null when empty)
+    pub data : *const bezrsPos,
+    /// count of points
+    pub len : SizeTC,
+    /// Tolerance of the cached level, in shape units
+    pub tolerance : f64,
+}
+
+/// One sample of a width profile (see `bezrs_shape_outline_variable()`).
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct bezrsWidthSample {
+    /// Position along the shape, as set by `bezrsWidthMode`
+    pub t : f64,
+    /// Stroke width : each side is offset by half of it
+    pub width : f64,
+}
+
+/// Compiled shape segment, for evaluating the shape without crossing the FFI.
+/// Power basis : pos(t) = c[0] + c[1]*t + c[2]*t^2 + c[3]*t^3, with t local to the segment (0->1).
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct bezrsCompiledSegment {
+    /// x coefficients, from constant to cubic term
+    pub x : [f64; 4],
+    /// y coefficients, from constant to cubic term
+    pub y : [f64; 4],
+    /// Arc length of all previous segments (length prefix)
+    pub length_start : f64,
+    /// Arc length of this segment
+    pub length : f64,
+}
+
+/// 2x3 affine matrix, laid out like SVG's `matrix(a,b,c,d,e,f)` :
+/// x' = a*x + c*y + tx
+/// y' = b*x + d*y + ty
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct bezrsAffine {
+    pub a : f64,
+    pub b : f64,
+    pub c : f64,
+    pub d : f64,
+    pub tx : f64,
+    pub ty : f64,
+}
+
 impl bezrsBezierHandle {
 
 	pub fn new(x: f64, y: f64, inx : f64, iny : f64, outx : f64, outy : f64) -> Self {
@@ -216,16 +420,20 @@ pub(crate) fn sub_path_to_vec(sub_path : &Subpath<EmptyId>) -> Vec<bezrsBezierHa
 	sub_path
 		.manipulator_groups()
 		.into_iter()
-		.map(|mg| bezrsBezierHandle {
-			pos: bezrsPos::from_dvec2(&mg.anchor),
-			//in_bez: bezrsPos::from_dvec2_opt(&mg.in_handle),
-			//out_bez: bezrsPos::from_dvec2_opt(&mg.out_handle),
-			in_bez: bezrsPos::from_dvec2(&mg.in_handle.unwrap_or(mg.anchor)),
-			out_bez: bezrsPos::from_dvec2(&mg.out_handle.unwrap_or(mg.anchor)),
-		})
+		.map(group_to_handle)
 		.collect()
 }
 
+pub(crate) fn group_to_handle(mg : &ManipulatorGroup<EmptyId>) -> bezrsBezierHandle {
+	bezrsBezierHandle {
+		pos: bezrsPos::from_dvec2(&mg.anchor),
+		//in_bez: bezrsPos::from_dvec2_opt(&mg.in_handle),
+		//out_bez: bezrsPos::from_dvec2_opt(&mg.out_handle),
+		in_bez: bezrsPos::from_dvec2(&mg.in_handle.unwrap_or(mg.anchor)),
+		out_bez: bezrsPos::from_dvec2(&mg.out_handle.unwrap_or(mg.anchor)),
+	}
+}
+
 /// Raw vector handle representing a bezier shape
 /// Used for sending owned data from Rust to C++ in both directions.
 #[repr(C)]
@@ -248,6 +456,114 @@ pub struct bezrsFloatsRaw {
     len: SizeTC,
 }
 
+/// Location of one shape within a packed multi-shape handle buffer
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct bezrsShapeSpan {
+    /// index of the first handle
+    pub offset: SizeTC,
+    /// count of handles
+    pub len: SizeTC,
+    /// if true, behave as shape, otherwise behave as path.
+    pub closed: bool,
+}
+
+/// Raw packed multi-shape : all handles in one buffer, plus one span per shape.
+/// When Rust owned, valid until the multi-shape (or compound shape) is modified or destroyed.
+/// Also used for sending packed subpaths from C++ in one copy (see `bezrs_compound_create()`).
+#[repr(C)]
+pub struct bezrsMultiShapeRaw {
+    /// All handles of all shapes, contiguous
+    handles: *const bezrsBezierHandle,
+    /// count of handles
+    handles_len: SizeTC,
+    /// One span per shape
+    shapes: *const bezrsShapeSpan,
+    /// count of shapes
+    shapes_len: SizeTC,
+}
+
+/// Strided stream of 2D points in caller memory : x then y (floats or doubles), one point every `stride` bytes.
+/// Any extra components (like z in `glm::vec3`, stride 12) are skipped. A stride of 0 means tightly packed x,y pairs.
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct bezrsPointStream {
+    /// First point (can be null for an absent stream)
+    pub data: *const c_void,
+    /// Bytes between 2 consecutive points
+    pub stride: SizeTC,
+    /// Type of x and y
+    pub scalar: bezrsScalarType,
+}
+
+/// Bezier handles as separate strided streams, read in place (see `bezrs_shape_create_strided()`).
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct bezrsStridedHandles {
+    /// Anchor positions
+    pub anchors: bezrsPointStream,
+    /// In handles (null data : collapsed onto the anchors)
+    pub in_handles: bezrsPointStream,
+    /// Out handles (null data : collapsed onto the anchors)
+    pub out_handles: bezrsPointStream,
+    /// count of handles in each stream
+    pub len: SizeTC,
+    /// if true, behave as shape, otherwise behave as path.
+    pub closed: bool,
+}
+
+/// Opaque packed multi-shape container, for operations that produce many shapes.
+/// Reuse it across calls : its buffers are recycled. (allocated on rust side, needs to be freed properly)
+#[derive(Debug, Default)]
+pub struct bezrsMultiShape {
+	pub(crate) data : multishape::MultiShapeData,
+}
+
+/// Opaque incremental curve fitter, turning a growing stroke into cubic segments (see `bezrs_stroke_fitter_create()`).
+/// (allocated on rust side, needs to be freed properly)
+#[derive(Debug)]
+pub struct bezrsStrokeFitter {
+	pub(crate) fitter : fit::StrokeFitter,
+	pub(crate) chain : Vec<segments::Cubic>, // Scratch buffer for writing results
+}
+
+/// Opaque incremental offset state : keeps per-segment offset results of a shape being edited (see `bezrs_incremental_offset_create()`).
+/// (allocated on rust side, needs to be freed properly)
+#[derive(Debug)]
+pub struct bezrsIncrementalOffset {
+	pub(crate) data : offset::IncrementalOffset,
+	pub(crate) chain : Vec<segments::Cubic>, // Scratch buffer for writing results
+}
+
+/// Opaque compound shape : several subpaths filled together with a fill rule (for shapes with holes).
+/// (allocated on rust side, needs to be freed properly)
+#[derive(Debug)]
+pub struct bezrsCompoundShape {
+	pub(crate) data : compound::CompoundData,
+}
+
+/// Opaque morph between keyframe shapes, keeping their handle correspondence across frames (see `bezrs_morph_create()`).
+/// (allocated on rust side, needs to be freed properly)
+#[derive(Debug)]
+pub struct bezrsMorph {
+	pub(crate) data : morph::Morph,
+}
+
+/// Opaque single precision shape : segments stored and evaluated in f32, using half the memory of a `bezrsShape`.
+/// For batch evaluation, hit testing and flattening where f32 accuracy is enough (see `bezrs_shapef_create()`).
+/// (allocated on rust side, needs to be freed properly)
+#[derive(Debug, Default)]
+pub struct bezrsShapeF {
+	pub(crate) data : single::ShapeF,
+}
+
+/// Opaque cancellation token, shared between the thread running an operation and the one cancelling it (see `bezrsBudget`).
+/// (allocated on rust side, needs to be freed properly)
+#[derive(Debug, Default)]
+pub struct bezrsCancelToken {
+	pub(crate) cancelled : std::sync::atomic::AtomicBool,
+}
+
 // C++ : Opaque pointer to internal data handle
 // Rust : Internal data object holding the subpath
 /// Opaque internal shape data handle
@@ -255,17 +571,92 @@ pub struct bezrsFloatsRaw {
 // Todo: rename this bezrsShapeInternal for c++ clarity ??
 #[derive(Debug)]
 pub struct bezrsShape {
-	pub(crate) sub_path : Subpath<EmptyId>, // Internal data object
+	pub(crate) sub_path : Arc<Subpath<EmptyId>>, // Internal data object, shared by clones until one of them mutates it
 	pub(crate) beziers : Vec<bezrsBezierHandle>, // Mirrored beziers for returning the data to c++
+	pub(crate) beziers_dirty : bool, // The mirror is outdated, rebuilt when the data is returned
+	pub(crate) prepared : Option<Arc<prepared::Prepared>>, // Query acceleration, see `bezrs_shape_prepare()`
+	pub(crate) lod : lod::LodCache, // Flattened levels of detail, see `bezrs_shape_lod_polyline()`
 }
 
 impl bezrsShape {
 
 	pub(crate) fn new(_sub_path : Subpath<EmptyId>) -> Self {
 		bezrsShape {
-			beziers : sub_path_to_vec(&_sub_path),
-			sub_path : _sub_path, // Check : need .clone() here ?
+			beziers : Vec::new(),
+			beziers_dirty : true,
+			sub_path : Arc::new(_sub_path),
+			prepared : None,
+			lod : lod::LodCache::default(),
+		}
+	}
+
+	// O(1) copy sharing the geometry and prepared data (the mirror is rebuilt when the clone returns its data).
+	pub(crate) fn share(&self) -> Self {
+		bezrsShape {
+			beziers : Vec::new(),
+			beziers_dirty : true,
+			sub_path : Arc::clone(&self.sub_path),
+			prepared : self.prepared.clone(),
+			lod : self.lod.empty_like(),
+		}
+	}
+
+	// Mutable access to the subpath : copies it first when it is shared with clones (copy on write).
+	pub(crate) fn sub_path_mut(&mut self) -> &mut Subpath<EmptyId> {
+		self.beziers_dirty = true;
+		Arc::make_mut(&mut self.sub_path)
+	}
+
+	// Replaces the subpath, reusing its allocation when it is not shared.
+	pub(crate) fn set_sub_path(&mut self, sub_path : Subpath<EmptyId>) {
+		self.beziers_dirty = true;
+		match Arc::get_mut(&mut self.sub_path) {
+			Some(own) => *own = sub_path,
+			None => self.sub_path = Arc::new(sub_path),
+		}
+	}
+
+	// Takes the manipulator groups for recycling their allocation (empty when the subpath is shared : nothing to copy).
+	pub(crate) fn take_manipulator_groups(&mut self) -> Vec<ManipulatorGroup<EmptyId>> {
+		match Arc::get_mut(&mut self.sub_path) {
+			Some(own) => std::mem::take(own.manipulator_groups_mut()),
+			None => Vec::new(),
+		}
+	}
+
+	// To call on any mutation of the subpath : drops the derived caches.
+	pub(crate) fn mark_changed(&mut self) {
+		self.prepared = None;
+		self.lod.clear();
+		self.beziers_dirty = true;
+	}
+
+	// Mirrored beziers, rebuilt only when outdated : repeated queries return the same buffer.
+	pub(crate) fn handle_data(&mut self) -> &mut Vec<bezrsBezierHandle> {
+		if self.beziers_dirty {
+			self.beziers.clear();
+			self.beziers.extend(self.sub_path.manipulator_groups().iter().map(group_to_handle));
+			self.beziers_dirty = false;
 		}
+		&mut self.beziers
+	}
+
+	// Replaces the subpath by a chain of connected cubic segments, recycling the previous allocations.
+	pub(crate) fn set_cubics(&mut self, chain : &[segments::Cubic], closed : bool) {
+		let mut handles = std::mem::take(&mut self.beziers);
+		handles.clear();
+		multishape::push_chain_handles(&mut handles, chain, closed);
+
+		let mut manipulator_groups = self.take_manipulator_groups();
+		manipulator_groups.clear();
+		manipulator_groups.extend(handles.iter().map(|bez_handle| bez_handle.to_internal()));
+
+		// Note : Bezier-rs panics when < 2 subpath items and closed = false
+		let safe_closed : bool = closed && (manipulator_groups.len() > 1);
+		self.set_sub_path(Subpath::<EmptyId>::new(manipulator_groups, safe_closed));
+		self.mark_changed();
+		self.beziers = handles;
+		self.beziers_dirty = false;
 	}
 }
 
@@ -302,8 +693,11 @@ pub extern "C" fn bezrs_shape_create(beziers_opt: Option<&bezrsShapeRaw>, closed
             // Note : Bezier-rs panics when < 2 subpath items and closed = false
             let safe_closed : bool = closed && (beziers_raw.len > 1);
 	        let shape = bezrsShape {
-	            sub_path: Subpath::<EmptyId>::new(manipulator_groups, safe_closed),
+	            sub_path: Arc::new(Subpath::<EmptyId>::new(manipulator_groups, safe_closed)),
 	            beziers: beziers_slice.to_vec(),
+	            beziers_dirty: false,
+	            prepared: None,
+	            lod: lod::LodCache::default(),
 	        };
 
 	        // Put instance on heap to get a stable memory address.
@@ -326,6 +720,22 @@ pub extern "C" fn bezrs_shape_create(beziers_opt: Option<&bezrsShapeRaw>, closed
     return Box::into_raw(boxed_shape)
 }
 
+#[no_mangle]
+/// Creates a shape like `bezrs_shape_create()`, reversing the handles if needed so that it winds in `_winding`
+/// (`bezrsWinding::Clockwise` is what offsets and outlines expect). A cheap signed area test, `bezrsWinding::None` keeps them as given.
+pub extern "C" fn bezrs_shape_create_oriented(beziers_opt: Option<&bezrsShapeRaw>, closed: bool, _winding: bezrsWinding) -> *mut bezrsShape {
+    let shape_ptr = bezrs_shape_create(beziers_opt, closed);
+    let shape = unsafe { &mut *shape_ptr };
+    if metrics::needs_reversal(&shape.sub_path, _winding) {
+        let closed = shape.sub_path.closed();
+        let mut manipulator_groups = shape.take_manipulator_groups();
+        metrics::reverse_groups(&mut manipulator_groups);
+        shape.set_sub_path(Subpath::<EmptyId>::new(manipulator_groups, closed));
+        shape.mark_changed();
+    }
+    return shape_ptr;
+}
+
 #[no_mangle]
 /// To destroy an internal shape handle when you don't need it anymore.
 pub extern "C" fn bezrs_shape_destroy(_bezier: *mut bezrsShape) {
@@ -337,6 +747,27 @@ pub extern "C" fn bezrs_shape_destroy(_bezier: *mut bezrsShape) {
     }
 }
 
+#[no_mangle]
+/// Creates a new shape sharing the geometry of `_shape` in O(1) : the geometry is only copied when one of them is mutated (copy on write).
+/// Cheap snapshots for undo history or non-destructive operations. Clones are independent shapes, to destroy separately.
+pub extern "C" fn bezrs_shape_clone(_shape: *mut bezrsShape) -> *mut bezrsShape {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &*_shape
+    };
+    return Box::into_raw(Box::new(shape.share()));
+}
+
+#[no_mangle]
+/// Returns true while the geometry of `_shape` is shared with clones (see `bezrs_shape_clone()`) : its next mutation will copy it.
+pub extern "C" fn bezrs_shape_is_shared(_shape: *mut bezrsShape) -> bool {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &*_shape
+    };
+    return Arc::strong_count(&shape.sub_path) > 1;
+}
+
 #[no_mangle]
 /// Inserts a bezier to the shape at a given position
 pub extern "C" fn bezrs_shape_insert_bezier(_shape: *mut bezrsShape, _bez : bezrsBezierHandle, _pos : SizeTC) {
@@ -344,7 +775,8 @@ pub extern "C" fn bezrs_shape_insert_bezier(_shape: *mut bezrsShape, _bez : bezr
         assert!(!_shape.is_null());
         &mut *_shape
     };
-    shape.sub_path.insert_manipulator_group(_pos as usize, _bez.to_internal());
+    shape.sub_path_mut().insert_manipulator_group(_pos as usize, _bez.to_internal());
+    shape.mark_changed();
 }
 
 #[no_mangle]
@@ -355,7 +787,8 @@ pub extern "C" fn bezrs_shape_append_bezier(_shape: *mut bezrsShape, _bez : bezr
         &mut *_shape
     };
     let pos = shape.sub_path.len();
-    shape.sub_path.insert_manipulator_group(pos, _bez.to_internal());
+    shape.sub_path_mut().insert_manipulator_group(pos, _bez.to_internal());
+    shape.mark_changed();
 }
 
 
@@ -386,171 +819,1483 @@ pub extern "C" fn bezrs_shape_reverse_winding(_shape: *mut bezrsShape) {
         assert!(!_shape.is_null());
         &mut *_shape
     };
-    shape.sub_path = shape.sub_path.reverse();
+    let reversed = shape.sub_path.reverse();
+    shape.set_sub_path(reversed);
+    shape.mark_changed();
 }
 
 // Retrieve shape data
 #[no_mangle]
 /// To retrieve the data of an internal shape handle.
+/// The data stays valid (and is returned again without conversion) until the shape is mutated or destroyed.
 pub extern "C" fn bezrs_shape_return_handle_data(_shape: *mut bezrsShape) -> bezrsShapeRaw {
     let shape = unsafe {
         assert!(!_shape.is_null());
         &mut *_shape
     };
 
-    // Todo: add a dirty flag to prevent recomputing for nothing ?
-    shape.beziers = sub_path_to_vec(&shape.sub_path);
+    // The mirror is only rebuilt after mutations, so the data stays valid until then
+    let closed = shape.sub_path.closed();
+    let beziers = shape.handle_data();
 
     return bezrsShapeRaw {
     	// data: shape.sub_path.manipulator_groups().as_mut_ptr(),
     	// len: shape.sub_path.manipulator_groups().len(),
-    	data: shape.beziers.as_mut_ptr(),
-    	len: shape.beziers.len() as SizeTC,
-    	closed: shape.sub_path.closed(),
+    	data: beziers.as_mut_ptr(),
+    	len: beziers.len() as SizeTC,
+    	closed: closed,
     };
 }
 
-
-
-// Returning a vec to c++ : https://www.reddit.com/r/rust/comments/aca3do/ffi_how_do_you_pass_a_vec_to_c/
 #[no_mangle]
-/// Offset a shape. When the shape is winded clockwise : positive offset goes inside, negative is outside.
-// Todo : Rename this to bezrs_shape_offset
-pub extern "C" fn bezrs_cubic_bezier_offset(_shape: *mut bezrsShape, offset : f64, join_type : bezrsJoinType, join_mitter : f64 ) {
-	let shape = unsafe {
+/// Returns whether the shape is closed (without returning its data).
+pub extern "C" fn bezrs_shape_is_closed(_shape: *mut bezrsShape) -> bool {
+    let shape = unsafe {
         assert!(!_shape.is_null());
-        &mut *_shape
+        &*_shape
     };
-
-	// Offset real object
-	shape.sub_path = shape.sub_path.offset(offset, parse_join(join_type, Some(join_mitter))); // Bevel, Round, Mitter(limit:f64)
+    return shape.sub_path.closed();
 }
 
+
+
 #[no_mangle]
-/// Rotates the whole shape
-pub extern "C" fn bezrs_shape_rotate(_shape: *mut bezrsShape, _angle: f64, _center_point : *mut bezrsPos ) {
+/// Replaces all bezier handles of an existing shape in one bulk copy.
+/// The internal storage is reused, so re-assigning similarly sized data doesn't allocate.
+pub extern "C" fn bezrs_shape_set_handle_data(_shape: *mut bezrsShape, beziers_opt: Option<&bezrsShapeRaw>, closed: bool) {
     let shape = unsafe {
         assert!(!_shape.is_null());
         &mut *_shape
     };
 
-    let center_point = if _center_point.is_null() { DVec2::new(0.0,0.0) } else { unsafe { _center_point.as_ref().unwrap().to_dvec2() } };
-    shape.sub_path = shape.sub_path.rotate_about_point(_angle, center_point);
+    let beziers_slice : &[bezrsBezierHandle] = match beziers_opt {
+        Some(beziers_raw) if !beziers_raw.data.is_null() => unsafe {
+            slice::from_raw_parts(beziers_raw.data, beziers_raw.len as usize)
+        },
+        _ => &[],
+    };
+
+    // Recycle the previous manipulator groups allocation
+    let mut manipulator_groups = shape.take_manipulator_groups();
+    manipulator_groups.clear();
+    manipulator_groups.extend(beziers_slice.iter().map(|bez_handle| bez_handle.to_internal()));
+
+    // Note : Bezier-rs panics when < 2 subpath items and closed = false
+    let safe_closed : bool = closed && (beziers_slice.len() > 1);
+    shape.set_sub_path(Subpath::<EmptyId>::new(manipulator_groups, safe_closed));
+    shape.mark_changed();
 }
 
 #[no_mangle]
-/// Outlines a shape or path.
-/// Important: Closed shapes will return a new shape instance, to be destroyed correctly.
-pub extern "C" fn bezrs_shape_outline(_shape: *mut bezrsShape, distance: f64, join: bezrsJoinType, cap: bezrsCapType, miter_limit: f64) -> *mut bezrsShape {
-	let shape = unsafe {
+/// Create a shape instance from strided streams, reading the caller's layout directly (no conversion to `bezrsBezierHandle` needed).
+/// The data is copied : it doesn't need to outlive the call. Needs to be freed afterwards.
+pub extern "C" fn bezrs_shape_create_strided(_handles: Option<&bezrsStridedHandles>) -> *mut bezrsShape {
+    let shape = bezrs_shape_create(None, false);
+    bezrs_shape_set_strided(shape, _handles);
+    return shape;
+}
+
+#[no_mangle]
+/// Replaces all bezier handles of an existing shape from strided streams, in one pass. The internal storage is reused.
+pub extern "C" fn bezrs_shape_set_strided(_shape: *mut bezrsShape, _handles: Option<&bezrsStridedHandles>) {
+    let shape = unsafe {
         assert!(!_shape.is_null());
         &mut *_shape
     };
 
-    // Convert arguments
-	let join = parse_join(join, Some(miter_limit));
-	let cap = parse_cap(cap);
-
-	// Note : A path outline returns 1 subpath. If it was a shape (closed), a 2nd one is received.
-	let (outline_piece1, outline_piece2) = shape.sub_path.outline(distance, join, cap);
-
-	// Update 1st result as usual
-	shape.sub_path = outline_piece1;
+    let mut manipulator_groups = shape.take_manipulator_groups();
+    let mut closed = false;
+    match _handles {
+        Some(handles) => {
+            strided::read_groups(handles, &mut manipulator_groups);
+            closed = handles.closed;
+        }
+        None => manipulator_groups.clear(),
+    }
 
-	// Return 2nd result as a shape
-	if shape.sub_path.closed() {
-		if let Some(outline) = outline_piece2 {
-			// Allocate return path/shape
-			let boxed_shape = Box::new(bezrsShape::new(outline));
+    // Note : Bezier-rs panics when < 2 subpath items and closed = false
+    let safe_closed : bool = closed && (manipulator_groups.len() > 1);
+    shape.set_sub_path(Subpath::<EmptyId>::new(manipulator_groups, safe_closed));
+    shape.mark_changed();
+}
 
-			// Return raw pointer to the allocated memory
-    		return Box::into_raw(boxed_shape);
-    	}
-	}
+#[no_mangle]
+/// Creates an empty multi-shape container : needs to be freed afterwards.
+pub extern "C" fn bezrs_multishape_create() -> *mut bezrsMultiShape {
+    Box::into_raw(Box::new(bezrsMultiShape::default()))
+}
 
-	return std::ptr::null_mut();
+#[no_mangle]
+/// To destroy a multi-shape container when you don't need it anymore.
+pub extern "C" fn bezrs_multishape_destroy(_multi_shape: *mut bezrsMultiShape) {
+    if _multi_shape.is_null() {
+        return;
+    }
+    unsafe {
+        let _ = Box::from_raw(_multi_shape);
+    }
 }
 
 #[no_mangle]
-/// Returns the bounding box of the shape
-pub extern "C" fn bezrs_shape_boundingbox(_shape: *mut bezrsShape) -> bezrsRect {
-	let shape = unsafe {
-        assert!(!_shape.is_null());
-        &mut *_shape
+/// To retrieve the packed data of a multi-shape container.
+pub extern "C" fn bezrs_multishape_return_data(_multi_shape: *mut bezrsMultiShape) -> bezrsMultiShapeRaw {
+    let multi_shape = unsafe {
+        assert!(!_multi_shape.is_null());
+        &mut *_multi_shape
     };
 
-    if let Some(bb) = shape.sub_path.bounding_box() {
-		let _size = bb[1]-bb[0];
-		let ret = bezrsRect { pos: bezrsPos::from_dvec2(&bb[0]), size: bezrsPos::from_dvec2(&_size)};
-		return ret; // Todo: is it memory-safe to return it like this ? (copied, but is the ownership transferred correctly ?)
-	}
-
-	return bezrsRect {pos:bezrsPos::new(0.,0.), size: bezrsPos::new(0.,0.)};
+    return bezrsMultiShapeRaw {
+        handles: multi_shape.data.handles.as_ptr(),
+        handles_len: multi_shape.data.handles.len() as SizeTC,
+        shapes: multi_shape.data.spans.as_ptr(),
+        shapes_len: multi_shape.data.spans.len() as SizeTC,
+    };
 }
 
 #[no_mangle]
-/// Returns the inflection points on a shape
-pub extern "C" fn bezrs_shape_inflections(_shape: *mut bezrsShape) -> bezrsFloatsRaw {
-	let shape = unsafe {
-        assert!(!_shape.is_null());
-        &mut *_shape
+/// Creates a shape instance from one shape of a multi-shape container (or an empty one if out of range) : needs to be freed afterwards.
+pub extern "C" fn bezrs_multishape_extract_shape(_multi_shape: *mut bezrsMultiShape, _index: SizeTC) -> *mut bezrsShape {
+    let multi_shape = unsafe {
+        assert!(!_multi_shape.is_null());
+        &mut *_multi_shape
     };
 
-	unsafe {
-		LAST_VEC_RAW = shape.sub_path.inflections().clone();
-		if LAST_VEC_RAW.len() > 0 {
-			let ret = bezrsFloatsRaw { data: LAST_VEC_RAW.as_mut_ptr(), len: LAST_VEC_RAW.len() as SizeTC };
-			return ret; // Todo: is it memory-safe to return it like this ? (copied, but is the ownership transferred correctly ?)
-		}
-	}
+    if let Some(span) = multi_shape.data.spans.get(_index as usize) {
+        let handles = &multi_shape.data.handles[span.offset as usize..(span.offset + span.len) as usize];
+        let raw = bezrsShapeRaw { data: handles.as_ptr(), len: span.len, closed: span.closed };
+        return bezrs_shape_create(Some(&raw), span.closed);
+    }
+    return bezrs_shape_create(None, false);
+}
 
-	return bezrsFloatsRaw {data: ptr::null_mut(), len: 0};
+#[no_mangle]
+/// Creates a compound shape from packed subpaths (copied, can be null for an empty one) : needs to be freed afterwards.
+/// The output of `bezrs_multishape_return_data()` or `bezrs_compound_return_data()` can be passed directly.
+pub extern "C" fn bezrs_compound_create(_subpaths: Option<&bezrsMultiShapeRaw>, _fill_rule: bezrsFillRule) -> *mut bezrsCompoundShape {
+    let mut compound = bezrsCompoundShape { data: compound::CompoundData::new(_fill_rule) };
+    if _subpaths.is_some() {
+        bezrs_compound_set_data(&mut compound, _subpaths);
+    }
+    return Box::into_raw(Box::new(compound));
 }
 
 #[no_mangle]
-/// Returns the local extrema points on a shape on multiple axis
-// Todo : wrap this in a static array to keep refs to correct axis
-pub extern "C" fn bezrs_shape_localextrema(_shape: *mut bezrsShape) -> bezrsFloatsRaw {
-	let shape = unsafe {
-        assert!(!_shape.is_null());
-        &mut *_shape
+/// To destroy a compound shape when you don't need it anymore.
+pub extern "C" fn bezrs_compound_destroy(_compound: *mut bezrsCompoundShape) {
+    if _compound.is_null() {
+        return;
+    }
+    unsafe {
+        let _ = Box::from_raw(_compound);
+    }
+}
+
+#[no_mangle]
+/// Replaces all subpaths of a compound shape from packed subpaths, in one bulk copy.
+pub extern "C" fn bezrs_compound_set_data(_compound: *mut bezrsCompoundShape, _subpaths: Option<&bezrsMultiShapeRaw>) {
+    let compound = unsafe {
+        assert!(!_compound.is_null());
+        &mut *_compound
     };
 
-    let extremas : [Vec<f64>; 2] = shape.sub_path.local_extrema();
+    let (handles, spans) : (&[bezrsBezierHandle], &[bezrsShapeSpan]) = match _subpaths {
+        Some(raw) if !raw.handles.is_null() && !raw.shapes.is_null() => unsafe {
+            (slice::from_raw_parts(raw.handles, raw.handles_len as usize), slice::from_raw_parts(raw.shapes, raw.shapes_len as usize))
+        },
+        _ => (&[], &[]),
+    };
+    compound.data.assign(handles, spans);
+}
 
-	if extremas.len() > 0 {
-		unsafe {
-			LAST_VEC_RAW = extremas.iter()
-				.zip([0, 1])
-				.flat_map(|(vec, _axis)| {
-					vec.iter().map(|&t_value|{
-						let f : f64 = t_value;
-						return f;
-					})
-				}).collect();
-				return bezrsFloatsRaw { data: LAST_VEC_RAW.as_mut_ptr(), len: LAST_VEC_RAW.len() as SizeTC };
-		}
-	}
+#[no_mangle]
+/// Appends a copy of a shape as a new subpath of the compound shape.
+pub extern "C" fn bezrs_compound_add_shape(_compound: *mut bezrsCompoundShape, _shape: *mut bezrsShape) {
+    let (compound, shape) = unsafe {
+        assert!(!_compound.is_null() && !_shape.is_null());
+        (&mut *_compound, &*_shape)
+    };
 
-	return bezrsFloatsRaw {data: ptr::null(), len: 0};
+    compound.data.sub_paths.push(Subpath::clone(&shape.sub_path));
+    compound.data.mark_changed();
 }
 
 #[no_mangle]
-/// Returns if a point is contained within a shape
-pub extern "C" fn bezrs_shape_containspoint(_shape: *mut bezrsShape, _pos : bezrsPos) -> bool {
-	let shape = unsafe {
-        assert!(!_shape.is_null());
-        &mut *_shape
+/// To retrieve the packed subpaths of a compound shape.
+pub extern "C" fn bezrs_compound_return_data(_compound: *mut bezrsCompoundShape) -> bezrsMultiShapeRaw {
+    let compound = unsafe {
+        assert!(!_compound.is_null());
+        &mut *_compound
     };
 
-    let contained = shape.sub_path.contains_point(_pos.to_dvec2());
-	return contained; // Todo: is it memory-safe to return it like this ? (copied, but is the ownership transferred correctly ?)
+    compound.data.update_mirror();
+    return bezrsMultiShapeRaw {
+        handles: compound.data.mirror.handles.as_ptr(),
+        handles_len: compound.data.mirror.handles.len() as SizeTC,
+        shapes: compound.data.mirror.spans.as_ptr(),
+        shapes_len: compound.data.mirror.spans.len() as SizeTC,
+    };
 }
 
-// Conversion utility for local to global tvalue transformation
-fn bezrs_local_to_global_tval(_shape: &Subpath<EmptyId>, seg : usize, t : f64) -> f64 {
-	let number_of_curves = _shape.len_segments() as f64;
-	return ((seg as f64) + t) / number_of_curves;
+#[no_mangle]
+/// Returns the amount of subpaths in the compound shape
+pub extern "C" fn bezrs_compound_info_size(_compound: *mut bezrsCompoundShape) -> SizeTC {
+    let compound = unsafe {
+        assert!(!_compound.is_null());
+        &mut *_compound
+    };
+    return compound.data.sub_paths.len() as SizeTC;
+}
+
+#[no_mangle]
+/// Returns the fill rule of the compound shape
+pub extern "C" fn bezrs_compound_get_fill_rule(_compound: *mut bezrsCompoundShape) -> bezrsFillRule {
+    let compound = unsafe {
+        assert!(!_compound.is_null());
+        &mut *_compound
+    };
+    return compound.data.fill_rule;
+}
+
+#[no_mangle]
+/// Sets the fill rule of the compound shape
+pub extern "C" fn bezrs_compound_set_fill_rule(_compound: *mut bezrsCompoundShape, _fill_rule: bezrsFillRule) {
+    let compound = unsafe {
+        assert!(!_compound.is_null());
+        &mut *_compound
+    };
+    compound.data.fill_rule = _fill_rule;
+}
+
+#[no_mangle]
+/// Returns if a point is within the filled area of the compound shape (holes excluded), in a single call.
+pub extern "C" fn bezrs_compound_containspoint(_compound: *mut bezrsCompoundShape, _pos : bezrsPos) -> bool {
+    let compound = unsafe {
+        assert!(!_compound.is_null());
+        &mut *_compound
+    };
+    return compound.data.contains_point(_pos.to_dvec2());
+}
+
+#[no_mangle]
+/// Returns the bounding box of all subpaths of the compound shape
+pub extern "C" fn bezrs_compound_boundingbox(_compound: *mut bezrsCompoundShape) -> bezrsRect {
+    let compound = unsafe {
+        assert!(!_compound.is_null());
+        &mut *_compound
+    };
+
+    if let Some(bb) = compound.data.bounding_box() {
+        return bezrsRect { pos: bezrsPos::from_dvec2(&bb[0]), size: bezrsPos::from_dvec2(&(bb[1] - bb[0])) };
+    }
+    return bezrsRect {pos:bezrsPos::new(0.,0.), size: bezrsPos::new(0.,0.)};
+}
+
+#[no_mangle]
+/// Applies an affine transformation to all subpaths of the compound shape, in place.
+pub extern "C" fn bezrs_compound_transform(_compound: *mut bezrsCompoundShape, _matrix : bezrsAffine) {
+    let compound = unsafe {
+        assert!(!_compound.is_null());
+        &mut *_compound
+    };
+
+    for sub_path in compound.data.sub_paths.iter_mut() {
+        affine::transform_subpath(sub_path, &_matrix);
+    }
+    compound.data.mark_changed();
+}
+
+#[no_mangle]
+/// Offsets the filled area of the compound shape : positive offsets shrink it (holes grow), negative offsets grow it.
+/// Subpaths are re-oriented according to their role : outer contours wind clockwise, holes counter-clockwise.
+pub extern "C" fn bezrs_compound_offset(_compound: *mut bezrsCompoundShape, offset : f64, join_type : bezrsJoinType, join_mitter : f64) {
+    let compound = unsafe {
+        assert!(!_compound.is_null());
+        &mut *_compound
+    };
+    compound.data.offset(offset, parse_join(join_type, Some(join_mitter)));
+}
+
+#[no_mangle]
+/// Replaces every subpath of the compound shape by its outline (closed subpaths give 2 rings), in place.
+/// The fill rule becomes non-zero, with rings oriented so that overlapping outlines merge.
+pub extern "C" fn bezrs_compound_outline(_compound: *mut bezrsCompoundShape, distance: f64, join: bezrsJoinType, cap: bezrsCapType, miter_limit: f64) {
+    let compound = unsafe {
+        assert!(!_compound.is_null());
+        &mut *_compound
+    };
+    compound.data.outline(distance, parse_join(join, Some(miter_limit)), parse_cap(cap));
+}
+
+#[no_mangle]
+/// Hatch fill of the compound shape, holes included, using its fill rule (see `bezrs_shape_hatch()`, including its cap on the amount of lines).
+/// Returns the amount of hatch segments.
+pub extern "C" fn bezrs_compound_hatch(_compound: *mut bezrsCompoundShape, _angle: f64, _spacing: f64, _phase: f64, _alternate: bool, _out: *mut bezrsMultiShape) -> SizeTC {
+    let (compound, out) = unsafe {
+        assert!(!_compound.is_null() && !_out.is_null());
+        (&mut *_compound, &mut *_out)
+    };
+
+    let sub_paths : Vec<&Subpath<EmptyId>> = compound.data.sub_paths.iter().collect();
+    return hatch::hatch(&sub_paths, _angle, _spacing, _phase, compound.data.fill_rule, _alternate, &mut out.data) as SizeTC;
+}
+
+#[no_mangle]
+/// Replaces the shape by the fewest cubic segments fitting a dense polyline (pen strokes, traced bitmaps) within `_tolerance` (distance).
+/// Points turning more than `_corner_angle` radians are kept as sharp corners (0 disables corner detection).
+/// When `_closed`, the polyline loops back to its first point.
+pub extern "C" fn bezrs_shape_fit_points(_shape: *mut bezrsShape, _points: *const bezrsPos, _len: SizeTC, _tolerance: f64, _corner_angle: f64, _closed: bool) {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+    let input = if _points.is_null() { &[][..] } else { unsafe { slice::from_raw_parts(_points, _len as usize) } };
+
+    let mut points : Vec<DVec2> = Vec::with_capacity(input.len());
+    fit::push_points(&mut points, input.iter().map(|p| p.to_dvec2()));
+    if _closed && points.len() > 2 && points[0].distance(points[points.len() - 1]) <= 1e-9 {
+        points.pop();
+    }
+
+    let mut fitted : Vec<fit::FittedCubic> = Vec::new();
+    let mut fitter = fit::Fitter::default();
+    if _closed {
+        fitter.fit_closed(&points, _tolerance, _corner_angle, &mut fitted);
+    } else {
+        fitter.fit_open(&points, 0, _tolerance, _corner_angle, None, &mut fitted);
+    }
+    let chain : Vec<segments::Cubic> = fitted.iter().map(|f| f.cubic).collect();
+    shape.set_cubics(&chain, _closed && points.len() > 2);
+}
+
+#[no_mangle]
+/// Merges runs of adjacent segments that a single cubic re-fits within `_tolerance` (distance), in place. Returns the new amount of segments.
+/// Use it after offsets and outlines, which split curves : repeated operations then keep a stable size.
+/// Joins turning more than `_corner_angle` radians are never merged (0 lets the tolerance alone decide).
+pub extern "C" fn bezrs_shape_simplify(_shape: *mut bezrsShape, _tolerance: f64, _corner_angle: f64) -> SizeTC {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+    let mut chain : Vec<segments::Cubic> = Vec::new();
+    simplify::simplify_subpath(&shape.sub_path, _tolerance, _corner_angle, &mut chain);
+    if chain.is_empty() {
+        return 0;
+    }
+    let closed = shape.sub_path.closed();
+    shape.set_cubics(&chain, closed);
+    return chain.len() as SizeTC;
+}
+
+#[no_mangle]
+/// Creates an incremental offset state, for offsetting a shape that is edited a few handles at a time.
+/// Each update only recomputes the segments whose handles changed, plus the joins around them, then splices the result.
+/// Segments are offset within `_tolerance` (distance), joins behave like `bezrs_cubic_bezier_offset()`. Needs to be freed afterwards.
+pub extern "C" fn bezrs_incremental_offset_create(_offset: f64, _join_type: bezrsJoinType, _join_mitter: f64, _tolerance: f64) -> *mut bezrsIncrementalOffset {
+    Box::into_raw(Box::new(bezrsIncrementalOffset { data: offset::IncrementalOffset::new(_offset, _join_type, _join_mitter, _tolerance), chain: Vec::new() }))
+}
+
+#[no_mangle]
+/// To destroy an incremental offset state when you don't need it anymore.
+pub extern "C" fn bezrs_incremental_offset_destroy(_incremental: *mut bezrsIncrementalOffset) {
+    if _incremental.is_null() {
+        return;
+    }
+    unsafe {
+        let _ = Box::from_raw(_incremental);
+    }
+}
+
+#[no_mangle]
+/// Changes the offset parameters. Any change discards the cached results : the next update recomputes everything.
+pub extern "C" fn bezrs_incremental_offset_set_params(_incremental: *mut bezrsIncrementalOffset, _offset: f64, _join_type: bezrsJoinType, _join_mitter: f64, _tolerance: f64) {
+    let incremental = unsafe {
+        assert!(!_incremental.is_null());
+        &mut *_incremental
+    };
+
+    let data = &mut incremental.data;
+    if data.distance != _offset || data.join != Some(_join_type) || data.miter_limit != _join_mitter || data.tolerance != _tolerance {
+        *data = offset::IncrementalOffset::new(_offset, _join_type, _join_mitter, _tolerance);
+    }
+}
+
+#[no_mangle]
+/// Offsets `_source` into `_out` (which is replaced), reusing the results of the previous update for unchanged segments.
+/// Returns the amount of segments that had to be recomputed.
+pub extern "C" fn bezrs_incremental_offset_update(_incremental: *mut bezrsIncrementalOffset, _source: *mut bezrsShape, _out: *mut bezrsShape) -> SizeTC {
+    let (incremental, source) = unsafe {
+        assert!(!_incremental.is_null() && !_source.is_null() && !_out.is_null());
+        (&mut *_incremental, &*_source)
+    };
+
+    let recomputed = incremental.data.update(&source.sub_path);
+    incremental.data.chain(&mut incremental.chain);
+    let closed = source.sub_path.closed();
+    let out = unsafe { &mut *_out };
+    out.set_cubics(&incremental.chain, closed);
+    return recomputed as SizeTC;
+}
+
+#[no_mangle]
+/// Creates an incremental curve fitter : feed it points as a stroke grows, only the tail of the stroke is refitted on each update.
+/// Same parameters as `bezrs_shape_fit_points()`. Needs to be freed afterwards.
+pub extern "C" fn bezrs_stroke_fitter_create(_tolerance: f64, _corner_angle: f64) -> *mut bezrsStrokeFitter {
+    Box::into_raw(Box::new(bezrsStrokeFitter { fitter: fit::StrokeFitter::new(_tolerance, _corner_angle), chain: Vec::new() }))
+}
+
+#[no_mangle]
+/// To destroy a stroke fitter when you don't need it anymore.
+pub extern "C" fn bezrs_stroke_fitter_destroy(_fitter: *mut bezrsStrokeFitter) {
+    if _fitter.is_null() {
+        return;
+    }
+    unsafe {
+        let _ = Box::from_raw(_fitter);
+    }
+}
+
+#[no_mangle]
+/// Forgets all points, to start a new stroke.
+pub extern "C" fn bezrs_stroke_fitter_clear(_fitter: *mut bezrsStrokeFitter) {
+    let fitter = unsafe {
+        assert!(!_fitter.is_null());
+        &mut *_fitter
+    };
+    fitter.fitter.clear();
+}
+
+#[no_mangle]
+/// Appends points to the stroke and refits its tail. Returns the total amount of points of the stroke.
+pub extern "C" fn bezrs_stroke_fitter_add_points(_fitter: *mut bezrsStrokeFitter, _points: *const bezrsPos, _len: SizeTC) -> SizeTC {
+    let fitter = unsafe {
+        assert!(!_fitter.is_null());
+        &mut *_fitter
+    };
+    if !_points.is_null() {
+        let input = unsafe { slice::from_raw_parts(_points, _len as usize) };
+        fitter.fitter.add_points(input.iter().map(|p| p.to_dvec2()));
+    }
+    return fitter.fitter.points_len() as SizeTC;
+}
+
+#[no_mangle]
+/// Writes the current fit of the stroke into a shape (as an open path). Returns the amount of segments.
+pub extern "C" fn bezrs_stroke_fitter_to_shape(_fitter: *mut bezrsStrokeFitter, _shape: *mut bezrsShape) -> SizeTC {
+    let (fitter, shape) = unsafe {
+        assert!(!_fitter.is_null() && !_shape.is_null());
+        (&mut *_fitter, &mut *_shape)
+    };
+
+    fitter.chain.clear();
+    fitter.chain.extend(fitter.fitter.segments());
+    shape.set_cubics(&fitter.chain, false);
+    return fitter.chain.len() as SizeTC;
+}
+
+#[no_mangle]
+/// Creates a morph, for interpolating shapes between keyframes (see `bezrs_morph_set_keyframes()`). Needs to be freed afterwards.
+pub extern "C" fn bezrs_morph_create() -> *mut bezrsMorph {
+    Box::into_raw(Box::new(bezrsMorph { data: morph::Morph::new() }))
+}
+
+#[no_mangle]
+/// To destroy a morph when you don't need it anymore.
+pub extern "C" fn bezrs_morph_destroy(_morph: *mut bezrsMorph) {
+    if _morph.is_null() {
+        return;
+    }
+    unsafe {
+        let _ = Box::from_raw(_morph);
+    }
+}
+
+#[no_mangle]
+/// Sets the keyframe shapes, evenly spread over the morph (t=0 : first keyframe, t=1 : last keyframe) and copied.
+/// Keyframes with the same amount of handles correspond handle by handle. Otherwise, they get resampled to the
+/// largest amount of segments and closed ones are aligned on each other (winding and start anchor).
+/// This correspondence is only computed here : call it again when the keyframes change, not every frame.
+/// Returns false and keeps the previous keyframes when a shape is null or degenerate (no segments), as dropping it would shift the timing of the next ones.
+/// Use `bezrs_morph_info_size()` for the amount of handles of the morphed shape.
+pub extern "C" fn bezrs_morph_set_keyframes(_morph: *mut bezrsMorph, _shapes: *const *const bezrsShape, _count: SizeTC) -> bool {
+    let morph = unsafe {
+        assert!(!_morph.is_null());
+        &mut *_morph
+    };
+    let shapes = if _shapes.is_null() || _count == 0 { &[] } else { unsafe { slice::from_raw_parts(_shapes, _count as usize) } };
+    if shapes.iter().any(|shape_ptr| shape_ptr.is_null()) {
+        return false;
+    }
+    let sub_paths : Vec<&Subpath<EmptyId>> = shapes.iter().map(|shape_ptr| unsafe { &*(**shape_ptr).sub_path }).collect();
+
+    return morph.data.set_keyframes(&sub_paths);
+}
+
+#[no_mangle]
+/// Eases the blend between two keyframes with a CSS-like timing curve from (0,0) to (1,1), `_c1` and `_c2` being its control points.
+/// Pass null control points for a linear blend (the default).
+pub extern "C" fn bezrs_morph_set_easing(_morph: *mut bezrsMorph, _c1: Option<&bezrsPos>, _c2: Option<&bezrsPos>) {
+    let morph = unsafe {
+        assert!(!_morph.is_null());
+        &mut *_morph
+    };
+    morph.data.easing = match (_c1, _c2) {
+        (Some(c1), Some(c2)) => Some(morph::Easing::new(c1.x, c1.y, c2.x, c2.y)),
+        _ => None,
+    };
+}
+
+#[no_mangle]
+/// Amount of handles of the morphed shape
+pub extern "C" fn bezrs_morph_info_size(_morph: *mut bezrsMorph) -> SizeTC {
+    let morph = unsafe {
+        assert!(!_morph.is_null());
+        &mut *_morph
+    };
+    return morph.data.len() as SizeTC;
+}
+
+#[no_mangle]
+/// Returns true when the keyframes needed resampling to correspond, so the morphed handles don't match the keyframe handles.
+pub extern "C" fn bezrs_morph_is_resampled(_morph: *mut bezrsMorph) -> bool {
+    let morph = unsafe {
+        assert!(!_morph.is_null());
+        &mut *_morph
+    };
+    return morph.data.resampled;
+}
+
+#[no_mangle]
+/// Writes the shape at `_t` (0 -> 1 over all keyframes) into `_target`, in place when it already has the right amount of handles.
+pub extern "C" fn bezrs_morph_apply(_morph: *mut bezrsMorph, _t: f64, _target: *mut bezrsShape) {
+    let (morph, target) = unsafe {
+        assert!(!_morph.is_null() && !_target.is_null());
+        (&*_morph, &mut *_target)
+    };
+    morph.data.blend_sub_path(_t, target.sub_path_mut());
+    target.mark_changed();
+}
+
+#[no_mangle]
+/// Writes the handles at `_t` straight into caller memory (for drawing them without a shape).
+/// Writes at most `_capacity` handles and returns the total amount of handles : call with a null `_out` to query the required size.
+pub extern "C" fn bezrs_morph_apply_handles(_morph: *mut bezrsMorph, _t: f64, _out: *mut bezrsBezierHandle, _capacity: SizeTC) -> SizeTC {
+    let morph = unsafe {
+        assert!(!_morph.is_null());
+        &*_morph
+    };
+    let len = morph.data.len();
+    if _out.is_null() || _capacity == 0 {
+        return len as SizeTC;
+    }
+    let out = unsafe { slice::from_raw_parts_mut(_out, (_capacity as usize).min(len)) };
+    morph.data.blend_handles(_t, out);
+    return len as SizeTC;
+}
+
+#[no_mangle]
+/// Applies many morphs at once, `_targets[i]` receiving `_morphs[i]` at `_ts[i]`.
+/// Large batches are spread over multiple threads : all target shapes must be distinct (morphs can be shared).
+pub extern "C" fn bezrs_morphs_apply(_morphs: *const *const bezrsMorph, _ts: *const f64, _targets: *const *mut bezrsShape, _count: SizeTC) {
+    if _count == 0 {
+        return;
+    }
+    assert!(!_morphs.is_null() && !_ts.is_null() && !_targets.is_null());
+    let morphs = unsafe { slice::from_raw_parts(_morphs, _count as usize) };
+    let ts = unsafe { slice::from_raw_parts(_ts, _count as usize) };
+    let targets = unsafe { slice::from_raw_parts(_targets, _count as usize) };
+    let morphs_ptr = parallel::SharedMutPtr(morphs.as_ptr() as *mut *const bezrsMorph);
+    let targets_ptr = parallel::SharedMutPtr(targets.as_ptr() as *mut *mut bezrsShape);
+
+    parallel::for_each_range(targets.len(), 64, |range| {
+        for i in range {
+            let (morph, target) = unsafe {
+                let (morph_ptr, target_ptr) = (*morphs_ptr.get().add(i), *targets_ptr.get().add(i));
+                assert!(!morph_ptr.is_null() && !target_ptr.is_null());
+                (&*morph_ptr, &mut *target_ptr)
+            };
+            morph.data.blend_sub_path(ts[i], target.sub_path_mut());
+            target.mark_changed();
+        }
+    });
+}
+
+#[no_mangle]
+/// Creates a single precision copy of a shape (or an empty one from a null shape). Needs to be freed afterwards.
+pub extern "C" fn bezrs_shapef_create(_shape: *mut bezrsShape) -> *mut bezrsShapeF {
+    let shapef = Box::into_raw(Box::new(bezrsShapeF::default()));
+    if !_shape.is_null() {
+        bezrs_shapef_set_shape(shapef, _shape);
+    }
+    return shapef;
+}
+
+#[no_mangle]
+/// Creates a single precision shape straight from float handles (no double precision copy involved). Needs to be freed afterwards.
+pub extern "C" fn bezrs_shapef_create_from_handles(_handles: *const bezrsBezierHandleF, _len: SizeTC, _closed: bool) -> *mut bezrsShapeF {
+    let shapef = Box::into_raw(Box::new(bezrsShapeF::default()));
+    bezrs_shapef_set_handles(shapef, _handles, _len, _closed);
+    return shapef;
+}
+
+#[no_mangle]
+/// To destroy a single precision shape when you don't need it anymore.
+pub extern "C" fn bezrs_shapef_destroy(_shapef: *mut bezrsShapeF) {
+    if _shapef.is_null() {
+        return;
+    }
+    unsafe {
+        let _ = Box::from_raw(_shapef);
+    }
+}
+
+#[no_mangle]
+/// Replaces the geometry by a single precision copy of `_shape`. The internal storage is reused.
+pub extern "C" fn bezrs_shapef_set_shape(_shapef: *mut bezrsShapeF, _shape: *mut bezrsShape) {
+    let (shapef, shape) = unsafe {
+        assert!(!_shapef.is_null() && !_shape.is_null());
+        (&mut *_shapef, &*_shape)
+    };
+    shapef.data.set_cubics(segments::iter_cubics(&shape.sub_path), shape.sub_path.closed());
+}
+
+#[no_mangle]
+/// Replaces the geometry from float handles. The internal storage is reused.
+pub extern "C" fn bezrs_shapef_set_handles(_shapef: *mut bezrsShapeF, _handles: *const bezrsBezierHandleF, _len: SizeTC, _closed: bool) {
+    let shapef = unsafe {
+        assert!(!_shapef.is_null());
+        &mut *_shapef
+    };
+    let handles : &[bezrsBezierHandleF] = if _handles.is_null() { &[] } else { unsafe { slice::from_raw_parts(_handles, _len as usize) } };
+    shapef.data.set_handles(handles, _closed);
+}
+
+#[no_mangle]
+/// Amount of segments of the single precision shape
+pub extern "C" fn bezrs_shapef_info_segments(_shapef: *mut bezrsShapeF) -> SizeTC {
+    let shapef = unsafe {
+        assert!(!_shapef.is_null());
+        &*_shapef
+    };
+    return shapef.data.segment_count() as SizeTC;
+}
+
+#[no_mangle]
+/// Bytes used by the geometry of the single precision shape (including the containment data, once built)
+pub extern "C" fn bezrs_shapef_memory_size(_shapef: *mut bezrsShapeF) -> SizeTC {
+    let shapef = unsafe {
+        assert!(!_shapef.is_null());
+        &*_shapef
+    };
+    return shapef.data.memory_size() as SizeTC;
+}
+
+#[no_mangle]
+/// Evaluates positions at many global t-values (0->1 over the whole shape) into `_out` (`_count` positions). Multithreaded for large batches.
+pub extern "C" fn bezrs_shapef_evaluate(_shapef: *mut bezrsShapeF, _ts: *const f32, _count: SizeTC, _out: *mut bezrsPosF) {
+    let shapef = unsafe {
+        assert!(!_shapef.is_null());
+        &*_shapef
+    };
+    if _count == 0 || _ts.is_null() || _out.is_null() {
+        return;
+    }
+    let ts = unsafe { slice::from_raw_parts(_ts, _count as usize) };
+    let out = unsafe { slice::from_raw_parts_mut(_out, _count as usize) };
+    shapef.data.evaluate(ts, out);
+}
+
+#[no_mangle]
+/// Hit tests many points at once, writing 1 (inside) or 0 (outside) per point into `_out`. Paths are implicitly closed.
+/// The containment data is built on the first call. Multithreaded for large batches.
+pub extern "C" fn bezrs_shapef_containspoints(_shapef: *mut bezrsShapeF, _points: *const bezrsPosF, _count: SizeTC, _fill_rule: bezrsFillRule, _out: *mut u8) {
+    let shapef = unsafe {
+        assert!(!_shapef.is_null());
+        &mut *_shapef
+    };
+    if _count == 0 || _points.is_null() || _out.is_null() {
+        return;
+    }
+    let points = unsafe { slice::from_raw_parts(_points, _count as usize) };
+    let out = unsafe { slice::from_raw_parts_mut(_out, _count as usize) };
+    shapef.data.contains_points(points, _fill_rule, out);
+}
+
+#[no_mangle]
+/// Flattens the shape into a polyline whose chords stay within `_tolerance` of the curve. Closed shapes don't repeat their start point.
+/// Writes at most `_capacity` points and returns the total amount of points : call with a null `_out` to query the required size.
+pub extern "C" fn bezrs_shapef_flatten(_shapef: *mut bezrsShapeF, _tolerance: f32, _out: *mut bezrsPosF, _capacity: SizeTC) -> SizeTC {
+    let shapef = unsafe {
+        assert!(!_shapef.is_null());
+        &*_shapef
+    };
+    let out : &mut [bezrsPosF] = if _out.is_null() { &mut [] } else { unsafe { slice::from_raw_parts_mut(_out, _capacity as usize) } };
+    return shapef.data.flatten(_tolerance, out) as SizeTC;
+}
+
+#[no_mangle]
+/// Creates a cancellation token, for stopping operations running within a `bezrsBudget` from another thread. Needs to be freed afterwards.
+pub extern "C" fn bezrs_cancel_token_create() -> *mut bezrsCancelToken {
+    Box::into_raw(Box::new(bezrsCancelToken::default()))
+}
+
+#[no_mangle]
+/// To destroy a cancellation token, once no operation uses it anymore.
+pub extern "C" fn bezrs_cancel_token_destroy(_token: *mut bezrsCancelToken) {
+    if _token.is_null() {
+        return;
+    }
+    unsafe {
+        let _ = Box::from_raw(_token);
+    }
+}
+
+#[no_mangle]
+/// Requests the operations using this token to stop (thread safe). They return `bezrsStatus::Cancelled` at their next check.
+pub extern "C" fn bezrs_cancel_token_cancel(_token: *const bezrsCancelToken) {
+    let token = unsafe {
+        assert!(!_token.is_null());
+        &*_token
+    };
+    token.cancelled.store(true, std::sync::atomic::Ordering::Relaxed);
+}
+
+#[no_mangle]
+/// Clears a cancellation, for reusing the token (thread safe).
+pub extern "C" fn bezrs_cancel_token_reset(_token: *const bezrsCancelToken) {
+    let token = unsafe {
+        assert!(!_token.is_null());
+        &*_token
+    };
+    token.cancelled.store(false, std::sync::atomic::Ordering::Relaxed);
+}
+
+#[no_mangle]
+/// Returns true once the token has been cancelled (thread safe).
+pub extern "C" fn bezrs_cancel_token_is_cancelled(_token: *const bezrsCancelToken) -> bool {
+    let token = unsafe {
+        assert!(!_token.is_null());
+        &*_token
+    };
+    return token.cancelled.load(std::sync::atomic::Ordering::Relaxed);
+}
+
+// Returning a vec to c++ : https://www.reddit.com/r/rust/comments/aca3do/ffi_how_do_you_pass_a_vec_to_c/
+#[no_mangle]
+/// Offset a shape. When the shape is winded clockwise : positive offset goes inside, negative is outside.
+// Todo : Rename this to bezrs_shape_offset
+pub extern "C" fn bezrs_cubic_bezier_offset(_shape: *mut bezrsShape, offset : f64, join_type : bezrsJoinType, join_mitter : f64 ) {
+	let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+	// Offset real object
+	let offset_sub_path = shape.sub_path.offset(offset, parse_join(join_type, Some(join_mitter))); // Bevel, Round, Mitter(limit:f64)
+	shape.set_sub_path(offset_sub_path);
+	shape.mark_changed();
+}
+
+#[no_mangle]
+/// Offsets a shape within a budget, using the curve fitting offset of `bezrs_incremental_offset_create()` rather than bezier-rs' offset
+/// (`bezrs_cubic_bezier_offset()`) : segments are offset one by one within `_tolerance`, and the budget is checked between them.
+/// `max_results` caps the amount of output segments : when `Truncated`, the shape becomes the (open) chain of the first `max_results` ones.
+/// When `TimedOut` or `Cancelled`, the shape is left untouched.
+pub extern "C" fn bezrs_shape_offset_budget(_shape: *mut bezrsShape, _offset: f64, _join_type: bezrsJoinType, _join_mitter: f64, _tolerance: f64, _budget: Option<&bezrsBudget>) -> bezrsStatus {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+    let budget = budget::Budget::from_raw(_budget);
+    let mut engine = offset::IncrementalOffset::new(_offset, _join_type, _join_mitter, _tolerance);
+    if let Err(status) = engine.update_within(&shape.sub_path, &budget) {
+        return status;
+    }
+    let mut chain : Vec<segments::Cubic> = Vec::new();
+    engine.chain(&mut chain);
+    if budget.max_results > 0 && chain.len() > budget.max_results {
+        // Partial result, which no longer loops back to its start
+        shape.set_cubics(&chain[..budget.max_results], false);
+        return bezrsStatus::Truncated;
+    }
+    let closed = shape.sub_path.closed();
+    shape.set_cubics(&chain, closed);
+    return bezrsStatus::Complete;
+}
+
+#[no_mangle]
+/// Rotates the whole shape
+pub extern "C" fn bezrs_shape_rotate(_shape: *mut bezrsShape, _angle: f64, _center_point : *mut bezrsPos ) {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+    let center_point = if _center_point.is_null() { DVec2::new(0.0,0.0) } else { unsafe { _center_point.as_ref().unwrap().to_dvec2() } };
+    // In place, rather than `rotate_about_point()` which allocates a new subpath
+    affine::transform_subpath(shape.sub_path_mut(), &bezrsAffine::from_rotation(_angle, center_point));
+    shape.mark_changed();
+}
+
+#[no_mangle]
+/// Applies an affine transformation to all anchors and handles of the shape, in place.
+/// Covers translation, scaling, rotation and skewing.
+pub extern "C" fn bezrs_shape_transform(_shape: *mut bezrsShape, _matrix : bezrsAffine) {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+    affine::transform_subpath(shape.sub_path_mut(), &_matrix);
+    shape.mark_changed();
+}
+
+#[no_mangle]
+/// Transforms many shapes at once, `_shapes[i]` being transformed by `_matrices[i]`.
+/// Large batches are spread over multiple threads : all shape handles must be distinct.
+pub extern "C" fn bezrs_shapes_transform(_shapes: *const *mut bezrsShape, _matrices: *const bezrsAffine, _count: SizeTC) {
+    if _count == 0 {
+        return;
+    }
+    assert!(!_shapes.is_null() && !_matrices.is_null());
+    let shapes = unsafe { slice::from_raw_parts(_shapes, _count as usize) };
+    let matrices = unsafe { slice::from_raw_parts(_matrices, _count as usize) };
+    let shapes_ptr = parallel::SharedMutPtr(shapes.as_ptr() as *mut *mut bezrsShape);
+
+    // Thread only when there's enough work to amortize spawning
+    parallel::for_each_range(shapes.len(), 256, |range| {
+        for i in range {
+            let shape = unsafe {
+                let shape_ptr = *shapes_ptr.get().add(i);
+                assert!(!shape_ptr.is_null());
+                &mut *shape_ptr
+            };
+            affine::transform_subpath(shape.sub_path_mut(), &matrices[i]);
+            shape.mark_changed();
+        }
+    });
+}
+
+#[no_mangle]
+/// Exports the shape as compiled segments into caller memory (see `bezrsCompiledSegment`), for evaluating it locally.
+/// Writes at most `_capacity` segments and returns the total amount of segments : call with a null `_out` to query the required size.
+/// `_length_tolerance` is the absolute arc length error allowed per segment.
+pub extern "C" fn bezrs_shape_compile(_shape: *mut bezrsShape, _out: *mut bezrsCompiledSegment, _capacity: SizeTC, _length_tolerance: f64) -> SizeTC {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+    let count = segments::segment_count(&shape.sub_path);
+    if _out.is_null() || _capacity == 0 {
+        return count as SizeTC;
+    }
+    let out = unsafe { slice::from_raw_parts_mut(_out, (_capacity as usize).min(count)) };
+
+    let mut length_start = 0.0;
+    for (compiled, cubic) in out.iter_mut().zip(segments::iter_cubics(&shape.sub_path)) {
+        let c = cubic.power_coefficients();
+        let length = cubic.length(_length_tolerance);
+        *compiled = bezrsCompiledSegment {
+            x: [c[0].x, c[1].x, c[2].x, c[3].x],
+            y: [c[0].y, c[1].y, c[2].y, c[3].y],
+            length_start,
+            length,
+        };
+        length_start += length;
+    }
+
+    return count as SizeTC;
+}
+
+#[no_mangle]
+/// Resamples the shape at equal arc length intervals, writing positions, unit tangents and global t-values to caller buffers (each one can be null).
+/// - `_count` > 0 : places `_count` samples evenly (closed shapes don't repeat the start point, paths include both ends).
+/// - otherwise, `_spacing` is the distance between samples.
+/// `_start_offset` shifts all samples along the shape, for scrolling. Closed shapes wrap around, paths drop samples that fall off the ends.
+/// Writes at most `_capacity` samples and returns the total amount of samples : call with null buffers to query the required size.
+pub extern "C" fn bezrs_shape_resample(_shape: *mut bezrsShape, _count: SizeTC, _spacing: f64, _start_offset: f64, _out_positions: *mut bezrsPos, _out_tangents: *mut bezrsPos, _out_tvalues: *mut f64, _capacity: SizeTC) -> SizeTC {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+    let tables = arclength::build_tables(&shape.sub_path);
+    let total : f64 = tables.iter().map(|table| table.length()).sum();
+    if total <= 0.0 || !total.is_finite() {
+        return 0;
+    }
+    let closed = shape.sub_path.closed();
+
+    // Sample distances are `first + i * spacing`, for i in `skipped..skipped+count`
+    let (spacing, first, skipped, count) : (f64, f64, usize, usize) = if _count > 0 {
+        let count = _count as usize;
+        let spacing = if closed || count == 1 { total / count as f64 } else { total / (count - 1) as f64 };
+        if closed {
+            (spacing, _start_offset.rem_euclid(spacing), 0, count)
+        } else {
+            // Keep samples within [0, total]
+            let eps = total * 1e-12;
+            let skipped = if _start_offset < 0.0 { ((-_start_offset - eps) / spacing).ceil().max(0.0) as usize } else { 0 };
+            let last = ((total + eps - _start_offset) / spacing).floor();
+            let last = if last < 0.0 { 0 } else { (last as usize).min(count - 1) + 1 };
+            (spacing, _start_offset, skipped, last.saturating_sub(skipped))
+        }
+    } else if _spacing > 0.0 {
+        if closed {
+            let first = _start_offset.rem_euclid(_spacing);
+            (_spacing, first, 0, ((total - first) / _spacing).ceil() as usize)
+        } else {
+            // Keep samples within [0, total], none when the offset is past the end
+            let eps = total * 1e-12;
+            if !(_start_offset <= total + eps) {
+                return 0;
+            }
+            let skipped = if _start_offset < 0.0 { ((-_start_offset - eps) / _spacing).ceil().max(0.0) as usize } else { 0 };
+            let last = ((total + eps - _start_offset) / _spacing).floor() as usize + 1;
+            (_spacing, _start_offset, skipped, last.saturating_sub(skipped))
+        }
+    } else {
+        return 0;
+    };
+
+    let written = count.min(_capacity as usize);
+    if written == 0 || (_out_positions.is_null() && _out_tangents.is_null() && _out_tvalues.is_null()) {
+        return count as SizeTC;
+    }
+
+    let segment_count = tables.len() as f64;
+    let mut walker = arclength::PathWalker::new(&tables);
+    for i in 0..written {
+        let distance = first + (skipped + i) as f64 * spacing;
+        if let Some(at) = walker.locate(distance) {
+            let cubic = &tables[at.segment].cubic;
+            unsafe {
+                if !_out_positions.is_null() {
+                    *_out_positions.add(i) = bezrsPos::from_dvec2(&cubic.evaluate(at.t));
+                }
+                if !_out_tangents.is_null() {
+                    *_out_tangents.add(i) = bezrsPos::from_dvec2(&cubic.tangent(at.t));
+                }
+                if !_out_tvalues.is_null() {
+                    *_out_tvalues.add(i) = (at.segment as f64 + at.t) / segment_count;
+                }
+            }
+        }
+    }
+
+    return count as SizeTC;
+}
+
+#[no_mangle]
+/// Dashes the shape into trimmed cubic pieces, written as open paths into `_out` (its previous content is replaced).
+/// `_pattern` alternates "on" and "off" lengths (odd-sized patterns are repeated twice, like SVG), `_phase` is the distance into the pattern at which the shape starts.
+/// On closed shapes, a dash running over the start point is joined with the first one. Zero-length dashes are skipped.
+/// Returns the amount of dashes, 0 (with `_out` emptied) when the pattern is so short that it would take more than 1048576 (2^20)
+/// dashes and gaps to cover the shape.
+pub extern "C" fn bezrs_shape_dash(_shape: *mut bezrsShape, _pattern: *const f64, _pattern_len: SizeTC, _phase: f64, _out: *mut bezrsMultiShape) -> SizeTC {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+    let out = unsafe {
+        assert!(!_out.is_null());
+        &mut *_out
+    };
+    let pattern : &[f64] = if _pattern.is_null() { &[] } else { unsafe { slice::from_raw_parts(_pattern, _pattern_len as usize) } };
+
+    return dash::dash_subpath(&shape.sub_path, pattern, _phase, &mut out.data) as SizeTC;
+}
+
+#[no_mangle]
+/// Cuts the shape at many global t-values (0->1, like the output of `bezrs_shape_selfintersections()`) into `_out`, in one pass.
+/// Unsorted t-values are sorted, duplicates are ignored. An open path cut n times gives n+1 pieces, a closed shape cut n times
+/// gives n pieces (the last one running over the start point). Returns the amount of pieces.
+pub extern "C" fn bezrs_shape_split(_shape: *mut bezrsShape, _ts: *const f64, _len: SizeTC, _out: *mut bezrsMultiShape) -> SizeTC {
+    let (shape, out) = unsafe {
+        assert!(!_shape.is_null() && !_out.is_null());
+        (&mut *_shape, &mut *_out)
+    };
+    let ts : &[f64] = if _ts.is_null() { &[] } else { unsafe { slice::from_raw_parts(_ts, _len as usize) } };
+
+    return split::split_subpath(&shape.sub_path, ts, &mut out.data) as SizeTC;
+}
+
+#[no_mangle]
+/// Extracts many pieces of the shape into `_out`, in one pass. `_ranges` holds `_count` pairs of global t-values (t0, t1).
+/// On closed shapes, t0 > t1 runs over the start point. Degenerate ranges are skipped. Returns the amount of pieces.
+pub extern "C" fn bezrs_shape_extract_ranges(_shape: *mut bezrsShape, _ranges: *const f64, _count: SizeTC, _out: *mut bezrsMultiShape) -> SizeTC {
+    let (shape, out) = unsafe {
+        assert!(!_shape.is_null() && !_out.is_null());
+        (&mut *_shape, &mut *_out)
+    };
+    let ranges : &[[f64; 2]] = if _ranges.is_null() { &[] } else { unsafe { slice::from_raw_parts(_ranges as *const [f64; 2], _count as usize) } };
+
+    return split::extract_ranges(&shape.sub_path, ranges, &mut out.data) as SizeTC;
+}
+
+#[no_mangle]
+/// Trims the shape to the piece between global t-values `_t0` and `_t1`, in place. The result is an open path.
+/// On closed shapes, `_t0` > `_t1` runs over the start point. Returns false (leaving the shape untouched) when the piece is degenerate.
+pub extern "C" fn bezrs_shape_trim(_shape: *mut bezrsShape, _t0: f64, _t1: f64) -> bool {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+    let mut chain : Vec<segments::Cubic> = Vec::new();
+    if !split::trim_subpath(&shape.sub_path, _t0, _t1, &mut chain) {
+        return false;
+    }
+    shape.set_cubics(&chain, false);
+    return true;
+}
+
+#[no_mangle]
+/// Rasterizes a signed distance field of the shape into a caller-provided float grid (row-major, `_width` x `_height`).
+/// `_grid_to_shape` maps pixel coordinates to shape coordinates (pixel centers are at +0.5), distances are in shape units.
+/// Inside is negative (non-zero winding rule, paths are implicitly closed), outside is positive.
+/// Distances are clamped to `_max_distance` when positive, which also speeds up the computation.
+/// Multithreaded. Returns false if the grid is empty, its size overflows or the transform can't be inverted.
+pub extern "C" fn bezrs_shape_sdf(_shape: *mut bezrsShape, _out: *mut f32, _width: SizeTC, _height: SizeTC, _grid_to_shape: bezrsAffine, _max_distance: f64) -> bool {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+    if _out.is_null() {
+        return false;
+    }
+    let (width, height) = (_width as usize, _height as usize);
+    let len = match width.checked_mul(height) {
+        Some(len) => len,
+        None => return false,
+    };
+    let out = unsafe { slice::from_raw_parts_mut(_out, len) };
+
+    return sdf::rasterize(&shape.sub_path, out, width, height, &_grid_to_shape, _max_distance);
+}
+
+#[no_mangle]
+/// Rasterizes an anti-aliased 8-bit coverage mask of the shape into caller memory (`_height` rows of `_stride` bytes).
+/// `_grid_to_shape` maps pixel coordinates to shape coordinates. Paths are implicitly closed.
+/// Rendered on the CPU in horizontal bands, multithreaded. Returns false if the mask is empty, its size overflows or the transform can't be inverted.
+pub extern "C" fn bezrs_shape_rasterize(_shape: *mut bezrsShape, _out: *mut u8, _width: SizeTC, _height: SizeTC, _stride: SizeTC, _grid_to_shape: bezrsAffine, _fill_rule: bezrsFillRule) -> bool {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+    if _out.is_null() || _height == 0 {
+        return false;
+    }
+    let (width, height, stride) = (_width as usize, _height as usize, _stride as usize);
+    let len = match stride.checked_mul(height - 1).and_then(|rows| rows.checked_add(width)) {
+        Some(len) => len,
+        None => return false,
+    };
+    let out = unsafe { slice::from_raw_parts_mut(_out, len) };
+
+    return raster::rasterize(&shape.sub_path, out, width, height, stride, &_grid_to_shape, _fill_rule);
+}
+
+#[no_mangle]
+/// Intersects many lines with the shape in one sweep (parallel lines share it, each line only testing the segments spanning it).
+/// The crossings of line i are `_out_params[_out_offsets[i] .. _out_offsets[i+1]]`, sorted parameters along the line
+/// (keep t >= 0 for rays, 0 <= t <= 1 for line segments). `_out_offsets` needs `_count + 1` entries and is always filled.
+/// Writes at most `_capacity` parameters and returns the total amount of crossings : call with a null `_out_params` to query the required size.
+pub extern "C" fn bezrs_shape_intersect_lines(_shape: *mut bezrsShape, _lines: *const bezrsLine, _count: SizeTC, _out_offsets: *mut SizeTC, _out_params: *mut f64, _capacity: SizeTC) -> SizeTC {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+    let lines : &[bezrsLine] = if _lines.is_null() { &[] } else { unsafe { slice::from_raw_parts(_lines, _count as usize) } };
+
+    let mut crossings : Vec<(usize, f64)> = Vec::new();
+    hatch::intersect_lines(&[&shape.sub_path], lines, &mut crossings);
+
+    if !_out_offsets.is_null() {
+        let offsets = unsafe { slice::from_raw_parts_mut(_out_offsets, lines.len() + 1) };
+        let mut next = 0;
+        for (i, offset) in offsets.iter_mut().enumerate() {
+            *offset = next as SizeTC;
+            while next < crossings.len() && crossings[next].0 == i {
+                next += 1;
+            }
+        }
+    }
+    if !_out_params.is_null() && _capacity > 0 {
+        let out = unsafe { slice::from_raw_parts_mut(_out_params, (_capacity as usize).min(crossings.len())) };
+        for (param, crossing) in out.iter_mut().zip(crossings.iter()) {
+            *param = crossing.1;
+        }
+    }
+    return crossings.len() as SizeTC;
+}
+
+#[no_mangle]
+/// Fills the shape with parallel hatch lines (pen plotters, lasers) : lines at `_angle` radians, `_spacing` apart, shifted by `_phase`
+/// across their direction. Paths are implicitly closed. `_alternate` reverses every other line (serpentine order, less pen travel).
+/// Writes one straight 2-handle path per hatch segment into `_out` and returns their amount.
+/// Returns 0 (with `_out` emptied) when `_spacing` would need more than 1048576 (2^20) lines across the shape, against degenerate spacings.
+pub extern "C" fn bezrs_shape_hatch(_shape: *mut bezrsShape, _angle: f64, _spacing: f64, _phase: f64, _fill_rule: bezrsFillRule, _alternate: bool, _out: *mut bezrsMultiShape) -> SizeTC {
+    let (shape, out) = unsafe {
+        assert!(!_shape.is_null() && !_out.is_null());
+        (&mut *_shape, &mut *_out)
+    };
+
+    return hatch::hatch(&[&shape.sub_path], _angle, _spacing, _phase, _fill_rule, _alternate, &mut out.data) as SizeTC;
+}
+
+#[no_mangle]
+/// Clips the shape to a rectangle grown by `_margin` (stroke widths, offsets), for culling zoomed views before drawing,
+/// flattening or offsetting. Writes one open path per visible run of the shape into `_out` (a closed shape entirely within the
+/// rectangle stays closed) and returns their amount. Segments are accepted or rejected by their bounds before any splitting,
+/// and prepared shapes (see `bezrs_shape_prepare()`) only visit the segments near the rectangle.
+pub extern "C" fn bezrs_shape_clip_rect(_shape: *mut bezrsShape, _rect: bezrsRect, _margin: f64, _out: *mut bezrsMultiShape) -> SizeTC {
+    let (shape, out) = unsafe {
+        assert!(!_shape.is_null() && !_out.is_null());
+        (&mut *_shape, &mut *_out)
+    };
+    let rect = match clip::rect_bounds(&_rect, _margin) {
+        Some(rect) => rect,
+        None => { out.data.clear(); return 0; },
+    };
+
+    return clip::clip_to_rect(&shape.sub_path, shape.prepared.as_deref(), &rect, &mut out.data) as SizeTC;
+}
+
+#[no_mangle]
+/// Finds all segments of the shape crossing or within a rectangle grown by `_margin`, like `bezrs_shape_clip_rect()`.
+/// Writes at most `_capacity` segment indices (increasing) into `_out_indices` and returns the total amount :
+/// call with a null `_out_indices` to query the required size.
+pub extern "C" fn bezrs_shape_segments_in_rect(_shape: *mut bezrsShape, _rect: bezrsRect, _margin: f64, _out_indices: *mut SizeTC, _capacity: SizeTC) -> SizeTC {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+    let rect = match clip::rect_bounds(&_rect, _margin) {
+        Some(rect) => rect,
+        None => return 0,
+    };
+
+    let mut indices : Vec<usize> = Vec::new();
+    clip::segments_in_rect(&shape.sub_path, shape.prepared.as_deref(), &rect, &mut indices);
+    if !_out_indices.is_null() && _capacity > 0 {
+        let out = unsafe { slice::from_raw_parts_mut(_out_indices, (_capacity as usize).min(indices.len())) };
+        for (slot, index) in out.iter_mut().zip(indices.iter()) {
+            *slot = *index as SizeTC;
+        }
+    }
+    return indices.len() as SizeTC;
+}
+
+#[no_mangle]
+/// Approximates the shape by lines and circular arcs within `_tolerance`, for machine toolpaths (G-code G1 / G2 / G3) :
+/// controllers run arcs natively instead of thousands of tiny lines. Collinear lines and arcs of the same circle are merged.
+/// Writes at most `_capacity` moves into `_out` and returns the total amount : call with a null `_out` to query the required size.
+pub extern "C" fn bezrs_shape_biarcs(_shape: *mut bezrsShape, _tolerance: f64, _out: *mut bezrsToolpathMove, _capacity: SizeTC) -> SizeTC {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+    let out : &mut [bezrsToolpathMove] = if _out.is_null() { &mut [] } else { unsafe { slice::from_raw_parts_mut(_out, _capacity as usize) } };
+
+    let mut written = 0;
+    let mut emitter = biarc::Emitter::new(_tolerance.max(1e-9), |moves : &[bezrsToolpathMove]| {
+        let count = moves.len().min(out.len() - written);
+        out[written..written + count].copy_from_slice(&moves[..count]);
+        written += count;
+        true
+    });
+    emitter.push_subpath(&shape.sub_path);
+    emitter.finish();
+    return emitter.count as SizeTC;
+}
+
+#[no_mangle]
+/// Streams the approximation of `bezrs_shape_biarcs()` through `_callback`, by chunks of a few hundred moves, so that long
+/// toolpaths never need to be held in memory. `_user_data` is passed back to the callback, which can return false to stop.
+/// Returns the amount of moves delivered.
+pub extern "C" fn bezrs_shape_biarcs_stream(_shape: *mut bezrsShape, _tolerance: f64, _callback: bezrsToolpathCallback, _user_data: *mut c_void) -> SizeTC {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+    let callback = match _callback {
+        Some(callback) => callback,
+        None => return 0,
+    };
+
+    let mut emitter = biarc::Emitter::new(_tolerance.max(1e-9), |moves : &[bezrsToolpathMove]| callback(moves.as_ptr(), moves.len() as SizeTC, _user_data));
+    emitter.push_subpath(&shape.sub_path);
+    emitter.finish();
+    return emitter.count as SizeTC;
+}
+
+#[no_mangle]
+/// Precomputes acceleration data (monotonic pieces in a bounding volume tree, cached bounds, extrema and inflections)
+/// for shapes that are queried many times between edits : containment, projection, bounding box, extrema and inflections become cheaper.
+/// Any mutation of the shape drops it : call this again after editing.
+pub extern "C" fn bezrs_shape_prepare(_shape: *mut bezrsShape) {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+    shape.prepared = Some(Arc::new(prepared::Prepared::new(&shape.sub_path)));
+}
+
+#[no_mangle]
+/// Returns true if the shape has valid prepared data (see `bezrs_shape_prepare()`).
+pub extern "C" fn bezrs_shape_is_prepared(_shape: *mut bezrsShape) -> bool {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+    return shape.prepared.is_some();
+}
+
+#[no_mangle]
+/// Outlines a shape or path.
+/// Important: Closed shapes will return a new shape instance, to be destroyed correctly.
+pub extern "C" fn bezrs_shape_outline(_shape: *mut bezrsShape, distance: f64, join: bezrsJoinType, cap: bezrsCapType, miter_limit: f64) -> *mut bezrsShape {
+	let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+    // Convert arguments
+	let join = parse_join(join, Some(miter_limit));
+	let cap = parse_cap(cap);
+
+	// Note : A path outline returns 1 subpath. If it was a shape (closed), a 2nd one is received.
+	let (outline_piece1, outline_piece2) = shape.sub_path.outline(distance, join, cap);
+
+	// Update 1st result as usual
+	shape.set_sub_path(outline_piece1);
+	shape.mark_changed();
+
+	// Return 2nd result as a shape
+	if shape.sub_path.closed() {
+		if let Some(outline) = outline_piece2 {
+			// Allocate return path/shape
+			let boxed_shape = Box::new(bezrsShape::new(outline));
+
+			// Return raw pointer to the allocated memory
+    		return Box::into_raw(boxed_shape);
+    	}
+	}
+
+	return std::ptr::null_mut();
+}
+
+#[no_mangle]
+/// Outlines the shape with a variable width into `_out` (replacing its content), for calligraphic and pressure sensitive strokes.
+/// The width varies linearly between the `_count` samples of `_profile`, placed by `_mode`, and stays constant beyond the first
+/// and last ones. Both sides are fitted within `_tolerance`, then joined and capped like `bezrs_shape_outline()` : inner joins go
+/// through the anchor, so fill the result with the non-zero rule. The shape is left untouched.
+/// Paths give 1 closed outline, closed shapes 2 rings of opposite directions. Returns the amount of paths.
+pub extern "C" fn bezrs_shape_outline_variable(_shape: *mut bezrsShape, _profile: *const bezrsWidthSample, _count: SizeTC, _mode: bezrsWidthMode, join: bezrsJoinType, cap: bezrsCapType, miter_limit: f64, _tolerance: f64, _out: *mut bezrsMultiShape) -> SizeTC {
+    let (shape, out) = unsafe {
+        assert!(!_shape.is_null() && !_out.is_null());
+        (&mut *_shape, &mut *_out)
+    };
+    let samples : &[bezrsWidthSample] = if _profile.is_null() || _count == 0 { &[] } else { unsafe { slice::from_raw_parts(_profile, _count as usize) } };
+
+    return match outline::WidthProfile::new(&shape.sub_path, _mode, samples) {
+        Some(profile) => outline::outline(&shape.sub_path, &profile, join, miter_limit, cap, _tolerance, &mut out.data) as SizeTC,
+        None => { out.data.clear(); 0 },
+    };
+}
+
+#[no_mangle]
+/// Returns the shape flattened within `_screen_tolerance` once drawn at `_scale` (screen units per shape unit), from a per-shape
+/// level of detail cache : polylines are cached at tolerances of powers of 2, the requested one mapping to its level in O(1)
+/// (the finer one, so the error stays within the request, as long as that takes at most 4096 lines per segment : flattening caps
+/// there). Missing levels are flattened when `_build` is set, otherwise the nearest cached level is returned (empty when there's
+/// none) : draw that while zooming and build in idle time. A null or non-finite `_scale` returns an empty polyline.
+/// The data stays valid until the shape is mutated, destroyed or queried again. Any mutation drops the cache.
+pub extern "C" fn bezrs_shape_lod_polyline(_shape: *mut bezrsShape, _screen_tolerance: f64, _scale: f64, _build: bool) -> bezrsPolylineRaw {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+    if _scale == 0.0 || !_scale.is_finite() {
+        return bezrsPolylineRaw { data: ptr::null(), len: 0, tolerance: 0.0 };
+    }
+    let tolerance = _screen_tolerance / _scale.abs();
+    return match shape.lod.polyline(&shape.sub_path, tolerance, _build) {
+        Some((points, tolerance)) => bezrsPolylineRaw { data: points.as_ptr(), len: points.len() as SizeTC, tolerance },
+        None => bezrsPolylineRaw { data: ptr::null(), len: 0, tolerance: 0.0 },
+    };
+}
+
+#[no_mangle]
+/// Caps the memory of the level of detail cache of the shape to `_max_points` points (16 bytes each, 262144 by default).
+/// The least recently used levels are evicted beyond it, except the one being requested.
+pub extern "C" fn bezrs_shape_lod_set_max_points(_shape: *mut bezrsShape, _max_points: SizeTC) {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+    shape.lod.set_max_points(_max_points as usize);
+}
+
+#[no_mangle]
+/// Returns the amount of points held by the level of detail cache of the shape.
+pub extern "C" fn bezrs_shape_lod_cached_points(_shape: *mut bezrsShape) -> SizeTC {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &*_shape
+    };
+    return shape.lod.cached_points() as SizeTC;
+}
+
+#[no_mangle]
+/// Returns the bounding box of the shape
+pub extern "C" fn bezrs_shape_boundingbox(_shape: *mut bezrsShape) -> bezrsRect {
+	let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+    let bounding_box = match &shape.prepared {
+        Some(prepared) => prepared.bounding_box(),
+        None => shape.sub_path.bounding_box(),
+    };
+    if let Some(bb) = bounding_box {
+		let _size = bb[1]-bb[0];
+		let ret = bezrsRect { pos: bezrsPos::from_dvec2(&bb[0]), size: bezrsPos::from_dvec2(&_size)};
+		return ret; // Todo: is it memory-safe to return it like this ? (copied, but is the ownership transferred correctly ?)
+	}
+
+	return bezrsRect {pos:bezrsPos::new(0.,0.), size: bezrsPos::new(0.,0.)};
+}
+
+#[no_mangle]
+/// Returns the signed area, winding direction, centroid, arc length and tight bounds of the shape, in a single pass over its segments.
+/// `_length_tolerance` is the absolute arc length error allowed per segment.
+pub extern "C" fn bezrs_shape_metrics(_shape: *mut bezrsShape, _length_tolerance: f64) -> bezrsShapeMetrics {
+    let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+    return metrics_to_raw(&metrics::measure(&shape.sub_path, shape.prepared.as_deref(), _length_tolerance));
+}
+
+#[no_mangle]
+/// Computes the metrics of many shapes at once (see `bezrs_shape_metrics()`), `_out[i]` receiving the ones of `_shapes[i]`.
+/// Large batches are spread over multiple threads.
+pub extern "C" fn bezrs_shapes_metrics(_shapes: *const *mut bezrsShape, _count: SizeTC, _length_tolerance: f64, _out: *mut bezrsShapeMetrics) {
+    if _count == 0 {
+        return;
+    }
+    assert!(!_shapes.is_null() && !_out.is_null());
+    let shapes_ptr = parallel::SharedMutPtr(_shapes as *mut *mut bezrsShape);
+    let out_ptr = parallel::SharedMutPtr(_out);
+
+    parallel::for_each_range(_count as usize, 64, |range| {
+        for i in range {
+            let shape = unsafe {
+                let shape_ptr = *shapes_ptr.get().add(i);
+                assert!(!shape_ptr.is_null());
+                &*shape_ptr
+            };
+            let metrics = metrics::measure(&shape.sub_path, shape.prepared.as_deref(), _length_tolerance);
+            unsafe { *out_ptr.get().add(i) = metrics_to_raw(&metrics); }
+        }
+    });
+}
+
+fn metrics_to_raw(metrics : &metrics::Metrics) -> bezrsShapeMetrics {
+    let bounds = match metrics.bounds {
+        Some(b) => bezrsRect { pos: bezrsPos::from_dvec2(&b.min), size: bezrsPos::from_dvec2(&(b.max - b.min)) },
+        None => bezrsRect { pos: bezrsPos::new(0., 0.), size: bezrsPos::new(0., 0.) },
+    };
+    bezrsShapeMetrics {
+        signed_area: metrics.signed_area,
+        winding: metrics.winding,
+        centroid: bezrsPos::from_dvec2(&metrics.centroid),
+        length: metrics.length,
+        bounds,
+    }
+}
+
+#[no_mangle]
+/// Returns the inflection points on a shape
+pub extern "C" fn bezrs_shape_inflections(_shape: *mut bezrsShape) -> bezrsFloatsRaw {
+	let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+	unsafe {
+		LAST_VEC_RAW = match &shape.prepared {
+			Some(prepared) => prepared.inflections.clone(),
+			None => shape.sub_path.inflections(),
+		};
+		if LAST_VEC_RAW.len() > 0 {
+			let ret = bezrsFloatsRaw { data: LAST_VEC_RAW.as_mut_ptr(), len: LAST_VEC_RAW.len() as SizeTC };
+			return ret; // Todo: is it memory-safe to return it like this ? (copied, but is the ownership transferred correctly ?)
+		}
+	}
+
+	return bezrsFloatsRaw {data: ptr::null_mut(), len: 0};
+}
+
+#[no_mangle]
+/// Returns the local extrema points on a shape on multiple axis
+// Todo : wrap this in a static array to keep refs to correct axis
+pub extern "C" fn bezrs_shape_localextrema(_shape: *mut bezrsShape) -> bezrsFloatsRaw {
+	let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+    let extremas : [Vec<f64>; 2] = match &shape.prepared {
+        Some(prepared) => prepared.extrema.clone(),
+        None => shape.sub_path.local_extrema(),
+    };
+
+	if extremas.len() > 0 {
+		unsafe {
+			LAST_VEC_RAW = extremas.iter()
+				.zip([0, 1])
+				.flat_map(|(vec, _axis)| {
+					vec.iter().map(|&t_value|{
+						let f : f64 = t_value;
+						return f;
+					})
+				}).collect();
+				return bezrsFloatsRaw { data: LAST_VEC_RAW.as_mut_ptr(), len: LAST_VEC_RAW.len() as SizeTC };
+		}
+	}
+
+	return bezrsFloatsRaw {data: ptr::null(), len: 0};
+}
+
+#[no_mangle]
+/// Returns if a point is contained within a shape
+pub extern "C" fn bezrs_shape_containspoint(_shape: *mut bezrsShape, _pos : bezrsPos) -> bool {
+	let shape = unsafe {
+        assert!(!_shape.is_null());
+        &mut *_shape
+    };
+
+    let contained = match &shape.prepared {
+        Some(prepared) => prepared.contains_point(_pos.to_dvec2()),
+        None => shape.sub_path.contains_point(_pos.to_dvec2()),
+    };
+	return contained; // Todo: is it memory-safe to return it like this ? (copied, but is the ownership transferred correctly ?)
+}
+
+// Conversion utility for local to global tvalue transformation
+fn bezrs_local_to_global_tval(_shape: &Subpath<EmptyId>, seg : usize, t : f64) -> f64 {
+	let number_of_curves = _shape.len_segments() as f64;
+	return ((seg as f64) + t) / number_of_curves;
 }
 
 #[no_mangle]
@@ -579,6 +2324,26 @@ pub extern "C" fn bezrs_shape_selfintersections(_shape: *mut bezrsShape, _error_
 	return bezrsFloatsRaw {data: ptr::null(), len: 0};
 }
 
+#[no_mangle]
+/// Returns positions where the shape self intersects, like `bezrs_shape_selfintersections()`, within a budget.
+/// Segment pairs are searched one by one, checking the deadline and cancellation token between them : the search stops
+/// early instead of stalling, and at `max_results` intersections. `_out` receives the (global) t-values found so far.
+pub extern "C" fn bezrs_shape_selfintersections_budget(_shape: *mut bezrsShape, _error_treshold : f64, _min_dist : f64, _budget: Option<&bezrsBudget>, _out: *mut bezrsFloatsRaw) -> bezrsStatus {
+	let shape = unsafe {
+        assert!(!_shape.is_null() && !_out.is_null());
+        &*_shape
+    };
+
+	let budget = budget::Budget::from_raw(_budget);
+	let mut found : Vec<(usize, f64)> = Vec::new();
+	let status = intersections::self_intersections(&shape.sub_path, _error_treshold, _min_dist, &budget, &mut found);
+	unsafe {
+		LAST_VEC_RAW = found.iter().map(|(segment, t)| bezrs_local_to_global_tval(&shape.sub_path, *segment, *t)).collect();
+		*_out = bezrsFloatsRaw { data: LAST_VEC_RAW.as_mut_ptr(), len: LAST_VEC_RAW.len() as SizeTC };
+	}
+	return status;
+}
+
 #[no_mangle]
 /// Returns the position on the shape from a t-value (0->1) using `evaluate()`.
 pub extern "C" fn bezrs_shape_posfromtvalue(_shape: *mut bezrsShape, _t : f64) -> bezrsPos {
@@ -649,10 +2414,58 @@ pub extern "C" fn bezrs_shape_project_pos(_shape: *mut bezrsShape, _pos : bezrsP
         &mut *_shape
     };
 
-	if let Some((_path_index, t_value)) = shape.sub_path.project( _pos.to_dvec2(), None ) {
+	let projection = match &shape.prepared {
+		Some(prepared) => prepared.project(_pos.to_dvec2()),
+		None => shape.sub_path.project( _pos.to_dvec2(), None ),
+	};
+	if let Some((_path_index, t_value)) = projection {
 		return bezrsPos::from_dvec2(&shape.sub_path.evaluate(SubpathTValue::Parametric { segment_index: _path_index, t: t_value }));
 	}
 
 	return bezrsPos {x:0., y:0.}; // Todo : set this to infinity or something to mark the fail
 }
 
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+
+	// Shape from (anchor, in handle, out handle) triplets
+	fn shape(handles : &[[f64; 6]], closed : bool) -> bezrsShape {
+		let groups = handles.iter().map(|h| ManipulatorGroup {
+			anchor: DVec2::new(h[0], h[1]),
+			in_handle: Some(DVec2::new(h[2], h[3])),
+			out_handle: Some(DVec2::new(h[4], h[5])),
+			id: EmptyId,
+		}).collect();
+		bezrsShape::new(Subpath::new(groups, closed))
+	}
+
+	// Compiled segments, evaluated like `ofxBezierRs::CompiledShape` (Horner), match `bezrs_shape_posfromtvalue()`
+	// within 1e-12 of the coordinate range.
+	#[test]
+	fn compiled_segments_match_evaluate() {
+		let mut shape = shape(&[
+			[0.0, 0.0, -30.0, 40.0, 120.0, -80.0],
+			[400.0, 50.0, 300.0, -60.0, 520.0, 170.0],
+			[350.0, 600.0, 610.0, 580.0, 90.0, 620.0],
+			[-200.0, 300.0, -150.0, 520.0, -260.0, 80.0],
+		], true);
+		let count = bezrs_shape_compile(&mut shape, ptr::null_mut(), 0, 1e-6) as usize;
+		assert_eq!(count, 4);
+		let mut compiled = vec![bezrsCompiledSegment { x: [0.0; 4], y: [0.0; 4], length_start: 0.0, length: 0.0 }; count];
+		bezrs_shape_compile(&mut shape, compiled.as_mut_ptr(), count as SizeTC, 1e-6);
+
+		let range = 810.0;
+		let samples = 10000;
+		for i in 0..=samples {
+			let t = i as f64 / samples as f64;
+			let scaled = t * count as f64;
+			let index = (scaled as usize).min(count - 1);
+			let (s, lt) = (&compiled[index], scaled - index as f64);
+			let local = DVec2::new(((s.x[3] * lt + s.x[2]) * lt + s.x[1]) * lt + s.x[0], ((s.y[3] * lt + s.y[2]) * lt + s.y[1]) * lt + s.y[0]);
+			let reference = bezrs_shape_posfromtvalue(&mut shape, t).to_dvec2();
+			assert!((local - reference).length() <= 1e-12 * range, "t {} : {:?} vs {:?}", t, local, reference);
+		}
+	}
+}
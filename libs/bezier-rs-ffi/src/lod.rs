@@ -0,0 +1,134 @@
+
+// Level of detail cache : flattened polylines of a shape at a ladder of tolerances (powers of 2), built lazily.
+// A requested tolerance maps to its level in O(1) (rounding down, so the error stays within the request up to the cap on lines
+// per segment of the flattening).
+// Levels are kept until the shape mutates, the least recently used ones being evicted beyond a cap on the cached points.
+
+use bezier_rs::Subpath;
+use glam::f64::DVec2;
+
+use crate::{EmptyId, bezrsPos};
+use crate::flatten;
+use crate::segments;
+
+// Tolerances from 2^MIN_LEVEL to 2^MAX_LEVEL shape units
+const MIN_LEVEL : i32 = -24;
+const MAX_LEVEL : i32 = 24;
+const LEVEL_COUNT : usize = (MAX_LEVEL - MIN_LEVEL + 1) as usize;
+// Default cap on the cached points of one shape (16 bytes each)
+pub(crate) const DEFAULT_MAX_POINTS : usize = 1 << 18;
+
+#[derive(Debug, Default)]
+struct Level {
+	points : Vec<bezrsPos>,
+	last_use : u64,
+}
+
+#[derive(Debug)]
+pub(crate) struct LodCache {
+	levels : Vec<Option<Level>>, // LEVEL_COUNT slots once used
+	cached_points : usize,
+	pub(crate) max_points : usize,
+	clock : u64,
+}
+
+impl Default for LodCache {
+	fn default() -> Self {
+		LodCache { levels: Vec::new(), cached_points: 0, max_points: DEFAULT_MAX_POINTS, clock: 0 }
+	}
+}
+
+// Ladder slot of a tolerance, rounded towards the finer level.
+// Zero or negative tolerances take the finest level, infinite or NaN ones the coarsest.
+fn level_index(tolerance : f64) -> usize {
+	let level = if tolerance <= 0.0 { MIN_LEVEL } else if tolerance.is_finite() { tolerance.log2().floor() as i32 } else { MAX_LEVEL };
+	(level.clamp(MIN_LEVEL, MAX_LEVEL) - MIN_LEVEL) as usize
+}
+
+pub(crate) fn level_tolerance(index : usize) -> f64 {
+	(2.0f64).powi(index as i32 + MIN_LEVEL)
+}
+
+// Anchors then chords of every segment, the last point closing closed paths
+fn flatten_subpath(sub_path : &Subpath<EmptyId>, tolerance : f64, out : &mut Vec<bezrsPos>) {
+	let mut points : Vec<DVec2> = Vec::new();
+	for (i, cubic) in segments::iter_cubics(sub_path).enumerate() {
+		if i == 0 {
+			points.push(cubic.p0);
+		}
+		flatten::flatten_cubic_into(&cubic, tolerance, &mut points);
+	}
+	if points.is_empty() {
+		points.extend(sub_path.manipulator_groups().iter().map(|group| group.anchor));
+	}
+	out.clear();
+	out.extend(points.iter().map(bezrsPos::from_dvec2));
+}
+
+impl LodCache {
+
+	// Drops all levels (on mutation), keeping the settings
+	pub(crate) fn clear(&mut self) {
+		self.levels.clear();
+		self.cached_points = 0;
+	}
+
+	// Same settings, no levels (for clones)
+	pub(crate) fn empty_like(&self) -> Self {
+		LodCache { max_points: self.max_points, ..Default::default() }
+	}
+
+	// Cached level closest to `index`, finer levels first
+	fn nearest_cached(&self, index : usize) -> Option<usize> {
+		let cached = |i : usize| self.levels.get(i).map_or(false, |level| level.is_some());
+		(0..LEVEL_COUNT).flat_map(|d| [index.checked_sub(d), Some(index + d).filter(|_| d > 0)])
+			.flatten()
+			.find(|i| *i < LEVEL_COUNT && cached(*i))
+	}
+
+	// Evicts the least recently used levels (except `keep`) until the cap is met
+	fn evict(&mut self, keep : usize) {
+		while self.cached_points > self.max_points {
+			let oldest = self.levels.iter().enumerate()
+				.filter_map(|(i, level)| level.as_ref().filter(|_| i != keep).map(|level| (i, level.last_use)))
+				.min_by_key(|(_, last_use)| *last_use);
+			match oldest {
+				Some((i, _)) => {
+					self.cached_points -= self.levels[i].take().map_or(0, |level| level.points.len());
+				}
+				None => break,
+			}
+		}
+	}
+
+	// Polyline within `tolerance` (shape units) and the tolerance of its level. Builds the level when it isn't cached and
+	// `build` is set, otherwise falls back on the nearest cached level (None when there's none).
+	pub(crate) fn polyline(&mut self, sub_path : &Subpath<EmptyId>, tolerance : f64, build : bool) -> Option<(&[bezrsPos], f64)> {
+		if self.levels.is_empty() {
+			self.levels.resize_with(LEVEL_COUNT, || None);
+		}
+		let wanted = level_index(tolerance);
+		let index = if self.levels[wanted].is_some() || build { wanted } else { self.nearest_cached(wanted)? };
+		self.clock += 1;
+		if self.levels[index].is_none() {
+			let mut level = Level::default();
+			flatten_subpath(sub_path, level_tolerance(index), &mut level.points);
+			self.cached_points += level.points.len();
+			self.levels[index] = Some(level);
+			self.evict(index);
+		}
+		let clock = self.clock;
+		let level = self.levels[index].as_mut()?;
+		level.last_use = clock;
+		Some((&level.points, level_tolerance(index)))
+	}
+
+	pub(crate) fn set_max_points(&mut self, max_points : usize) {
+		self.max_points = max_points;
+		self.evict(LEVEL_COUNT);
+	}
+
+	pub(crate) fn cached_points(&self) -> usize {
+		self.cached_points
+	}
+}
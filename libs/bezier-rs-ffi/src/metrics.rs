@@ -0,0 +1,99 @@
+
+// Shape metrics computed in a single pass over the segments : signed area, orientation, centroid, arc length and tight bounds.
+// Area and centroid come from Green's theorem, integrated exactly per segment (see `Cubic::area_moments()`).
+// Open paths are implicitly closed by a line for the area, like `segments::signed_area()`.
+
+use bezier_rs::{Subpath, ManipulatorGroup};
+use glam::f64::DVec2;
+
+use crate::{EmptyId, bezrsWinding};
+use crate::prepared::Prepared;
+use crate::segments::{self, Bounds, Cubic};
+
+// Areas below this fraction of the squared bounds diagonal are considered null (lines, degenerate shapes)
+const AREA_EPSILON : f64 = 1e-12;
+
+pub(crate) struct Metrics {
+	pub(crate) signed_area : f64,
+	pub(crate) winding : bezrsWinding,
+	pub(crate) centroid : DVec2,
+	pub(crate) length : f64,
+	pub(crate) bounds : Option<Bounds>,
+}
+
+fn winding_of(signed_area : f64, bounds : &Option<Bounds>) -> bezrsWinding {
+	let scale = bounds.map_or(0.0, |b| (b.max - b.min).length_squared());
+	if signed_area.abs() <= AREA_EPSILON * scale || signed_area == 0.0 {
+		bezrsWinding::None
+	} else if signed_area > 0.0 {
+		bezrsWinding::Clockwise
+	} else {
+		bezrsWinding::CounterClockwise
+	}
+}
+
+// `prepared` only provides cached bounds. `length_tolerance` is the absolute arc length error allowed per segment.
+pub(crate) fn measure(sub_path : &Subpath<EmptyId>, prepared : Option<&Prepared>, length_tolerance : f64) -> Metrics {
+	let groups = sub_path.manipulator_groups();
+	let mut bounds = prepared.and_then(|prepared| prepared.bounds);
+	let measure_bounds = bounds.is_none();
+	if measure_bounds && !groups.is_empty() {
+		bounds = Some(Bounds { min: groups[0].anchor, max: groups[0].anchor });
+	}
+
+	let (mut area, mut area_moment) = (0.0, DVec2::ZERO);
+	let (mut length, mut length_moment, mut length_estimate) = (0.0, DVec2::ZERO, 0.0);
+	let mut add = |cubic : &Cubic, with_length : bool| {
+		let (a, m) = cubic.area_moments();
+		area += a;
+		area_moment += m;
+		if with_length {
+			length += cubic.length(length_tolerance);
+			length_moment += cubic.length_moment();
+			length_estimate += cubic.length_gauss(0.0, 1.0); // Same quadrature as the moment
+		}
+	};
+	for cubic in segments::iter_cubics(sub_path) {
+		add(&cubic, true);
+		if let Some(b) = bounds.as_mut().filter(|_| measure_bounds) {
+			let [x, y] = cubic.extrema();
+			for p in std::iter::once(cubic.p3).chain(x.iter().chain(y.iter()).map(|t| cubic.evaluate(*t))) {
+				b.min = b.min.min(p);
+				b.max = b.max.max(p);
+			}
+		}
+	}
+	if !sub_path.closed() && groups.len() > 1 {
+		let (a, b) = (groups[groups.len() - 1].anchor, groups[0].anchor);
+		add(&Cubic { p0: a, p1: a.lerp(b, 1.0 / 3.0), p2: a.lerp(b, 2.0 / 3.0), p3: b }, false);
+	}
+
+	let winding = winding_of(area, &bounds);
+	// Centroid of the enclosed area, falling back to the one of the curve itself for null areas
+	let centroid = if winding != bezrsWinding::None {
+		area_moment / area
+	} else if length_estimate > 0.0 {
+		length_moment / length_estimate
+	} else {
+		groups.first().map_or(DVec2::ZERO, |group| group.anchor)
+	};
+	Metrics { signed_area: area, winding, centroid, length, bounds }
+}
+
+// True when the handles need to be reversed for the subpath to wind in `winding` (None : never).
+pub(crate) fn needs_reversal(sub_path : &Subpath<EmptyId>, winding : bezrsWinding) -> bool {
+	let signed_area = segments::signed_area(sub_path);
+	match winding {
+		bezrsWinding::None => false,
+		bezrsWinding::Clockwise => signed_area < 0.0,
+		bezrsWinding::CounterClockwise => signed_area > 0.0,
+	}
+}
+
+// Reverses the order of the handles in place, like bezier-rs `Subpath::reverse()`, without reallocating.
+pub(crate) fn reverse_groups(groups : &mut [ManipulatorGroup<EmptyId>]) {
+	groups.reverse();
+	for group in groups.iter_mut() {
+		std::mem::swap(&mut group.in_handle, &mut group.out_handle);
+	}
+}
@@ -0,0 +1,290 @@
+
+// Shape morphing : interpolates bezier handles between keyframe shapes.
+// The correspondence between keyframes is computed once (resampling them to the same amount of segments when needed),
+// so that each frame only costs a linear blend of the handle buffers.
+
+use std::collections::BinaryHeap;
+
+use bezier_rs::{Subpath, ManipulatorGroup};
+use glam::f64::DVec2;
+
+use crate::{EmptyId, bezrsBezierHandle, bezrsPos};
+use crate::segments::{self, Cubic};
+
+// Absolute arc length tolerance used for distributing the resampled segments
+const LENGTH_TOLERANCE : f64 = 1e-3;
+// Maximum amount of anchors compared per candidate start point, when aligning closed shapes
+const ALIGN_SAMPLES : usize = 256;
+
+// Keyframe as a chain of explicit cubics, plus the dangling handles of open paths
+#[derive(Debug, Clone)]
+struct Chain {
+	cubics : Vec<Cubic>,
+	first_in : DVec2,
+	last_out : DVec2,
+}
+
+impl Chain {
+
+	// Converts a subpath to explicit cubics, opening or closing it to match `closed`
+	fn new(sub_path : &Subpath<EmptyId>, closed : bool) -> Self {
+		let groups = sub_path.manipulator_groups();
+		let mut cubics : Vec<Cubic> = segments::iter_cubics(sub_path).collect();
+		let (mut first_in, mut last_out) = match (groups.first(), groups.last()) {
+			(Some(first), Some(last)) => (first.in_handle.unwrap_or(first.anchor), last.out_handle.unwrap_or(last.anchor)),
+			_ => (DVec2::ZERO, DVec2::ZERO),
+		};
+		if closed && !sub_path.closed() && groups.len() > 1 {
+			// Closing line
+			let (p0, p3) = (groups[groups.len() - 1].anchor, groups[0].anchor);
+			cubics.push(Cubic { p0, p1: p0.lerp(p3, 1.0 / 3.0), p2: p0.lerp(p3, 2.0 / 3.0), p3 });
+		}
+		else if !closed && sub_path.closed() {
+			// Opened at the first anchor, which ends up at both ends
+			first_in = groups[0].anchor;
+			last_out = groups[0].anchor;
+		}
+		Chain { cubics, first_in, last_out }
+	}
+
+	fn anchors_centered(&self) -> Vec<DVec2> {
+		let center = self.cubics.iter().fold(DVec2::ZERO, |sum, cubic| sum + cubic.p0) / self.cubics.len().max(1) as f64;
+		self.cubics.iter().map(|cubic| cubic.p0 - center).collect()
+	}
+
+	// Subdivides the segments until there are `count` of them, each segment getting a share proportional to its length.
+	fn resample(&mut self, count : usize) {
+		let len = self.cubics.len();
+		if len == 0 || len >= count {
+			return;
+		}
+		let mut lengths : Vec<f64> = self.cubics.iter().map(|cubic| cubic.length(LENGTH_TOLERANCE)).collect();
+		if lengths.iter().all(|l| *l <= 0.0) {
+			lengths.iter_mut().for_each(|l| *l = 1.0);
+		}
+
+		// Greedily split the segment having the longest pieces. Positive floats keep their order as bits.
+		let mut pieces = vec![1usize; len];
+		let mut heap : BinaryHeap<(u64, usize)> = lengths.iter().enumerate().map(|(i, l)| (l.to_bits(), i)).collect();
+		for _ in len..count {
+			let (_, i) = heap.pop().unwrap();
+			pieces[i] += 1;
+			heap.push(((lengths[i] / pieces[i] as f64).to_bits(), i));
+		}
+
+		let mut cubics = Vec::with_capacity(count);
+		for (cubic, k) in self.cubics.iter().zip(pieces) {
+			for j in 0..k {
+				cubics.push(cubic.trim(j as f64 / k as f64, (j + 1) as f64 / k as f64));
+			}
+		}
+		self.cubics = cubics;
+	}
+
+	fn reverse(&mut self) {
+		self.cubics.reverse();
+		for cubic in self.cubics.iter_mut() {
+			*cubic = Cubic { p0: cubic.p3, p1: cubic.p2, p2: cubic.p1, p3: cubic.p0 };
+		}
+		std::mem::swap(&mut self.first_in, &mut self.last_out);
+	}
+
+	fn signed_area(&self) -> f64 {
+		self.cubics.iter().map(|cubic| cubic.signed_area()).sum()
+	}
+
+	// Rotates the start of a closed chain so that its anchors best match the reference anchors (least squares, centroids aligned).
+	fn align_start(&mut self, reference : &[DVec2]) {
+		let len = self.cubics.len();
+		if len < 2 || reference.len() != len {
+			return;
+		}
+		let anchors = self.anchors_centered();
+		let step = (len + ALIGN_SAMPLES - 1) / ALIGN_SAMPLES;
+		let cost = |shift : usize| -> f64 {
+			(0..len).step_by(step).map(|i| (reference[i] - anchors[(i + shift) % len]).length_squared()).sum()
+		};
+		let best = (0..len).map(|shift| (cost(shift), shift)).fold((f64::MAX, 0), |a, b| if b.0 < a.0 { b } else { a }).1;
+		self.cubics.rotate_left(best);
+	}
+
+	// Appends the bezier handles of the chain (one per anchor)
+	fn push_handles(&self, closed : bool, out : &mut Vec<bezrsBezierHandle>) {
+		let len = self.cubics.len();
+		if len == 0 {
+			return;
+		}
+		let handle = |anchor : DVec2, in_bez : DVec2, out_bez : DVec2| bezrsBezierHandle {
+			pos: bezrsPos::from_dvec2(&anchor),
+			in_bez: bezrsPos::from_dvec2(&in_bez),
+			out_bez: bezrsPos::from_dvec2(&out_bez),
+		};
+		for (i, cubic) in self.cubics.iter().enumerate() {
+			let in_bez = if i > 0 { self.cubics[i - 1].p2 } else if closed { self.cubics[len - 1].p2 } else { self.first_in };
+			out.push(handle(cubic.p0, in_bez, cubic.p1));
+		}
+		if !closed {
+			let last = &self.cubics[len - 1];
+			out.push(handle(last.p3, last.p2, self.last_out));
+		}
+	}
+}
+
+// CSS-like timing curve from (0,0) to (1,1), with control points (x1,y1) and (x2,y2)
+#[derive(Debug, Copy, Clone)]
+pub(crate) struct Easing {
+	x : [f64; 2],
+	y : [f64; 2],
+}
+
+impl Easing {
+
+	pub(crate) fn new(x1 : f64, y1 : f64, x2 : f64, y2 : f64) -> Self {
+		// x needs to be monotonic for the curve to be a function of time
+		Easing { x: [x1.clamp(0.0, 1.0), x2.clamp(0.0, 1.0)], y: [y1, y2] }
+	}
+
+	fn bezier(c : &[f64; 2], u : f64) -> f64 {
+		let mu = 1.0 - u;
+		3.0 * mu * mu * u * c[0] + 3.0 * mu * u * u * c[1] + u * u * u
+	}
+
+	pub(crate) fn apply(&self, s : f64) -> f64 {
+		let s = s.clamp(0.0, 1.0);
+		// Solve x(u) = s : Newton steps, falling back to bisection
+		let mut u = s;
+		for _ in 0..8 {
+			let error = Self::bezier(&self.x, u) - s;
+			if error.abs() < 1e-9 {
+				return Self::bezier(&self.y, u);
+			}
+			let mu = 1.0 - u;
+			let slope = 3.0 * mu * mu * self.x[0] + 6.0 * mu * u * (self.x[1] - self.x[0]) + 3.0 * u * u * (1.0 - self.x[1]);
+			if slope.abs() < 1e-6 {
+				break;
+			}
+			u = (u - error / slope).clamp(0.0, 1.0);
+		}
+		let (mut lo, mut hi) = (0.0, 1.0);
+		for _ in 0..40 {
+			u = 0.5 * (lo + hi);
+			if Self::bezier(&self.x, u) < s { lo = u; } else { hi = u; }
+		}
+		Self::bezier(&self.y, u)
+	}
+}
+
+// Views handles as a flat scalar buffer (6 doubles each), for the blend kernel
+fn as_scalars(handles : &[bezrsBezierHandle]) -> &[f64] {
+	unsafe { std::slice::from_raw_parts(handles.as_ptr() as *const f64, handles.len() * 6) }
+}
+
+fn as_scalars_mut(handles : &mut [bezrsBezierHandle]) -> &mut [f64] {
+	unsafe { std::slice::from_raw_parts_mut(handles.as_mut_ptr() as *mut f64, handles.len() * 6) }
+}
+
+#[derive(Debug)]
+pub(crate) struct Morph {
+	keyframes : Vec<Vec<bezrsBezierHandle>>, // Corresponding handles, all keyframes having the same amount
+	pub(crate) closed : bool,
+	pub(crate) easing : Option<Easing>,
+	pub(crate) resampled : bool, // Whether the keyframes needed resampling to correspond
+}
+
+impl Morph {
+
+	pub(crate) fn new() -> Self {
+		Morph { keyframes: Vec::new(), closed: false, easing: None, resampled: false }
+	}
+
+	// Handles per frame
+	pub(crate) fn len(&self) -> usize {
+		self.keyframes.first().map_or(0, |keyframe| keyframe.len())
+	}
+
+	// Builds the correspondence between keyframes. The first keyframe decides whether the morph is closed.
+	// Keyframes with matching topology correspond handle by handle. Otherwise, all keyframes get subdivided to the
+	// largest amount of segments and closed ones are aligned on the previous keyframe (winding and start anchor).
+	// Degenerate keyframes (no segments) can't be blended : returns false and keeps the previous keyframes if any keyframe is degenerate.
+	pub(crate) fn set_keyframes(&mut self, sub_paths : &[&Subpath<EmptyId>]) -> bool {
+		let closed = sub_paths.first().map_or(false, |sub_path| sub_path.closed());
+		let mut chains : Vec<Chain> = sub_paths.iter().map(|sub_path| Chain::new(sub_path, closed)).collect();
+		if chains.iter().any(|chain| chain.cubics.is_empty()) {
+			return false;
+		}
+		self.closed = closed;
+
+		let count = chains.iter().map(|chain| chain.cubics.len()).max().unwrap_or(0);
+		self.resampled = sub_paths.iter().zip(chains.iter()).any(|(sub_path, chain)| chain.cubics.len() != count || sub_path.closed() != self.closed);
+		if self.resampled {
+			chains.iter_mut().for_each(|chain| chain.resample(count));
+			for i in 1..chains.len() {
+				if !self.closed || chains[i].cubics.len() != count || chains[i - 1].cubics.len() != count {
+					continue;
+				}
+				if chains[i].signed_area() * chains[i - 1].signed_area() < 0.0 {
+					chains[i].reverse();
+				}
+				let reference = chains[i - 1].anchors_centered();
+				chains[i].align_start(&reference);
+			}
+		}
+
+		// Recycle the keyframe buffers
+		self.keyframes.resize_with(chains.len(), Vec::new);
+		for (keyframe, chain) in self.keyframes.iter_mut().zip(chains.iter()) {
+			keyframe.clear();
+			chain.push_handles(self.closed, keyframe);
+		}
+		return true;
+	}
+
+	// Keyframes surrounding `t` (0 -> first keyframe, 1 -> last keyframe) and the eased blend factor between them
+	fn locate(&self, t : f64) -> (usize, usize, f64) {
+		let intervals = self.keyframes.len().saturating_sub(1);
+		if intervals == 0 {
+			return (0, 0, 0.0);
+		}
+		let position = t.clamp(0.0, 1.0) * intervals as f64;
+		let index = (position.floor() as usize).min(intervals - 1);
+		let local = position - index as f64;
+		let blend = match &self.easing { Some(easing) => easing.apply(local), None => local };
+		(index, index + 1, blend)
+	}
+
+	// Writes the interpolated handles into `out` (at most `out.len()` of them)
+	pub(crate) fn blend_handles(&self, t : f64, out : &mut [bezrsBezierHandle]) {
+		if self.keyframes.is_empty() {
+			return;
+		}
+		let (a, b, s) = self.locate(t);
+		let len = out.len().min(self.len());
+		let (a, b) = (as_scalars(&self.keyframes[a][..len]), as_scalars(&self.keyframes[b][..len]));
+		// Branchless loop over contiguous doubles : auto-vectorized
+		for ((o, a), b) in as_scalars_mut(&mut out[..len]).iter_mut().zip(a).zip(b) {
+			*o = a + (b - a) * s;
+		}
+	}
+
+	// Writes the interpolated shape into a subpath, in place when it already has the right amount of handles
+	pub(crate) fn blend_sub_path(&self, t : f64, sub_path : &mut Subpath<EmptyId>) {
+		let len = self.len();
+		let safe_closed = self.closed && len > 1;
+		if sub_path.len() != len || sub_path.closed() != safe_closed {
+			let mut manipulator_groups = std::mem::take(sub_path.manipulator_groups_mut());
+			manipulator_groups.clear();
+			manipulator_groups.resize_with(len, || ManipulatorGroup { anchor: DVec2::ZERO, in_handle: None, out_handle: None, id: EmptyId });
+			*sub_path = Subpath::new(manipulator_groups, safe_closed);
+		}
+		if len == 0 {
+			return;
+		}
+		let (a, b, s) = self.locate(t);
+		let lerp = |a : &bezrsPos, b : &bezrsPos| DVec2::new(a.x + (b.x - a.x) * s, a.y + (b.y - a.y) * s);
+		for ((group, a), b) in sub_path.manipulator_groups_mut().iter_mut().zip(&self.keyframes[a]).zip(&self.keyframes[b]) {
+			group.anchor = lerp(&a.pos, &b.pos);
+			group.in_handle = Some(lerp(&a.in_bez, &b.in_bez));
+			group.out_handle = Some(lerp(&a.out_bez, &b.out_bez));
+		}
+	}
+}
@@ -0,0 +1,90 @@
+
+// Packed multi-shape storage : many shapes sharing one handle buffer, so results with many pieces cost no per-piece allocations.
+
+use crate::{bezrsBezierHandle, bezrsPos, bezrsShapeSpan, SizeTC};
+use crate::segments::Cubic;
+
+#[derive(Debug, Default)]
+pub(crate) struct MultiShapeData {
+	pub(crate) handles : Vec<bezrsBezierHandle>,
+	pub(crate) spans : Vec<bezrsShapeSpan>,
+}
+
+impl MultiShapeData {
+
+	// Empties the buffers, keeping their capacity
+	pub(crate) fn clear(&mut self) {
+		self.handles.clear();
+		self.spans.clear();
+	}
+
+	// Appends a chain of connected cubic segments as one path.
+	pub(crate) fn push_chain(&mut self, chain : &[Cubic], closed : bool) {
+		if chain.is_empty() {
+			return;
+		}
+		let offset = self.handles.len();
+		push_chain_handles(&mut self.handles, chain, closed);
+		self.spans.push(bezrsShapeSpan {
+			offset: offset as SizeTC,
+			len: (self.handles.len() - offset) as SizeTC,
+			closed,
+		});
+	}
+
+	// Appends a straight line as a 2-handle path (handles collapsed onto the anchors).
+	pub(crate) fn push_line(&mut self, from : glam::f64::DVec2, to : glam::f64::DVec2) {
+		let offset = self.handles.len();
+		self.handles.push(handle(from, from, from));
+		self.handles.push(handle(to, to, to));
+		self.spans.push(bezrsShapeSpan { offset: offset as SizeTC, len: 2, closed: false });
+	}
+
+	// Reverses the order and the direction of all shapes from `first_span` on.
+	pub(crate) fn reverse_from(&mut self, first_span : usize) {
+		if first_span >= self.spans.len() {
+			return;
+		}
+		let start = self.spans[first_span].offset as usize;
+		let handles = &mut self.handles[start..];
+		handles.reverse();
+		for h in handles.iter_mut() {
+			std::mem::swap(&mut h.in_bez, &mut h.out_bez);
+		}
+		let spans = &mut self.spans[first_span..];
+		spans.reverse();
+		let mut offset = start;
+		for span in spans.iter_mut() {
+			span.offset = offset as SizeTC;
+			offset += span.len as usize;
+		}
+	}
+}
+
+// Appends the handles of a chain of connected cubic segments.
+pub(crate) fn push_chain_handles(handles : &mut Vec<bezrsBezierHandle>, chain : &[Cubic], closed : bool) {
+	if chain.is_empty() {
+		return;
+	}
+	let first = &chain[0];
+	let last = &chain[chain.len() - 1];
+
+	// The first handle's "in" is the closing segment's end handle when closed
+	let first_in = if closed { last.p2 } else { first.p0 };
+	handles.push(handle(first.p0, first_in, first.p1));
+	for pair in chain.windows(2) {
+		handles.push(handle(pair[1].p0, pair[0].p2, pair[1].p1));
+	}
+	if !closed {
+		handles.push(handle(last.p3, last.p2, last.p3));
+	}
+}
+
+#[inline]
+fn handle(pos : glam::f64::DVec2, in_bez : glam::f64::DVec2, out_bez : glam::f64::DVec2) -> bezrsBezierHandle {
+	bezrsBezierHandle {
+		pos: bezrsPos::from_dvec2(&pos),
+		in_bez: bezrsPos::from_dvec2(&in_bez),
+		out_bez: bezrsPos::from_dvec2(&out_bez),
+	}
+}
@@ -0,0 +1,367 @@
+
+// Incremental offsetting : per-segment offset curves and per-anchor joins, cached so that editing a few handles
+// only recomputes the segments around them (plus their joins), then splices everything back together.
+// Segments are offset by fitting cubics through samples of the exact offset curve, splitting until within tolerance.
+// Joins follow bezier-rs's rules : concave joins clip the overlapping pieces, convex ones get a bevel, miter or round join.
+
+use bezier_rs::Subpath;
+use glam::f64::DVec2;
+
+use crate::{EmptyId, bezrsJoinType, bezrsStatus};
+use crate::budget::Budget;
+use crate::fit::Fitter;
+use crate::segments::{self, Cubic, Bounds};
+
+// Samples of the exact offset curve, per fitted piece
+const OFFSET_SAMPLES : usize = 16;
+// Subdivision depth limit when fitting offset pieces (cusps never converge)
+const MAX_OFFSET_DEPTH : u32 = 10;
+// Pieces searched on each side of a concave join for the clipping intersection
+const CLIP_SEARCH_PIECES : usize = 4;
+// Default miter limit (ratio of the miter length to the offset distance), as in SVG
+const DEFAULT_MITER_LIMIT : f64 = 4.0;
+
+// Offset point at t : positive distances go to the right of the direction of travel (inside a clockwise shape, y down)
+fn offset_point(cubic : &Cubic, t : f64, distance : f64) -> DVec2 {
+	cubic.evaluate(t) + cubic.tangent(t).perp() * distance
+}
+
+fn is_flat(cubic : &Cubic) -> bool {
+	let chord = cubic.p3 - cubic.p0;
+	let length = chord.length();
+	if length <= 1e-12 {
+		return (cubic.p1 - cubic.p0).length() <= 1e-12 && (cubic.p2 - cubic.p0).length() <= 1e-12;
+	}
+	let cross = |p : DVec2| (chord.x * (p.y - cubic.p0.y) - chord.y * (p.x - cubic.p0.x)).abs() / length;
+	cross(cubic.p1) <= 1e-9 * length && cross(cubic.p2) <= 1e-9 * length
+}
+
+fn offset_range(cubic : &Cubic, t0 : f64, t1 : f64, distance : f64, tolerance_sq : f64, depth : u32, fitter : &mut Fitter, points : &mut Vec<DVec2>, out : &mut Vec<Cubic>) {
+	points.clear();
+	points.extend((0..=OFFSET_SAMPLES).map(|i| offset_point(cubic, t0 + (t1 - t0) * i as f64 / OFFSET_SAMPLES as f64, distance)));
+	let (start, end) = (points[0], points[OFFSET_SAMPLES]);
+
+	// The offset curve is parallel to the source : same tangents at both ends
+	if let Some(piece) = fitter.fit_single(points, cubic.tangent(t0), -cubic.tangent(t1), tolerance_sq) {
+		out.push(piece);
+		return;
+	}
+	// Tiny or unfittable (around cusps) : a line is as good as it gets
+	let extent = Bounds::from_points(points);
+	if depth >= MAX_OFFSET_DEPTH || (extent.max - extent.min).length_squared() <= tolerance_sq {
+		out.push(Cubic { p0: start, p1: start.lerp(end, 1.0 / 3.0), p2: start.lerp(end, 2.0 / 3.0), p3: end });
+		return;
+	}
+	let mid = 0.5 * (t0 + t1);
+	offset_range(cubic, t0, mid, distance, tolerance_sq, depth + 1, fitter, points, out);
+	offset_range(cubic, mid, t1, distance, tolerance_sq, depth + 1, fitter, points, out);
+}
+
+// Offsets one segment into a chain of connected cubics
+pub(crate) fn offset_cubic(cubic : &Cubic, distance : f64, tolerance : f64, fitter : &mut Fitter, out : &mut Vec<Cubic>) {
+	if is_flat(cubic) {
+		let shift = cubic.tangent(0.5).perp() * distance;
+		out.push(Cubic { p0: cubic.p0 + shift, p1: cubic.p1 + shift, p2: cubic.p2 + shift, p3: cubic.p3 + shift });
+		return;
+	}
+	// Inflections make the offset change side of the curvature : fit them separately
+	let mut splits : Vec<f64> = cubic.inflections();
+	splits.sort_unstable_by(|a, b| a.total_cmp(b));
+	let mut points : Vec<DVec2> = Vec::new();
+	let mut t0 = 0.0;
+	for t1 in splits.into_iter().chain(std::iter::once(1.0)) {
+		if t1 - t0 > 1e-9 {
+			offset_range(cubic, t0, t1, distance, (tolerance * tolerance).max(1e-18), 0, fitter, &mut points, out);
+		}
+		t0 = t1;
+	}
+}
+
+// Intersection of two cubics by recursive bounding box subdivision, as (ta, tb). Keeps the one furthest along `a`.
+fn intersect(a : &Cubic, (a0, a1) : (f64, f64), b : &Cubic, (b0, b1) : (f64, f64), epsilon : f64, depth : u32, best : &mut Option<(f64, f64)>) {
+	let (ba, bb) = (Bounds::from_points(&[a.p0, a.p1, a.p2, a.p3]), Bounds::from_points(&[b.p0, b.p1, b.p2, b.p3]));
+	if ba.distance_to_bounds(&bb) > 0.0 {
+		return;
+	}
+	let size = |bounds : &Bounds| (bounds.max - bounds.min).max_element();
+	if depth >= 40 || (size(&ba) <= epsilon && size(&bb) <= epsilon) {
+		let t = (0.5 * (a0 + a1), 0.5 * (b0 + b1));
+		if best.map_or(true, |current| t.0 > current.0) {
+			*best = Some(t);
+		}
+		return;
+	}
+	let (am, bm) = (0.5 * (a0 + a1), 0.5 * (b0 + b1));
+	let (a_left, a_right) = a.split(0.5);
+	let (b_left, b_right) = b.split(0.5);
+	// Visit the end of `a` first, to prune what can't beat the current best
+	for (a_half, a_range) in [(a_right, (am, a1)), (a_left, (a0, am))] {
+		if best.map_or(false, |current| a_range.1 <= current.0) {
+			continue;
+		}
+		for (b_half, b_range) in [(b_left, (b0, bm)), (b_right, (bm, b1))] {
+			intersect(&a_half, a_range, &b_half, b_range, epsilon, depth + 1, best);
+		}
+	}
+}
+
+// Circular arc from `from` to `to` around `center`, as cubics of at most 90 degrees
+pub(crate) fn push_arc(center : DVec2, from : DVec2, to : DVec2, out : &mut Vec<Cubic>) {
+	let (va, vb) = (from - center, to - center);
+	let radius = va.length();
+	let mut sweep = (va.x * vb.y - va.y * vb.x).atan2(va.dot(vb));
+	if sweep == 0.0 {
+		return;
+	}
+	let count = (sweep.abs() / std::f64::consts::FRAC_PI_2).ceil().max(1.0) as usize;
+	sweep /= count as f64;
+	let k = 4.0 / 3.0 * (sweep / 4.0).tan();
+	let mut angle = va.y.atan2(va.x);
+	let mut start = from;
+	for i in 0..count {
+		angle += sweep;
+		let end = if i + 1 == count { to } else { center + DVec2::new(angle.cos(), angle.sin()) * radius };
+		let (ds, de) = ((start - center).perp() * k, (end - center).perp() * k);
+		out.push(Cubic { p0: start, p1: start + ds, p2: end - de, p3: end });
+		start = end;
+	}
+}
+
+pub(crate) fn push_line(from : DVec2, to : DVec2, out : &mut Vec<Cubic>) {
+	out.push(Cubic { p0: from, p1: from.lerp(to, 1.0 / 3.0), p2: from.lerp(to, 2.0 / 3.0), p3: to });
+}
+
+// Bridges the convex side of a join around `anchor`, from `end` (travelling along `tangent_in`) to `start` (leaving along `tangent_out`).
+// Miters longer than `miter_limit` times the offset `distance` fall back to a bevel.
+pub(crate) fn push_join(join : bezrsJoinType, miter_limit : f64, distance : f64, anchor : DVec2, end : DVec2, tangent_in : DVec2, start : DVec2, tangent_out : DVec2, out : &mut Vec<Cubic>) {
+	match join {
+		bezrsJoinType::Bevel => push_line(end, start, out),
+		bezrsJoinType::Round => push_arc(anchor, end, start, out),
+		bezrsJoinType::Mitter => {
+			let limit = if miter_limit > 0.0 { miter_limit } else { DEFAULT_MITER_LIMIT };
+			// Intersection of the tangent rays leaving both ends
+			let denominator = tangent_in.x * tangent_out.y - tangent_in.y * tangent_out.x;
+			let miter = if denominator.abs() > 1e-12 {
+				let s = ((start - end).x * tangent_out.y - (start - end).y * tangent_out.x) / denominator;
+				Some(end + tangent_in * s).filter(|_| s > 0.0)
+			} else {
+				None
+			};
+			match miter {
+				Some(point) if point.distance(anchor) <= limit * distance.abs() => {
+					push_line(end, point, out);
+					push_line(point, start, out);
+				}
+				_ => push_line(end, start, out),
+			}
+		}
+	}
+}
+
+// Where a piece chain is cut by a concave join : piece index and t
+#[derive(Debug, Copy, Clone, PartialEq)]
+struct Cut {
+	piece : usize,
+	t : f64,
+}
+
+#[derive(Debug, Default)]
+struct SegmentOffset {
+	source : Option<Cubic>, // Key for detecting edits
+	pieces : Vec<Cubic>,
+}
+
+// Join at an anchor, between the segment ending there and the one starting there
+#[derive(Debug, Default)]
+struct JoinOffset {
+	end_of_previous : Option<Cut>,
+	start_of_next : Option<Cut>,
+	pieces : Vec<Cubic>, // Connecting pieces for convex joins
+}
+
+#[derive(Debug, Default)]
+pub(crate) struct IncrementalOffset {
+	pub(crate) distance : f64,
+	pub(crate) join : Option<bezrsJoinType>,
+	pub(crate) miter_limit : f64,
+	pub(crate) tolerance : f64,
+	closed : bool,
+	segments : Vec<SegmentOffset>,
+	joins : Vec<JoinOffset>, // joins[i] at anchor i
+	fitter : Fitter,
+}
+
+fn same_cubic(a : &Cubic, b : &Cubic) -> bool {
+	a.p0 == b.p0 && a.p1 == b.p1 && a.p2 == b.p2 && a.p3 == b.p3
+}
+
+impl IncrementalOffset {
+
+	pub(crate) fn new(distance : f64, join : bezrsJoinType, miter_limit : f64, tolerance : f64) -> Self {
+		IncrementalOffset { distance, join: Some(join), miter_limit, tolerance, ..Default::default() }
+	}
+
+	// Forgets all cached results (for parameter changes)
+	pub(crate) fn invalidate(&mut self) {
+		self.segments.clear();
+		self.joins.clear();
+	}
+
+	fn compute_join(&self, index : usize) -> JoinOffset {
+		let mut join = JoinOffset::default();
+		let count = self.segments.len();
+		if count == 0 || (!self.closed && (index == 0 || index >= count)) {
+			return join;
+		}
+		let (previous, next) = (&self.segments[(index + count - 1) % count], &self.segments[index % count]);
+		let (source_previous, source_next) = match (previous.source, next.source) {
+			(Some(source_previous), Some(source_next)) => (source_previous, source_next),
+			_ => return join,
+		};
+		if previous.pieces.is_empty() || next.pieces.is_empty() {
+			return join;
+		}
+		let end = previous.pieces[previous.pieces.len() - 1].p3;
+		let start = next.pieces[0].p0;
+		if end.distance(start) <= 1e-9 {
+			return join;
+		}
+
+		let (tangent_in, tangent_out) = (source_previous.tangent(1.0), source_next.tangent(0.0));
+		let turn = tangent_in.x * tangent_out.y - tangent_in.y * tangent_out.x;
+		if turn * self.distance > 0.0 {
+			// Concave : the pieces overlap, clip them at their intersection closest to the join
+			let epsilon = self.tolerance.max(1e-6) * 1e-3;
+			let mut found : Option<(Cut, Cut)> = None;
+			let first_previous = previous.pieces.len().saturating_sub(CLIP_SEARCH_PIECES);
+			'search: for i in (first_previous..previous.pieces.len()).rev() {
+				for j in 0..next.pieces.len().min(CLIP_SEARCH_PIECES) {
+					let mut best = None;
+					intersect(&previous.pieces[i], (0.0, 1.0), &next.pieces[j], (0.0, 1.0), epsilon, 0, &mut best);
+					if let Some((ta, tb)) = best {
+						found = Some((Cut { piece: i, t: ta }, Cut { piece: j, t: tb }));
+						break 'search;
+					}
+				}
+			}
+			if let Some((cut_previous, cut_next)) = found {
+				join.end_of_previous = Some(cut_previous);
+				join.start_of_next = Some(cut_next);
+				return join;
+			}
+		}
+
+		// Convex, or nothing to clip : bridge the gap
+		let join_type = self.join.unwrap_or(bezrsJoinType::Bevel);
+		push_join(join_type, self.miter_limit, self.distance, source_next.p0, end, tangent_in, start, tangent_out, &mut join.pieces);
+		join
+	}
+
+	// Brings the cache up to date with the subpath, recomputing only what changed. Returns the amount of recomputed segments.
+	pub(crate) fn update(&mut self, sub_path : &Subpath<EmptyId>) -> usize {
+		self.update_within(sub_path, &Budget::unlimited()).unwrap_or(0)
+	}
+
+	// Same as `update()`, polling the budget between segments and joins. When interrupted, the cache is cleared.
+	pub(crate) fn update_within(&mut self, sub_path : &Subpath<EmptyId>, budget : &Budget) -> Result<usize, bezrsStatus> {
+		let count = segments::segment_count(sub_path);
+		if sub_path.closed() != self.closed {
+			self.invalidate();
+			self.closed = sub_path.closed();
+		}
+
+		// Map the new segments onto the cached ones : same index when the count didn't change, otherwise common prefix and suffix
+		let sources : Vec<Cubic> = segments::iter_cubics(sub_path).collect();
+		let old_count = self.segments.len();
+		let mut old_segments = std::mem::take(&mut self.segments);
+		let mut old_joins = std::mem::take(&mut self.joins);
+		let mut reuse : Vec<Option<usize>> = vec![None; count];
+		if old_count == count {
+			for i in 0..count {
+				if old_segments[i].source.map_or(false, |source| same_cubic(&source, &sources[i])) {
+					reuse[i] = Some(i);
+				}
+			}
+		} else {
+			let matches = |i : usize, j : usize| old_segments[j].source.map_or(false, |source| same_cubic(&source, &sources[i]));
+			let mut prefix = 0;
+			while prefix < count.min(old_count) && matches(prefix, prefix) {
+				reuse[prefix] = Some(prefix);
+				prefix += 1;
+			}
+			let mut suffix = 0;
+			while suffix < count.min(old_count) - prefix && matches(count - 1 - suffix, old_count - 1 - suffix) {
+				reuse[count - 1 - suffix] = Some(old_count - 1 - suffix);
+				suffix += 1;
+			}
+		}
+
+		// Segments
+		let mut recomputed = 0;
+		let mut fitter = std::mem::take(&mut self.fitter);
+		for (i, source) in sources.iter().enumerate() {
+			if let Some(status) = budget.interrupted() {
+				self.fitter = fitter;
+				self.invalidate();
+				return Err(status);
+			}
+			match reuse[i] {
+				Some(old) => self.segments.push(std::mem::take(&mut old_segments[old])),
+				None => {
+					let mut pieces = Vec::new();
+					offset_cubic(source, self.distance, self.tolerance, &mut fitter, &mut pieces);
+					self.segments.push(SegmentOffset { source: Some(*source), pieces });
+					recomputed += 1;
+				}
+			}
+		}
+		self.fitter = fitter;
+
+		// Joins : reused when both adjacent segments were reused from the same neighbours
+		for i in 0..count {
+			if let Some(status) = budget.interrupted() {
+				self.invalidate();
+				return Err(status);
+			}
+			let previous = if i == 0 { if self.closed { Some(count - 1) } else { None } } else { Some(i - 1) };
+			let kept = match (previous.map(|p| reuse[p]), reuse[i]) {
+				(Some(Some(old_previous)), Some(old)) => old == (old_previous + 1) % old_count.max(1) && old < old_joins.len(),
+				(None, Some(old)) => old == 0 && !old_joins.is_empty(),
+				_ => false,
+			};
+			let join = if kept { std::mem::take(&mut old_joins[reuse[i].unwrap()]) } else { JoinOffset::default() };
+			self.joins.push(join);
+			if !kept {
+				let join = self.compute_join(i);
+				self.joins[i] = join;
+			}
+		}
+		Ok(recomputed)
+	}
+
+	// Splices all cached pieces into one chain
+	pub(crate) fn chain(&self, out : &mut Vec<Cubic>) {
+		out.clear();
+		let count = self.segments.len();
+		for i in 0..count {
+			let pieces = &self.segments[i].pieces;
+			if pieces.is_empty() {
+				continue;
+			}
+			let next_join = if i + 1 < count { Some(&self.joins[i + 1]) } else if self.closed { Some(&self.joins[0]) } else { None };
+			let start = self.joins[i].start_of_next.unwrap_or(Cut { piece: 0, t: 0.0 });
+			let end = next_join.and_then(|join| join.end_of_previous).unwrap_or(Cut { piece: pieces.len() - 1, t: 1.0 });
+			for (p, piece) in pieces.iter().enumerate().take(end.piece + 1).skip(start.piece) {
+				let t0 = if p == start.piece { start.t } else { 0.0 };
+				let t1 = if p == end.piece { end.t } else { 1.0 };
+				if t1 > t0 {
+					out.push(piece.trim(t0, t1));
+				}
+			}
+			// Join at the end of this segment
+			if let Some(join) = next_join {
+				out.extend_from_slice(&join.pieces);
+			}
+		}
+	}
+}
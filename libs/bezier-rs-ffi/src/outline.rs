@@ -0,0 +1,265 @@
+
+// Variable width outlines : both sides of a stroke offset by a width profile, joined and capped in a single pass.
+// The width varies linearly between the samples of the profile, placed over global t, arc length, or at the anchors.
+// Sides are fitted like constant offsets (see offset.rs), segments being split at their inflections and at the profile samples.
+// Inner joins go through the anchor instead of being clipped : the outlines are meant to be filled with the non-zero rule.
+
+use bezier_rs::Subpath;
+use glam::f64::DVec2;
+
+use crate::{EmptyId, bezrsCapType, bezrsJoinType, bezrsWidthMode, bezrsWidthSample};
+use crate::arclength::{self, ArcTable};
+use crate::fit::Fitter;
+use crate::multishape::MultiShapeData;
+use crate::offset::{push_arc, push_join, push_line};
+use crate::segments::{self, Bounds, Cubic};
+
+// Samples of a side, per fitted piece
+const SIDE_SAMPLES : usize = 16;
+// Subdivision depth limit when fitting sides (cusps never converge)
+const MAX_SIDE_DEPTH : u32 = 10;
+// Parameter step of the finite differences giving the end tangents of a side, relative to the piece
+const TANGENT_STEP : f64 = 1e-4;
+// Local t-values closer than this are the same split
+const T_EPSILON : f64 = 1e-9;
+
+// Half widths along a subpath
+pub(crate) struct WidthProfile {
+	mode : bezrsWidthMode,
+	samples : Vec<(f64, f64)>, // (position, half width), sorted by position. In anchor order for `PerHandle`.
+	tables : Vec<ArcTable>, // `ArcLength` only
+	starts : Vec<f64>, // Arc length before each segment (`ArcLength` only)
+	total : f64,
+	segment_count : usize,
+	closed : bool,
+}
+
+impl WidthProfile {
+
+	// None without any usable sample. Negative widths are clamped to 0.
+	pub(crate) fn new(sub_path : &Subpath<EmptyId>, mode : bezrsWidthMode, samples : &[bezrsWidthSample]) -> Option<Self> {
+		let half = |sample : &bezrsWidthSample| if sample.width > 0.0 && sample.width.is_finite() { 0.5 * sample.width } else { 0.0 };
+		let mut points : Vec<(f64, f64)> = match mode {
+			bezrsWidthMode::PerHandle => samples.iter().map(|sample| (0.0, half(sample))).collect(),
+			_ => samples.iter().filter(|sample| sample.t.is_finite()).map(|sample| (sample.t, half(sample))).collect(),
+		};
+		if points.is_empty() {
+			return None;
+		}
+		if mode != bezrsWidthMode::PerHandle {
+			points.sort_by(|a, b| a.0.total_cmp(&b.0));
+		}
+
+		let (mut tables, mut starts, mut total) = (Vec::new(), Vec::new(), 0.0);
+		if mode == bezrsWidthMode::ArcLength {
+			tables = arclength::build_tables(sub_path);
+			for table in &tables {
+				starts.push(total);
+				total += table.length();
+			}
+		}
+		Some(WidthProfile { mode, samples: points, tables, starts, total, segment_count: segments::segment_count(sub_path), closed: sub_path.closed() })
+	}
+
+	// Piecewise linear interpolation of the samples, constant beyond both ends
+	fn interpolate(&self, position : f64) -> f64 {
+		let i = self.samples.partition_point(|sample| sample.0 <= position);
+		if i == 0 {
+			return self.samples[0].1;
+		}
+		if i == self.samples.len() {
+			return self.samples[i - 1].1;
+		}
+		let ((p0, w0), (p1, w1)) = (self.samples[i - 1], self.samples[i]);
+		w0 + (w1 - w0) * (position - p0) / (p1 - p0)
+	}
+
+	// Half width at local t of a segment
+	pub(crate) fn half_width(&self, segment : usize, t : f64) -> f64 {
+		match self.mode {
+			bezrsWidthMode::PerHandle => {
+				let at = |anchor : usize| self.samples[anchor.min(self.samples.len() - 1)].1;
+				let next = if self.closed && segment + 1 == self.segment_count { 0 } else { segment + 1 };
+				at(segment) + (at(next) - at(segment)) * t
+			}
+			bezrsWidthMode::GlobalT => self.interpolate((segment as f64 + t) / self.segment_count as f64),
+			bezrsWidthMode::ArcLength => {
+				let position = if self.total > 0.0 { (self.starts[segment] + self.tables[segment].length_at_t(t)) / self.total } else { 0.0 };
+				self.interpolate(position)
+			}
+		}
+	}
+
+	// Appends the local t-values where the profile has a kink within a segment (at its samples)
+	fn push_kinks(&self, segment : usize, out : &mut Vec<f64>) {
+		let inside = |t : f64| t > T_EPSILON && t < 1.0 - T_EPSILON;
+		match self.mode {
+			bezrsWidthMode::PerHandle => {}
+			bezrsWidthMode::GlobalT => {
+				let count = self.segment_count as f64;
+				out.extend(self.samples.iter().map(|sample| sample.0 * count - segment as f64).filter(|t| inside(*t)));
+			}
+			bezrsWidthMode::ArcLength => {
+				let (start, table) = (self.starts[segment], &self.tables[segment]);
+				for sample in &self.samples {
+					let distance = sample.0 * self.total - start;
+					if distance > 0.0 && distance < table.length() {
+						let t = table.t_at_length(distance);
+						if inside(t) {
+							out.push(t);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+// Point of a side at local t : `side` 1 is right of the direction of travel (inside a clockwise shape, y down), -1 left
+fn side_point(cubic : &Cubic, profile : &WidthProfile, segment : usize, side : f64, t : f64) -> DVec2 {
+	cubic.evaluate(t) + cubic.tangent(t).perp() * (side * profile.half_width(segment, t))
+}
+
+fn fit_side(cubic : &Cubic, profile : &WidthProfile, segment : usize, side : f64, t0 : f64, t1 : f64, tolerance_sq : f64, depth : u32, fitter : &mut Fitter, points : &mut Vec<DVec2>, out : &mut Vec<Cubic>) {
+	let at = |t : f64| side_point(cubic, profile, segment, side, t);
+	points.clear();
+	points.extend((0..=SIDE_SAMPLES).map(|i| at(t0 + (t1 - t0) * i as f64 / SIDE_SAMPLES as f64)));
+	let (start, end) = (points[0], points[SIDE_SAMPLES]);
+
+	// The width changes the side's direction : end tangents from the exact side curve
+	let step = (t1 - t0) * TANGENT_STEP;
+	let (tangent_start, tangent_end) = ((at(t0 + step) - start).normalize_or_zero(), (end - at(t1 - step)).normalize_or_zero());
+	if tangent_start != DVec2::ZERO && tangent_end != DVec2::ZERO {
+		if let Some(piece) = fitter.fit_single(points, tangent_start, -tangent_end, tolerance_sq) {
+			out.push(piece);
+			return;
+		}
+	}
+	// Tiny or unfittable (around cusps) : a line is as good as it gets
+	let extent = Bounds::from_points(points);
+	if depth >= MAX_SIDE_DEPTH || (extent.max - extent.min).length_squared() <= tolerance_sq {
+		push_line(start, end, out);
+		return;
+	}
+	let mid = 0.5 * (t0 + t1);
+	fit_side(cubic, profile, segment, side, t0, mid, tolerance_sq, depth + 1, fitter, points, out);
+	fit_side(cubic, profile, segment, side, mid, t1, tolerance_sq, depth + 1, fitter, points, out);
+}
+
+// Caps the end of a stroke around `anchor`, from one side (`from`) to the other (`to`), bulging along `direction`.
+fn push_cap(cap : bezrsCapType, anchor : DVec2, from : DVec2, to : DVec2, direction : DVec2, out : &mut Vec<Cubic>) {
+	if from.distance(to) <= 1e-12 {
+		return;
+	}
+	let extent = direction * from.distance(anchor);
+	match cap {
+		bezrsCapType::Butt => push_line(from, to, out),
+		bezrsCapType::Square => {
+			push_line(from, from + extent, out);
+			push_line(from + extent, to + extent, out);
+			push_line(to + extent, to, out);
+		}
+		bezrsCapType::Round => {
+			// Two quarter turns, a half turn being ambiguous
+			push_arc(anchor, from, anchor + extent, out);
+			push_arc(anchor, anchor + extent, to, out);
+		}
+	}
+}
+
+// Chains the fitted pieces of one side, joining consecutive segments (and closing the ring of closed subpaths)
+fn chain_side(cubics : &[Cubic], pieces : &[Vec<Cubic>], side : f64, profile : &WidthProfile, join : bezrsJoinType, miter_limit : f64, closed : bool, out : &mut Vec<Cubic>) {
+	out.clear();
+	let count = cubics.len();
+	for i in 0..count {
+		out.extend_from_slice(&pieces[i]);
+		if i + 1 == count && !closed {
+			break;
+		}
+		let next = (i + 1) % count;
+		let (last, first) = match (out.last().copied(), pieces[next].first()) {
+			(Some(last), Some(first)) => (last, *first),
+			_ => continue,
+		};
+		let (end, start) = (last.p3, first.p0);
+		if end.distance(start) <= 1e-9 {
+			continue;
+		}
+		let anchor = cubics[next].p0;
+		let (tangent_in, tangent_out) = (cubics[i].tangent(1.0), cubics[next].tangent(0.0));
+		if (tangent_in.x * tangent_out.y - tangent_in.y * tangent_out.x) * side > 0.0 {
+			// Inner side : the pieces overlap, go around through the anchor
+			push_line(end, anchor, out);
+			push_line(anchor, start, out);
+		} else {
+			push_join(join, miter_limit, profile.half_width(next, 0.0), anchor, end, last.tangent(1.0), start, first.tangent(0.0), out);
+		}
+	}
+}
+
+fn reverse_chain(chain : &mut Vec<Cubic>) {
+	chain.reverse();
+	for cubic in chain.iter_mut() {
+		*cubic = Cubic { p0: cubic.p3, p1: cubic.p2, p2: cubic.p1, p3: cubic.p0 };
+	}
+}
+
+// Outlines the subpath with a width profile into `out` (which is cleared first), sides fitted within `tolerance`.
+// Open subpaths give one ring (right side, end cap, left side backwards, start cap), closed ones two rings of opposite
+// directions (right side, left side backwards). Returns the amount of paths.
+pub(crate) fn outline(sub_path : &Subpath<EmptyId>, profile : &WidthProfile, join : bezrsJoinType, miter_limit : f64, cap : bezrsCapType, tolerance : f64, out : &mut MultiShapeData) -> usize {
+	out.clear();
+	let cubics : Vec<Cubic> = segments::iter_cubics(sub_path).collect();
+	if cubics.is_empty() {
+		return 0;
+	}
+	let closed = sub_path.closed();
+	let tolerance = if tolerance > 0.0 { tolerance } else { 1e-3 };
+	let tolerance_sq = (tolerance * tolerance).max(1e-18);
+
+	// Sides of each segment, split where the curvature or the width profile change abruptly
+	let mut fitter = Fitter::default();
+	let mut points : Vec<DVec2> = Vec::new();
+	let mut cuts : Vec<f64> = Vec::new();
+	let mut sides : [Vec<Vec<Cubic>>; 2] = [Vec::with_capacity(cubics.len()), Vec::with_capacity(cubics.len())];
+	for (segment, cubic) in cubics.iter().enumerate() {
+		cuts.clear();
+		cuts.push(0.0);
+		cuts.extend(cubic.inflections());
+		profile.push_kinks(segment, &mut cuts);
+		cuts.push(1.0);
+		cuts.sort_unstable_by(|a, b| a.total_cmp(b));
+		for (pieces, side) in sides.iter_mut().zip([1.0, -1.0]) {
+			let mut side_pieces = Vec::new();
+			for range in cuts.windows(2) {
+				if range[1] - range[0] > T_EPSILON {
+					fit_side(cubic, profile, segment, side, range[0], range[1], tolerance_sq, 0, &mut fitter, &mut points, &mut side_pieces);
+				}
+			}
+			pieces.push(side_pieces);
+		}
+	}
+
+	let (mut right, mut left) = (Vec::new(), Vec::new());
+	chain_side(&cubics, &sides[0], 1.0, profile, join, miter_limit, closed, &mut right);
+	chain_side(&cubics, &sides[1], -1.0, profile, join, miter_limit, closed, &mut left);
+	reverse_chain(&mut left);
+	if right.is_empty() || left.is_empty() {
+		return 0;
+	}
+	if closed {
+		out.push_chain(&right, true);
+		out.push_chain(&left, true);
+		return out.spans.len();
+	}
+
+	let (first, last) = (&cubics[0], &cubics[cubics.len() - 1]);
+	let mut ring = right;
+	let (right_end, left_end) = (ring[ring.len() - 1].p3, left[0].p0);
+	push_cap(cap, last.p3, right_end, left_end, last.tangent(1.0), &mut ring);
+	ring.extend_from_slice(&left);
+	let (left_start, right_start) = (ring[ring.len() - 1].p3, ring[0].p0);
+	push_cap(cap, first.p0, left_start, right_start, -first.tangent(0.0), &mut ring);
+	out.push_chain(&ring, true);
+	out.spans.len()
+}
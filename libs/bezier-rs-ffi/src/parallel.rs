@@ -0,0 +1,54 @@
+
+// Minimal scoped-thread helpers, so batch operations can spread over cores without pulling in a thread pool crate.
+
+use std::ops::Range;
+use std::thread;
+
+// Number of worker threads to use for a job of `_len` items, each thread getting at least `_min_per_thread` items.
+pub(crate) fn worker_count(_len: usize, _min_per_thread: usize) -> usize {
+	let available = thread::available_parallelism().map(|n| n.get()).unwrap_or(1);
+	let wanted = _len / _min_per_thread.max(1);
+	wanted.clamp(1, available)
+}
+
+// Splits `0.._len` into contiguous ranges and runs `_job` on each of them, in parallel when the job is large enough.
+// Runs inline (no thread spawned) for small jobs.
+pub(crate) fn for_each_range<F>(_len: usize, _min_per_thread: usize, _job: F)
+where
+	F: Fn(Range<usize>) + Sync,
+{
+	let workers = worker_count(_len, _min_per_thread);
+	if workers <= 1 {
+		_job(0.._len);
+		return;
+	}
+
+	let chunk = (_len + workers - 1) / workers;
+	let job = &_job;
+	thread::scope(|scope| {
+		for w in 1..workers {
+			let start = w * chunk;
+			let end = (start + chunk).min(_len);
+			if start < end {
+				scope.spawn(move || job(start..end));
+			}
+		}
+		// Calling thread takes the first range
+		job(0..chunk.min(_len));
+	});
+}
+
+// Raw pointer wrapper, for handing out disjoint mutable accesses to worker threads.
+// Safety: the caller guarantees that threads never touch the same element.
+#[derive(Copy, Clone)]
+pub(crate) struct SharedMutPtr<T>(pub(crate) *mut T);
+unsafe impl<T> Send for SharedMutPtr<T> {}
+unsafe impl<T> Sync for SharedMutPtr<T> {}
+
+impl<T> SharedMutPtr<T> {
+	// Note: use this accessor within closures, so the whole (Sync) wrapper gets captured instead of the raw field.
+	#[inline(always)]
+	pub(crate) fn get(&self) -> *mut T {
+		self.0
+	}
+}
@@ -0,0 +1,260 @@
+
+// Prepared geometry : precomputed structure for shapes that are queried many times.
+// Segments are split into x/y-monotonic pieces, whose bounds are simply their end points,
+// then grouped into a small bounding volume tree built in path order.
+// Extrema, inflections and bounds are cached. Any mutation of the shape drops it (see `bezrsShape::mark_changed()`).
+
+use bezier_rs::Subpath;
+use glam::f64::DVec2;
+
+use crate::EmptyId;
+use crate::segments::{self, Bounds, Cubic};
+
+// Pieces per leaf node
+const LEAF_SIZE : usize = 4;
+const NO_CHILD : u32 = u32::MAX;
+
+#[derive(Debug)]
+pub(crate) struct Piece {
+	pub(crate) cubic : Cubic,
+	pub(crate) bounds : Bounds,
+	pub(crate) segment : usize,
+	pub(crate) t0 : f64,
+	pub(crate) t1 : f64,
+}
+
+#[derive(Debug)]
+struct Node {
+	bounds : Bounds,
+	start : usize,
+	end : usize,
+	left : u32,
+	right : u32,
+}
+
+#[derive(Debug)]
+pub(crate) struct Prepared {
+	pub(crate) pieces : Vec<Piece>,
+	nodes : Vec<Node>,
+	closing_line : Option<(DVec2, DVec2)>,
+	pub(crate) bounds : Option<Bounds>,
+	pub(crate) extrema : [Vec<f64>; 2],
+	pub(crate) inflections : Vec<f64>,
+}
+
+impl Prepared {
+
+	pub(crate) fn new(sub_path : &Subpath<EmptyId>) -> Self {
+		let segment_count = segments::segment_count(sub_path);
+		let to_global = |segment : usize, t : f64| (segment as f64 + t) / segment_count as f64;
+
+		let mut pieces : Vec<Piece> = Vec::new();
+		let mut extrema : [Vec<f64>; 2] = [Vec::new(), Vec::new()];
+		let mut inflections : Vec<f64> = Vec::new();
+		let mut splits : Vec<f64> = Vec::new();
+		for (segment, cubic) in segments::iter_cubics(sub_path).enumerate() {
+			let [x_extrema, y_extrema] = cubic.extrema();
+			inflections.extend(cubic.inflections().iter().map(|t| to_global(segment, *t)));
+
+			// Monotonic pieces
+			splits.clear();
+			splits.push(0.0);
+			splits.extend(x_extrema.iter().chain(y_extrema.iter()));
+			splits.push(1.0);
+			splits.sort_unstable_by(|a, b| a.total_cmp(b));
+			splits.dedup_by(|a, b| (*a - *b).abs() < 1e-12);
+			for range in splits.windows(2) {
+				let piece = cubic.trim(range[0], range[1]);
+				pieces.push(Piece {
+					cubic: piece,
+					bounds: Bounds::from_points(&[piece.p0, piece.p3]),
+					segment,
+					t0: range[0],
+					t1: range[1],
+				});
+			}
+
+			extrema[0].extend(x_extrema.iter().map(|t| to_global(segment, *t)));
+			extrema[1].extend(y_extrema.iter().map(|t| to_global(segment, *t)));
+		}
+
+		// Open paths are implicitly closed for containment
+		let closing_line = match (sub_path.closed(), pieces.first(), pieces.last()) {
+			(false, Some(first), Some(last)) => Some((last.cubic.p3, first.cubic.p0)),
+			_ => None,
+		};
+
+		let mut prepared = Prepared { pieces, nodes: Vec::new(), closing_line, bounds: None, extrema, inflections };
+		if !prepared.pieces.is_empty() {
+			prepared.build_node(0, prepared.pieces.len());
+			prepared.bounds = Some(prepared.nodes[0].bounds);
+		}
+		prepared
+	}
+
+	// Builds the tree over pieces[start..end], in path order (consecutive pieces are spatially close). Returns the node index.
+	fn build_node(&mut self, start : usize, end : usize) -> u32 {
+		let index = self.nodes.len();
+		let bounds = self.pieces[start + 1..end].iter().fold(self.pieces[start].bounds, |b, piece| b.union(&piece.bounds));
+		self.nodes.push(Node { bounds, start, end, left: NO_CHILD, right: NO_CHILD });
+		if end - start > LEAF_SIZE {
+			let mid = start + (end - start) / 2;
+			let left = self.build_node(start, mid);
+			let right = self.build_node(mid, end);
+			self.nodes[index].left = left;
+			self.nodes[index].right = right;
+		}
+		index as u32
+	}
+
+	pub(crate) fn bounding_box(&self) -> Option<[DVec2; 2]> {
+		self.bounds.map(|b| [b.min, b.max])
+	}
+
+	// Non-zero winding containment
+	pub(crate) fn contains_point(&self, p : DVec2) -> bool {
+		self.winding(p) != 0
+	}
+
+	// Winding number around a point, casting a ray towards +x.
+	pub(crate) fn winding(&self, p : DVec2) -> i32 {
+		let mut winding = 0;
+		if self.nodes.is_empty() {
+			return 0;
+		}
+		let mut stack : Vec<u32> = vec![0];
+		while let Some(index) = stack.pop() {
+			let node = &self.nodes[index as usize];
+			if node.bounds.min.y > p.y || node.bounds.max.y < p.y || node.bounds.max.x < p.x {
+				continue;
+			}
+			if node.left != NO_CHILD {
+				stack.push(node.left);
+				stack.push(node.right);
+				continue;
+			}
+			for piece in &self.pieces[node.start..node.end] {
+				winding += piece_winding(piece, p);
+			}
+		}
+		if let Some((a, b)) = self.closing_line {
+			if (a.y <= p.y) != (b.y <= p.y) && a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y) > p.x {
+				winding += if b.y > a.y { 1 } else { -1 };
+			}
+		}
+		winding
+	}
+
+	// Indices of the pieces whose bounds overlap `bounds`, in path order.
+	pub(crate) fn pieces_overlapping(&self, bounds : &Bounds, out : &mut Vec<usize>) {
+		out.clear();
+		if self.nodes.is_empty() {
+			return;
+		}
+		let mut stack : Vec<u32> = vec![0];
+		while let Some(index) = stack.pop() {
+			let node = &self.nodes[index as usize];
+			if !node.bounds.overlaps(bounds) {
+				continue;
+			}
+			if node.left != NO_CHILD {
+				// Left first (pushed last), keeping path order
+				stack.push(node.right);
+				stack.push(node.left);
+				continue;
+			}
+			out.extend((node.start..node.end).filter(|i| self.pieces[*i].bounds.overlaps(bounds)));
+		}
+	}
+
+	// Closest point on the shape, as (segment index, local t).
+	pub(crate) fn project(&self, p : DVec2) -> Option<(usize, f64)> {
+		if self.nodes.is_empty() {
+			return None;
+		}
+		let mut best = (f64::INFINITY, 0, 0.0);
+		let mut stack : Vec<u32> = vec![0];
+		while let Some(index) = stack.pop() {
+			let node = &self.nodes[index as usize];
+			if node.bounds.distance_to_point(p) >= best.0 {
+				continue;
+			}
+			if node.left != NO_CHILD {
+				// Visit the closest child first (pushed last)
+				let (l, r) = (&self.nodes[node.left as usize], &self.nodes[node.right as usize]);
+				if l.bounds.distance_to_point(p) < r.bounds.distance_to_point(p) {
+					stack.push(node.right);
+					stack.push(node.left);
+				} else {
+					stack.push(node.left);
+					stack.push(node.right);
+				}
+				continue;
+			}
+			for piece in &self.pieces[node.start..node.end] {
+				if piece.bounds.distance_to_point(p) >= best.0 {
+					continue;
+				}
+				let (distance, t) = project_on_cubic(&piece.cubic, p);
+				if distance < best.0 {
+					best = (distance, piece.segment, piece.t0 + t * (piece.t1 - piece.t0));
+				}
+			}
+		}
+		Some((best.1, best.2))
+	}
+}
+
+// Crossing of a +x ray with a monotonic piece (-1, 0 or 1), using the half-open rule on end points.
+fn piece_winding(piece : &Piece, p : DVec2) -> i32 {
+	let (y0, y1) = (piece.cubic.p0.y, piece.cubic.p3.y);
+	if (y0 <= p.y) == (y1 <= p.y) || piece.bounds.max.x <= p.x {
+		return 0;
+	}
+	let direction = if y1 > y0 { 1 } else { -1 };
+	if piece.bounds.min.x > p.x {
+		return direction;
+	}
+
+	// y is monotonic on the piece : find the single t where it reaches p.y
+	let (mut lo, mut hi) = (0.0, 1.0);
+	let increasing = y1 > y0;
+	for _ in 0..48 {
+		let mid = 0.5 * (lo + hi);
+		if (piece.cubic.evaluate(mid).y < p.y) == increasing {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	if piece.cubic.evaluate(0.5 * (lo + hi)).x > p.x { direction } else { 0 }
+}
+
+// Closest point on a cubic : coarse sampling then Newton refinement. Returns (distance, t).
+pub(crate) fn project_on_cubic(cubic : &Cubic, p : DVec2) -> (f64, f64) {
+	const SAMPLES : usize = 8;
+	let mut best = (f64::INFINITY, 0.0);
+	for i in 0..=SAMPLES {
+		let t = i as f64 / SAMPLES as f64;
+		let d = cubic.evaluate(t).distance_squared(p);
+		if d < best.0 {
+			best = (d, t);
+		}
+	}
+	let mut t = best.1;
+	for _ in 0..6 {
+		let offset = cubic.evaluate(t) - p;
+		let d1 = cubic.derivative(t);
+		let numerator = offset.dot(d1);
+		let denominator = d1.dot(d1) + offset.dot(cubic.second_derivative(t));
+		if denominator.abs() <= 1e-18 {
+			break;
+		}
+		t = (t - numerator / denominator).clamp(0.0, 1.0);
+	}
+	let refined = cubic.evaluate(t).distance_squared(p);
+	if refined < best.0 {
+		best = (refined, t);
+	}
+	(best.0.sqrt(), best.1)
+}
@@ -0,0 +1,306 @@
+
+// Anti-aliased coverage mask rasterisation (signed area accumulation, as in font-rs).
+// Every flattened line deposits its signed area contribution in an accumulation buffer,
+// then a prefix sum per row turns it into winding coverage.
+// The mask is rendered in horizontal bands, spread over threads, each thread having its own accumulation buffer.
+
+use bezier_rs::Subpath;
+use glam::f64::DVec2;
+
+use crate::{EmptyId, bezrsAffine, bezrsFillRule};
+use crate::affine::AffineKernel;
+use crate::flatten;
+use crate::parallel::{self, SharedMutPtr};
+use crate::segments::{self, Cubic};
+use crate::sdf::invert;
+
+// Rows per band
+const BAND : usize = 32;
+// Flattening tolerance, in pixels
+const TOLERANCE : f64 = 0.05;
+
+#[derive(Debug, Copy, Clone)]
+struct Line {
+	p0 : (f32, f32),
+	p1 : (f32, f32),
+}
+
+// Accumulation buffer of a band : `rows` rows of `width + 2` cells (the extra cells collect what lies right of the mask).
+struct Accumulator {
+	cells : Vec<f32>,
+	width : usize,
+	stride : usize,
+	y0 : usize,
+	rows : usize,
+}
+
+impl Accumulator {
+
+	fn new(width : usize) -> Self {
+		Accumulator { cells: vec![0.0; (width + 2) * BAND], width, stride: width + 2, y0: 0, rows: 0 }
+	}
+
+	fn reset(&mut self, y0 : usize, rows : usize) {
+		self.y0 = y0;
+		self.rows = rows;
+		self.cells[..self.stride * rows].fill(0.0);
+	}
+
+	// Clips the line horizontally to [0, width] : parts left of the mask become vertical lines at x=0 (full coverage to the right),
+	// parts right of it become vertical lines at x=width (collected in the extra cells).
+	fn add_line(&mut self, line : &Line) {
+		let ((x0, y0), (x1, y1)) = (line.p0, line.p1);
+		let w = self.width as f32;
+		let mut cuts = [(x0, y0), (0.0, 0.0), (0.0, 0.0), (x1, y1)];
+		let mut count = 1;
+		let mut split_at = [0.0f32, w];
+		if x1 < x0 {
+			split_at.swap(0, 1);
+		}
+		for x in split_at {
+			if (x0 < x && x < x1) || (x1 < x && x < x0) {
+				let t = (x - x0) / (x1 - x0);
+				cuts[count] = (x, y0 + (y1 - y0) * t);
+				count += 1;
+			}
+		}
+		cuts[count] = (x1, y1);
+		for i in 0..count {
+			let (a, b) = (cuts[i], cuts[i + 1]);
+			let clamp = |p : (f32, f32)| (p.0.clamp(0.0, w), p.1);
+			self.add_clipped_line(clamp(a), clamp(b));
+		}
+	}
+
+	fn add_clipped_line(&mut self, p0 : (f32, f32), p1 : (f32, f32)) {
+		if (p0.1 - p1.1).abs() <= f32::EPSILON {
+			return;
+		}
+		let (dir, p0, p1) = if p0.1 < p1.1 { (1.0f32, p0, p1) } else { (-1.0f32, p1, p0) };
+		let band_top = self.y0 as f32;
+		let band_bottom = (self.y0 + self.rows) as f32;
+		if p1.1 <= band_top || p0.1 >= band_bottom {
+			return;
+		}
+		let dxdy = (p1.0 - p0.0) / (p1.1 - p0.1);
+		let start_y = p0.1.max(band_top);
+		let mut x = p0.0 + (start_y - p0.1) * dxdy;
+		let row_start = start_y.floor() as usize;
+		let row_end = (p1.1.ceil() as usize).min(self.y0 + self.rows);
+
+		for y in row_start..row_end {
+			let line_start = (y - self.y0) * self.stride;
+			let dy = ((y + 1) as f32).min(p1.1) - (y as f32).max(start_y);
+			let x_next = x + dxdy * dy;
+			let d = dy * dir;
+			let (xa, xb) = if x < x_next { (x, x_next) } else { (x_next, x) };
+			let xa_floor = xa.floor();
+			let xa_i = xa_floor as usize;
+			let xb_ceil = xb.ceil();
+			let xb_i = xb_ceil as usize;
+			let cells = &mut self.cells[line_start..line_start + self.stride];
+
+			if xb_i <= xa_i + 1 {
+				// Line within a single cell
+				let xmf = 0.5 * (x + x_next) - xa_floor;
+				cells[xa_i] += d - d * xmf;
+				cells[xa_i + 1] += d * xmf;
+			} else {
+				// Spread over several cells
+				let s = (xb - xa).recip();
+				let xa_f = xa - xa_floor;
+				let a0 = 0.5 * s * (1.0 - xa_f) * (1.0 - xa_f);
+				let xb_f = xb - xb_ceil + 1.0;
+				let am = 0.5 * s * xb_f * xb_f;
+				cells[xa_i] += d * a0;
+				if xb_i == xa_i + 2 {
+					cells[xa_i + 1] += d * (1.0 - a0 - am);
+				} else {
+					let a1 = s * (1.5 - xa_f);
+					cells[xa_i + 1] += d * (a1 - a0);
+					for cell in &mut cells[xa_i + 2..xb_i - 1] {
+						*cell += d * s;
+					}
+					let a2 = a1 + (xb_i - xa_i - 3) as f32 * s;
+					cells[xb_i - 1] += d * (1.0 - a2 - am);
+				}
+				cells[xb_i] += d * am;
+			}
+			x = x_next;
+		}
+	}
+}
+
+#[inline(always)]
+fn coverage(winding : f32, fill_rule : &bezrsFillRule) -> f32 {
+	let w = winding.abs();
+	match fill_rule {
+		bezrsFillRule::NonZero => w.min(1.0),
+		bezrsFillRule::EvenOdd => {
+			let m = w - 2.0 * (w * 0.5).floor();
+			1.0 - (1.0 - m).abs()
+		}
+	}
+}
+
+// Prefix sum of a row of cells into 8-bit coverage
+#[cfg(target_arch = "x86_64")]
+fn accumulate_row(cells : &[f32], out : &mut [u8], fill_rule : &bezrsFillRule) {
+	use std::arch::x86_64::*;
+
+	let width = out.len();
+	let simd_width = width & !3;
+	let mut acc = 0.0f32;
+	unsafe {
+		let mut carry = _mm_setzero_ps();
+		let scale = _mm_set1_ps(255.0);
+		let one = _mm_set1_ps(1.0);
+		let half = _mm_set1_ps(0.5);
+		let two = _mm_set1_ps(2.0);
+		let sign_mask = _mm_set1_ps(-0.0);
+		let mut i = 0;
+		while i < simd_width {
+			// Prefix sum within the 4 lanes, plus the carry from the previous ones
+			let mut x = _mm_loadu_ps(cells.as_ptr().add(i));
+			x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128::<4>(_mm_castps_si128(x))));
+			x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128::<8>(_mm_castps_si128(x))));
+			x = _mm_add_ps(x, carry);
+			carry = _mm_shuffle_ps::<0xFF>(x, x);
+
+			let w = _mm_andnot_ps(sign_mask, x);
+			let c = match fill_rule {
+				bezrsFillRule::NonZero => _mm_min_ps(w, one),
+				bezrsFillRule::EvenOdd => {
+					// Truncation is a floor for positive values
+					let halves = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(w, half)));
+					let m = _mm_sub_ps(w, _mm_mul_ps(two, halves));
+					_mm_sub_ps(one, _mm_andnot_ps(sign_mask, _mm_sub_ps(one, m)))
+				}
+			};
+			let c = _mm_cvtps_epi32(_mm_mul_ps(c, scale));
+			let packed = _mm_packus_epi16(_mm_packs_epi32(c, c), _mm_setzero_si128());
+			let bytes = (_mm_cvtsi128_si32(packed) as u32).to_le_bytes();
+			out[i..i + 4].copy_from_slice(&bytes);
+			i += 4;
+		}
+		if simd_width > 0 {
+			acc = _mm_cvtss_f32(carry);
+		}
+	}
+	for i in simd_width..width {
+		acc += cells[i];
+		out[i] = (coverage(acc, fill_rule) * 255.0 + 0.5) as u8;
+	}
+}
+
+#[cfg(not(target_arch = "x86_64"))]
+fn accumulate_row(cells : &[f32], out : &mut [u8], fill_rule : &bezrsFillRule) {
+	let mut acc = 0.0f32;
+	for (cell, o) in cells.iter().zip(out.iter_mut()) {
+		acc += cell;
+		*o = (coverage(acc, fill_rule) * 255.0 + 0.5) as u8;
+	}
+}
+
+// Renders the coverage of the subpath into `out` (`height` rows of `stride` bytes, `width` used).
+// `grid_to_shape` maps pixel coordinates to shape coordinates. Paths are implicitly closed.
+pub(crate) fn rasterize(sub_path : &Subpath<EmptyId>, out : &mut [u8], width : usize, height : usize, stride : usize, grid_to_shape : &bezrsAffine, fill_rule : bezrsFillRule) -> bool {
+	if width == 0 || height == 0 || stride < width {
+		return false;
+	}
+	let len = stride.checked_mul(height - 1).and_then(|rows| rows.checked_add(width));
+	if len.map_or(true, |len| out.len() < len) {
+		return false;
+	}
+	let shape_to_grid = match invert(grid_to_shape) {
+		Some(m) => m,
+		None => return false,
+	};
+
+	// Flatten in grid space, where the tolerance is in pixels
+	let to_grid = AffineKernel::new(&shape_to_grid);
+	let mut points : Vec<DVec2> = Vec::new();
+	for cubic in segments::iter_cubics(sub_path) {
+		let grid_cubic = Cubic { p0: to_grid.apply(cubic.p0), p1: to_grid.apply(cubic.p1), p2: to_grid.apply(cubic.p2), p3: to_grid.apply(cubic.p3) };
+		if points.is_empty() {
+			points.push(grid_cubic.p0);
+		}
+		flatten::flatten_cubic_into(&grid_cubic, TOLERANCE, &mut points);
+	}
+	let mut lines : Vec<Line> = points.windows(2)
+		.map(|p| Line { p0: (p[0].x as f32, p[0].y as f32), p1: (p[1].x as f32, p[1].y as f32) })
+		.collect();
+	if points.len() > 2 {
+		let (first, last) = (points[0], points[points.len() - 1]);
+		lines.push(Line { p0: (last.x as f32, last.y as f32), p1: (first.x as f32, first.y as f32) });
+	}
+
+	let bands = (height + BAND - 1) / BAND;
+	let out_ptr = SharedMutPtr(out.as_mut_ptr());
+	let lines = &lines;
+	let fill_rule = &fill_rule;
+
+	parallel::for_each_range(bands, 2, |range| {
+		let mut accumulator = Accumulator::new(width);
+		for band in range {
+			let y0 = band * BAND;
+			let rows = BAND.min(height - y0);
+			accumulator.reset(y0, rows);
+			for line in lines.iter() {
+				accumulator.add_line(line);
+			}
+			for r in 0..rows {
+				let row = unsafe { std::slice::from_raw_parts_mut(out_ptr.get().add((y0 + r) * stride), width) };
+				accumulate_row(&accumulator.cells[r * accumulator.stride..r * accumulator.stride + width], row, fill_rule);
+			}
+		}
+	});
+
+	true
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use bezier_rs::ManipulatorGroup;
+	use std::f64::consts::PI;
+	use crate::sdf::tests::circle;
+
+	const IDENTITY : bezrsAffine = bezrsAffine { a: 1.0, b: 0.0, c: 0.0, d: 1.0, tx: 0.0, ty: 0.0 };
+
+	fn rect(min : DVec2, max : DVec2) -> Subpath<EmptyId> {
+		let corners = [min, DVec2::new(max.x, min.y), max, DVec2::new(min.x, max.y)];
+		let groups = corners.iter().map(|&anchor| ManipulatorGroup { anchor, in_handle: None, out_handle: None, id: EmptyId }).collect();
+		Subpath::new(groups, true)
+	}
+
+	// Summed coverage, in pixels
+	fn covered_area(sub_path : &Subpath<EmptyId>, size : usize, fill_rule : bezrsFillRule) -> f64 {
+		let mut mask = vec![0u8; size * size];
+		assert!(rasterize(sub_path, &mut mask, size, size, size, &IDENTITY, fill_rule));
+		mask.iter().map(|&c| c as f64 / 255.0).sum()
+	}
+
+	// Coverage sums to the analytic area, within the 8 bit rounding of the edge pixels.
+	// Curves also lose the area between the flattened chords and the arc : at most `TOLERANCE` along the perimeter.
+	#[test]
+	fn coverage_matches_area() {
+		let (min, max) = (DVec2::new(10.3, 20.6), DVec2::new(117.8, 61.1));
+		let (center, radius) = (DVec2::new(64.4, 63.7), 40.0);
+		for fill_rule in [bezrsFillRule::NonZero, bezrsFillRule::EvenOdd] {
+			let area = covered_area(&rect(min, max), 128, fill_rule);
+			let (size, expected) = (max - min, (max.x - min.x) * (max.y - min.y));
+			assert!((area - expected).abs() < 2.0 * (size.x + size.y) / 255.0, "rect {:?} : {} vs {}", fill_rule, area, expected);
+
+			let area = covered_area(&circle(center, radius, 16), 128, fill_rule);
+			let expected = PI * radius * radius;
+			assert!((area - expected).abs() < 2.0 * PI * radius * (TOLERANCE + 1.0 / 255.0), "circle {:?} : {} vs {}", fill_rule, area, expected);
+		}
+	}
+
+	#[test]
+	fn overflowing_sizes_fail() {
+		let mut mask = vec![0u8; 16];
+		assert!(!rasterize(&rect(DVec2::ZERO, DVec2::ONE), &mut mask, 4, 3, usize::MAX, &IDENTITY, bezrsFillRule::NonZero));
+	}
+}
@@ -0,0 +1,281 @@
+
+// Signed distance field rasterisation.
+// The shape is flattened once, then the grid is split into tiles, recursively : each sub-tile only keeps the lines of its parent
+// that can be the closest ones, so leaf tiles test a handful of lines per pixel.
+// Sign is resolved per row with a non-zero winding scanline, distances are measured in shape units.
+
+use bezier_rs::Subpath;
+use glam::f64::DVec2;
+
+use crate::{EmptyId, bezrsAffine};
+use crate::affine::AffineKernel;
+use crate::flatten;
+use crate::parallel::{self, SharedMutPtr};
+use crate::segments::{self, Bounds};
+
+// Tile sizes in pixels : top level tiles are split in 4 down to leaf tiles
+const TILE : usize = 64;
+const LEAF_TILE : usize = 8;
+const TILE_LEVELS : usize = 4; // 64, 32, 16, 8
+
+// Flattened line, with the inverse squared length precomputed for the per-pixel queries
+#[derive(Copy, Clone)]
+struct Line {
+	a : DVec2,
+	ab : DVec2,
+	inv_length_sq : f64, // 0 for degenerate lines
+	bounds : Bounds,
+}
+
+impl Line {
+	fn new(a : DVec2, b : DVec2) -> Self {
+		let ab = b - a;
+		let length_sq = ab.length_squared();
+		Line { a, ab, inv_length_sq: if length_sq > 0.0 { 1.0 / length_sq } else { 0.0 }, bounds: Bounds { min: a.min(b), max: a.max(b) } }
+	}
+
+	#[inline(always)]
+	fn distance_squared(&self, p : DVec2) -> f64 {
+		let t = ((p - self.a).dot(self.ab) * self.inv_length_sq).clamp(0.0, 1.0);
+		(self.a + self.ab * t - p).length_squared()
+	}
+}
+
+// Inverse of an affine matrix, if invertible
+pub(crate) fn invert(m : &bezrsAffine) -> Option<bezrsAffine> {
+	let det = m.a * m.d - m.b * m.c;
+	if det.abs() <= 1e-300 || !det.is_finite() {
+		return None;
+	}
+	let inv = 1.0 / det;
+	Some(bezrsAffine {
+		a: m.d * inv,
+		b: -m.b * inv,
+		c: -m.c * inv,
+		d: m.a * inv,
+		tx: (m.c * m.ty - m.d * m.tx) * inv,
+		ty: (m.b * m.tx - m.a * m.ty) * inv,
+	})
+}
+
+// Non-zero winding coverage of one pixel row (centers at y), written as -1 (inside) or 1 (outside) into `signs`.
+pub(crate) fn row_signs(grid_edges : &[(DVec2, DVec2)], y : f64, crossings : &mut Vec<(f64, i32)>, signs : &mut [f32]) {
+	crossings.clear();
+	for (a, b) in grid_edges {
+		if (a.y <= y) != (b.y <= y) {
+			let x = a.x + (y - a.y) * (b.x - a.x) / (b.y - a.y);
+			crossings.push((x, if b.y > a.y { 1 } else { -1 }));
+		}
+	}
+	crossings.sort_unstable_by(|l, r| l.0.total_cmp(&r.0));
+
+	let mut winding = 0;
+	let mut next = 0;
+	for (x, sign) in signs.iter_mut().enumerate() {
+		let center = x as f64 + 0.5;
+		while next < crossings.len() && crossings[next].0 <= center {
+			winding += crossings[next].1;
+			next += 1;
+		}
+		*sign = if winding != 0 { -1.0 } else { 1.0 };
+	}
+}
+
+// Distance pass over the tile hierarchy, shared by all worker threads
+struct DistanceGrid {
+	to_shape : AffineKernel,
+	width : usize,
+	height : usize,
+	max_distance : f64,
+	out : SharedMutPtr<f32>,
+}
+
+impl DistanceGrid {
+	// Multiplies the signs already stored in the tile at (x0, y0) by the distances.
+	// `parent` holds every line that can be the closest one to a pixel in this tile, `levels` are scratch buffers for this tile and its children.
+	fn fill_tile(&self, x0 : usize, y0 : usize, size : usize, parent : &[Line], levels : &mut [Vec<Line>]) {
+		let (x1, y1) = ((x0 + size).min(self.width), (y0 + size).min(self.height));
+		if x0 >= x1 || y0 >= y1 {
+			return;
+		}
+
+		// Tile footprint in shape space (pixel centers)
+		let corners = [
+			self.to_shape.apply(DVec2::new(x0 as f64 + 0.5, y0 as f64 + 0.5)),
+			self.to_shape.apply(DVec2::new(x1 as f64 - 0.5, y0 as f64 + 0.5)),
+			self.to_shape.apply(DVec2::new(x0 as f64 + 0.5, y1 as f64 - 0.5)),
+			self.to_shape.apply(DVec2::new(x1 as f64 - 0.5, y1 as f64 - 0.5)),
+		];
+		let tile_bounds = Bounds::from_points(&corners);
+		let center = (tile_bounds.min + tile_bounds.max) * 0.5;
+		let half_diagonal = (tile_bounds.max - center).length();
+
+		// Upper bound of the distance of any pixel in the tile : closest line to the tile center + half diagonal.
+		// The closest line of any point in the tile is within the parent's reach, so it's in `parent`.
+		let mut center_best = f64::INFINITY;
+		for line in parent.iter() {
+			center_best = center_best.min(line.distance_squared(center));
+		}
+		let reach = (center_best.sqrt() + half_diagonal).min(self.max_distance);
+
+		// Only keep the lines that can be within reach
+		let (candidates, children) = levels.split_first_mut().unwrap();
+		candidates.clear();
+		for line in parent.iter() {
+			if line.bounds.distance_to_bounds(&tile_bounds) <= reach {
+				candidates.push(*line);
+			}
+		}
+
+		if size > LEAF_TILE && !children.is_empty() {
+			let half = size / 2;
+			for (cx, cy) in [(x0, y0), (x0 + half, y0), (x0, y0 + half), (x0 + half, y0 + half)] {
+				self.fill_tile(cx, cy, half, candidates, children);
+			}
+			return;
+		}
+
+		let reach_sq = reach * reach;
+		for y in y0..y1 {
+			let row = unsafe { std::slice::from_raw_parts_mut(self.out.get().add(y * self.width), self.width) };
+			for x in x0..x1 {
+				let p = self.to_shape.apply(DVec2::new(x as f64 + 0.5, y as f64 + 0.5));
+				let mut best = reach_sq;
+				for line in candidates.iter() {
+					best = best.min(line.distance_squared(p));
+				}
+				row[x] *= best.sqrt().min(self.max_distance) as f32;
+			}
+		}
+	}
+}
+
+// Fills `out` (row-major, `width` x `height`) with signed distances : negative inside, positive outside.
+// `grid_to_shape` maps pixel coordinates to shape coordinates (pixel centers are at +0.5).
+// Distances are clamped to `max_distance` when it's positive.
+pub(crate) fn rasterize(sub_path : &Subpath<EmptyId>, out : &mut [f32], width : usize, height : usize, grid_to_shape : &bezrsAffine, max_distance : f64) -> bool {
+	if width == 0 || height == 0 || width.checked_mul(height).map_or(true, |len| out.len() < len) {
+		return false;
+	}
+	let shape_to_grid = match invert(grid_to_shape) {
+		Some(m) => m,
+		None => return false,
+	};
+	let max_distance = if max_distance > 0.0 { max_distance } else { f64::INFINITY };
+
+	// Flatten with a fraction of the pixel size
+	let pixel_size = (grid_to_shape.a * grid_to_shape.d - grid_to_shape.b * grid_to_shape.c).abs().sqrt();
+	let tolerance = pixel_size * 0.05;
+	let mut points : Vec<DVec2> = Vec::new();
+	let mut lines : Vec<Line> = Vec::new();
+	for cubic in segments::iter_cubics(sub_path) {
+		points.clear();
+		points.push(cubic.p0);
+		flatten::flatten_cubic_into(&cubic, tolerance, &mut points);
+		lines.extend(points.windows(2).map(|w| Line::new(w[0], w[1])));
+	}
+	if lines.is_empty() {
+		out[..width * height].fill(max_distance as f32);
+		return true;
+	}
+
+	// Edges in grid space for the sign scanlines, implicitly closed
+	let to_grid = AffineKernel::new(&shape_to_grid);
+	let mut grid_edges : Vec<(DVec2, DVec2)> = lines.iter().map(|line| (to_grid.apply(line.a), to_grid.apply(line.a + line.ab))).collect();
+	if !sub_path.closed() {
+		let last = &lines[lines.len() - 1];
+		grid_edges.push((to_grid.apply(last.a + last.ab), to_grid.apply(lines[0].a)));
+	}
+
+	let grid = DistanceGrid {
+		to_shape: AffineKernel::new(grid_to_shape),
+		width,
+		height,
+		max_distance,
+		out: SharedMutPtr(out.as_mut_ptr()),
+	};
+	let tile_rows = (height + TILE - 1) / TILE;
+	let (grid, lines, grid_edges) = (&grid, &lines, &grid_edges);
+
+	parallel::for_each_range(tile_rows, 1, |range| {
+		let mut crossings : Vec<(f64, i32)> = Vec::new();
+		let mut levels : Vec<Vec<Line>> = vec![Vec::new(); TILE_LEVELS];
+		let mut signs : Vec<f32> = vec![0.0; width];
+		for tile_row in range {
+			let y0 = tile_row * TILE;
+			let y1 = (y0 + TILE).min(height);
+
+			// Signs first, stored in the output rows
+			for y in y0..y1 {
+				let row = unsafe { std::slice::from_raw_parts_mut(grid.out.get().add(y * width), width) };
+				row_signs(grid_edges, y as f64 + 0.5, &mut crossings, &mut signs);
+				row.copy_from_slice(&signs);
+			}
+
+			for x0 in (0..width).step_by(TILE) {
+				grid.fill_tile(x0, y0, TILE, lines, &mut levels);
+			}
+		}
+	});
+
+	true
+}
+
+#[cfg(test)]
+pub(crate) mod tests {
+	use super::*;
+	use bezier_rs::ManipulatorGroup;
+	use std::f64::consts::TAU;
+
+	const IDENTITY : bezrsAffine = bezrsAffine { a: 1.0, b: 0.0, c: 0.0, d: 1.0, tx: 0.0, ty: 0.0 };
+
+	// Circle made of `count` cubic segments
+	pub(crate) fn circle(center : DVec2, radius : f64, count : usize) -> Subpath<EmptyId> {
+		let k = 4.0 / 3.0 * (TAU / (4.0 * count as f64)).tan() * radius;
+		let groups = (0..count).map(|i| {
+			let (s, c) = (i as f64 / count as f64 * TAU).sin_cos();
+			let (anchor, tangent) = (center + DVec2::new(c, s) * radius, DVec2::new(-s, c) * k);
+			ManipulatorGroup { anchor, in_handle: Some(anchor - tangent), out_handle: Some(anchor + tangent), id: EmptyId }
+		}).collect();
+		Subpath::new(groups, true)
+	}
+
+	#[test]
+	fn circle_distances() {
+		let (center, radius, size) = (DVec2::splat(128.0), 100.0, 256);
+		let mut field = vec![0.0f32; size * size];
+		for max_distance in [0.0, 8.0] {
+			assert!(rasterize(&circle(center, radius, 32), &mut field, size, size, &IDENTITY, max_distance));
+			for (i, &d) in field.iter().enumerate() {
+				let p = DVec2::new((i % size) as f64 + 0.5, (i / size) as f64 + 0.5);
+				let mut expected = (p - center).length() - radius;
+				if max_distance > 0.0 {
+					expected = expected.clamp(-max_distance, max_distance);
+				}
+				assert!((d as f64 - expected).abs() < 0.05, "{:?} : {} vs {}", p, d, expected);
+			}
+		}
+	}
+
+	#[test]
+	fn overflowing_sizes_fail() {
+		let mut field = vec![0.0f32; 16];
+		assert!(!rasterize(&circle(DVec2::splat(2.0), 1.0, 8), &mut field, usize::MAX, 2, &IDENTITY, 0.0));
+	}
+
+	// 1024x1024 field of a 200 segments shape : cargo test --release -- --ignored --nocapture
+	#[test]
+	#[ignore]
+	fn bench_1024() {
+		let sub_path = circle(DVec2::splat(512.0), 400.0, 200);
+		let mut field = vec![0.0f32; 1024 * 1024];
+		for max_distance in [0.0, 16.0] {
+			let start = std::time::Instant::now();
+			let runs = 10;
+			for _ in 0..runs {
+				rasterize(&sub_path, &mut field, 1024, 1024, &IDENTITY, max_distance);
+			}
+			println!("sdf 1024x1024, 200 segments, max distance {} : {:?} per field", max_distance, start.elapsed() / runs);
+		}
+	}
+}
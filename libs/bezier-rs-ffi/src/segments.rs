@@ -0,0 +1,295 @@
+
+// Internal cubic segment representation, shared by the geometry kernels.
+// Segments are extracted from the subpath's manipulator groups, following bezier-rs's conventions :
+// - both handles set : cubic segment
+// - one handle set : quadratic segment (elevated to a cubic)
+// - no handles : linear segment (elevated to a cubic, keeping a uniform parametrisation)
+
+use bezier_rs::{Subpath, ManipulatorGroup};
+use glam::f64::DVec2;
+
+use crate::EmptyId;
+
+// 5-point Gauss-Legendre quadrature on [0,1]
+const GAUSS_T : [f64; 5] = [0.046910077030668, 0.230765344947158, 0.5, 0.769234655052842, 0.953089922969332];
+const GAUSS_W : [f64; 5] = [0.118463442528095, 0.239314335249683, 0.284444444444444, 0.239314335249683, 0.118463442528095];
+
+// Axis aligned bounds
+#[derive(Debug, Copy, Clone)]
+pub(crate) struct Bounds {
+	pub(crate) min : DVec2,
+	pub(crate) max : DVec2,
+}
+
+impl Bounds {
+
+	pub(crate) fn from_points(points : &[DVec2]) -> Self {
+		let mut bounds = Bounds { min: points[0], max: points[0] };
+		for p in &points[1..] {
+			bounds.min = bounds.min.min(*p);
+			bounds.max = bounds.max.max(*p);
+		}
+		bounds
+	}
+
+	pub(crate) fn union(&self, other : &Bounds) -> Bounds {
+		Bounds { min: self.min.min(other.min), max: self.max.max(other.max) }
+	}
+
+	pub(crate) fn distance_to_point(&self, p : DVec2) -> f64 {
+		let d = (self.min - p).max(p - self.max).max(DVec2::ZERO);
+		d.length()
+	}
+
+	pub(crate) fn distance_to_bounds(&self, other : &Bounds) -> f64 {
+		let d = (self.min - other.max).max(other.min - self.max).max(DVec2::ZERO);
+		d.length()
+	}
+
+	// Closed intervals : touching bounds overlap
+	pub(crate) fn overlaps(&self, other : &Bounds) -> bool {
+		self.min.x <= other.max.x && self.min.y <= other.max.y && other.min.x <= self.max.x && other.min.y <= self.max.y
+	}
+
+	pub(crate) fn contains(&self, other : &Bounds) -> bool {
+		self.min.x <= other.min.x && self.min.y <= other.min.y && other.max.x <= self.max.x && other.max.y <= self.max.y
+	}
+
+	pub(crate) fn contains_point(&self, p : DVec2) -> bool {
+		self.min.x <= p.x && self.min.y <= p.y && p.x <= self.max.x && p.y <= self.max.y
+	}
+}
+
+// Real roots of a*t^2 + b*t + c, degrading to the linear case. Returns the roots and their count.
+pub(crate) fn solve_quadratic(a : f64, b : f64, c : f64) -> ([f64; 2], usize) {
+	let scale = a.abs().max(b.abs()).max(c.abs());
+	if scale == 0.0 {
+		return ([0.0; 2], 0);
+	}
+	if a.abs() <= scale * 1e-12 {
+		if b.abs() <= scale * 1e-12 {
+			return ([0.0; 2], 0);
+		}
+		return ([-c / b, 0.0], 1);
+	}
+	let discriminant = b * b - 4.0 * a * c;
+	if discriminant < 0.0 {
+		return ([0.0; 2], 0);
+	}
+	// Numerically stable form
+	let q = -0.5 * (b + b.signum() * discriminant.sqrt());
+	if q == 0.0 {
+		return ([0.0, 0.0], 1);
+	}
+	let (r0, r1) = (q / a, c / q);
+	if r0 <= r1 { ([r0, r1], 2) } else { ([r1, r0], 2) }
+}
+
+#[derive(Debug, Copy, Clone)]
+pub(crate) struct Cubic {
+	pub(crate) p0 : DVec2,
+	pub(crate) p1 : DVec2,
+	pub(crate) p2 : DVec2,
+	pub(crate) p3 : DVec2,
+}
+
+impl Cubic {
+
+	pub(crate) fn from_groups(start : &ManipulatorGroup<EmptyId>, end : &ManipulatorGroup<EmptyId>) -> Self {
+		let (p0, p3) = (start.anchor, end.anchor);
+		match (start.out_handle, end.in_handle) {
+			(Some(h1), Some(h2)) => Cubic { p0, p1: h1, p2: h2, p3 },
+			(Some(h), None) | (None, Some(h)) => Cubic {
+				p0,
+				p1: p0 + (h - p0) * (2.0 / 3.0),
+				p2: p3 + (h - p3) * (2.0 / 3.0),
+				p3,
+			},
+			(None, None) => Cubic {
+				p0,
+				p1: p0 + (p3 - p0) * (1.0 / 3.0),
+				p2: p0 + (p3 - p0) * (2.0 / 3.0),
+				p3,
+			},
+		}
+	}
+
+	pub(crate) fn evaluate(&self, t : f64) -> DVec2 {
+		let mt = 1.0 - t;
+		self.p0 * (mt * mt * mt) + self.p1 * (3.0 * mt * mt * t) + self.p2 * (3.0 * mt * t * t) + self.p3 * (t * t * t)
+	}
+
+	pub(crate) fn derivative(&self, t : f64) -> DVec2 {
+		let mt = 1.0 - t;
+		(self.p1 - self.p0) * (3.0 * mt * mt) + (self.p2 - self.p1) * (6.0 * mt * t) + (self.p3 - self.p2) * (3.0 * t * t)
+	}
+
+	pub(crate) fn second_derivative(&self, t : f64) -> DVec2 {
+		(self.p2 - self.p1 * 2.0 + self.p0) * (6.0 * (1.0 - t)) + (self.p3 - self.p2 * 2.0 + self.p1) * (6.0 * t)
+	}
+
+	// Power basis coefficients : evaluate(t) = c[0] + c[1]*t + c[2]*t^2 + c[3]*t^3
+	pub(crate) fn power_coefficients(&self) -> [DVec2; 4] {
+		[
+			self.p0,
+			(self.p1 - self.p0) * 3.0,
+			(self.p0 - self.p1 * 2.0 + self.p2) * 3.0,
+			self.p3 - self.p0 + (self.p1 - self.p2) * 3.0,
+		]
+	}
+
+	// De Casteljau split at t
+	pub(crate) fn split(&self, t : f64) -> (Cubic, Cubic) {
+		let p01 = self.p0.lerp(self.p1, t);
+		let p12 = self.p1.lerp(self.p2, t);
+		let p23 = self.p2.lerp(self.p3, t);
+		let p012 = p01.lerp(p12, t);
+		let p123 = p12.lerp(p23, t);
+		let mid = p012.lerp(p123, t);
+		(Cubic { p0: self.p0, p1: p01, p2: p012, p3: mid }, Cubic { p0: mid, p1: p123, p2: p23, p3: self.p3 })
+	}
+
+	// Sub-segment between two local t-values (t0 < t1)
+	pub(crate) fn trim(&self, t0 : f64, t1 : f64) -> Cubic {
+		if t0 <= 0.0 {
+			return if t1 >= 1.0 { *self } else { self.split(t1).0 };
+		}
+		let (_, tail) = self.split(t0);
+		if t1 >= 1.0 {
+			return tail;
+		}
+		tail.split(((t1 - t0) / (1.0 - t0)).clamp(0.0, 1.0)).0
+	}
+
+	// t where a cubic monotonic along `axis` (0 : x, 1 : y) reaches `value` : Newton steps kept within a shrinking bracket,
+	// bisecting when they leave it.
+	pub(crate) fn solve_monotonic(&self, axis : usize, value : f64) -> f64 {
+		let (v0, v3) = (self.p0[axis], self.p3[axis]);
+		let increasing = v3 > v0;
+		let (mut lo, mut hi) = (0.0, 1.0);
+		let mut t = ((value - v0) / (v3 - v0)).clamp(0.0, 1.0);
+		for _ in 0..32 {
+			let error = self.evaluate(t)[axis] - value;
+			if error.abs() <= 1e-12 * (1.0 + value.abs()) {
+				break;
+			}
+			if (error < 0.0) == increasing { lo = t; } else { hi = t; }
+			let slope = self.derivative(t)[axis];
+			let next = t - error / slope;
+			t = if slope != 0.0 && next > lo && next < hi { next } else { 0.5 * (lo + hi) };
+			if hi - lo <= 1e-15 {
+				break;
+			}
+		}
+		t
+	}
+
+	// Unit tangent, falling back to a finite difference where the derivative vanishes (collapsed handles).
+	pub(crate) fn tangent(&self, t : f64) -> DVec2 {
+		let d = self.derivative(t);
+		if d.length_squared() > 1e-24 {
+			return d.normalize();
+		}
+		(self.evaluate((t + 1e-4).min(1.0)) - self.evaluate((t - 1e-4).max(0.0))).normalize_or_zero()
+	}
+
+	// Local t-values where x and y reach a local extremum, excluding end points (like bezier-rs `local_extrema()`).
+	pub(crate) fn extrema(&self) -> [Vec<f64>; 2] {
+		// Derivative / 3 in power basis : a*t^2 + b*t + c
+		let a = (self.p1 - self.p2) * 3.0 + self.p3 - self.p0;
+		let b = (self.p0 - self.p1 * 2.0 + self.p2) * 2.0;
+		let c = self.p1 - self.p0;
+		let roots = |a : f64, b : f64, c : f64| {
+			let (roots, count) = solve_quadratic(a, b, c);
+			roots[..count].iter().copied().filter(|t| *t > 0.0 && *t < 1.0).collect::<Vec<f64>>()
+		};
+		[roots(a.x, b.x, c.x), roots(a.y, b.y, c.y)]
+	}
+
+	// Local t-values of the inflection points (sign changes of the curvature).
+	pub(crate) fn inflections(&self) -> Vec<f64> {
+		let [_, c1, c2, c3] = self.power_coefficients();
+		let cross = |u : DVec2, v : DVec2| u.x * v.y - u.y * v.x;
+		let (roots, count) = solve_quadratic(6.0 * cross(c2, c3), 6.0 * cross(c1, c3), 2.0 * cross(c1, c2));
+		roots[..count].iter().copied().filter(|t| *t > 0.0 && *t < 1.0).collect()
+	}
+
+	// Signed area swept from the origin (Green's theorem : 1/2 * integral of B x B'). Exact, the integrand being of degree 5.
+	pub(crate) fn signed_area(&self) -> f64 {
+		GAUSS_T.iter().zip(GAUSS_W.iter())
+			.map(|(t, w)| { let (p, d) = (self.evaluate(*t), self.derivative(*t)); (p.x * d.y - p.y * d.x) * w })
+			.sum::<f64>() * 0.5
+	}
+
+	// Signed area and first moment of area swept from the origin : 1/2 * integral of B x B', and 1/3 * integral of B (B x B').
+	// Exact, the integrands being of degree 5 and 8.
+	pub(crate) fn area_moments(&self) -> (f64, DVec2) {
+		let (mut area, mut moment) = (0.0, DVec2::ZERO);
+		for (t, w) in GAUSS_T.iter().zip(GAUSS_W.iter()) {
+			let (p, d) = (self.evaluate(*t), self.derivative(*t));
+			let cross = (p.x * d.y - p.y * d.x) * w;
+			area += cross;
+			moment += p * cross;
+		}
+		(area * 0.5, moment * (1.0 / 3.0))
+	}
+
+	// Integral of B |B'| : the first moment of the curve's length (5-point estimate, for length-weighted centroids).
+	pub(crate) fn length_moment(&self) -> DVec2 {
+		GAUSS_T.iter().zip(GAUSS_W.iter())
+			.fold(DVec2::ZERO, |sum, (t, w)| sum + self.evaluate(*t) * (self.derivative(*t).length() * w))
+	}
+
+	pub(crate) fn length_gauss(&self, t0 : f64, t1 : f64) -> f64 {
+		let span = t1 - t0;
+		GAUSS_T.iter().zip(GAUSS_W.iter())
+			.map(|(t, w)| self.derivative(t0 + span * t).length() * w)
+			.sum::<f64>() * span
+	}
+
+	fn length_adaptive(&self, t0 : f64, t1 : f64, whole : f64, tolerance : f64, depth : u32) -> f64 {
+		let mid = 0.5 * (t0 + t1);
+		let (left, right) = (self.length_gauss(t0, mid), self.length_gauss(mid, t1));
+		if depth == 0 || (left + right - whole).abs() <= tolerance {
+			return left + right;
+		}
+		self.length_adaptive(t0, mid, left, tolerance * 0.5, depth - 1) + self.length_adaptive(mid, t1, right, tolerance * 0.5, depth - 1)
+	}
+
+	// Arc length, adaptively refined up to an absolute tolerance.
+	pub(crate) fn length(&self, tolerance : f64) -> f64 {
+		let whole = self.length_gauss(0.0, 1.0);
+		self.length_adaptive(0.0, 1.0, whole, tolerance.max(1e-12), 12)
+	}
+}
+
+// Amount of segments, as bezier-rs counts them
+pub(crate) fn segment_count(sub_path : &Subpath<EmptyId>) -> usize {
+	let groups = sub_path.manipulator_groups();
+	if groups.len() < 2 {
+		return 0;
+	}
+	if sub_path.closed() { groups.len() } else { groups.len() - 1 }
+}
+
+pub(crate) fn segment(sub_path : &Subpath<EmptyId>, index : usize) -> Cubic {
+	let groups = sub_path.manipulator_groups();
+	Cubic::from_groups(&groups[index], &groups[(index + 1) % groups.len()])
+}
+
+// Iterates all segments of a subpath, without allocating.
+pub(crate) fn iter_cubics<'a>(sub_path : &'a Subpath<EmptyId>) -> impl Iterator<Item = Cubic> + 'a {
+	(0..segment_count(sub_path)).map(move |i| segment(sub_path, i))
+}
+
+// Signed area enclosed by a subpath (open paths are implicitly closed by a line).
+// Positive when winding clockwise on screen (y axis pointing down), which is also the direction counting +1 in non-zero winding tests.
+pub(crate) fn signed_area(sub_path : &Subpath<EmptyId>) -> f64 {
+	let mut area : f64 = iter_cubics(sub_path).map(|cubic| cubic.signed_area()).sum();
+	let groups = sub_path.manipulator_groups();
+	if !sub_path.closed() && groups.len() > 1 {
+		let (last, first) = (groups[groups.len() - 1].anchor, groups[0].anchor);
+		area += 0.5 * (last.x * first.y - last.y * first.x);
+	}
+	area
+}
@@ -0,0 +1,65 @@
+
+// Simplification : greedily merges runs of adjacent segments that a single cubic can re-fit within a tolerance.
+// Meant for the output of offset and outline, which split curves into many short pieces.
+// Run end points and their tangents are kept, so the shape doesn't drift when simplified repeatedly.
+
+use bezier_rs::Subpath;
+use glam::f64::DVec2;
+
+use crate::EmptyId;
+use crate::fit::Fitter;
+use crate::segments::{self, Cubic};
+
+// Samples per merged segment, compared against the re-fitted cubic
+const SAMPLES_PER_SEGMENT : usize = 8;
+// Longest run of segments merged into one
+const MAX_RUN : usize = 64;
+
+// Joins turning more than the corner angle are kept (when > 0). Collapsed ends always count as smooth.
+fn is_smooth(a : &Cubic, b : &Cubic, cos_limit : Option<f64>) -> bool {
+	let cos_limit = match cos_limit {
+		Some(cos_limit) => cos_limit,
+		None => return true,
+	};
+	let (end, start) = (a.tangent(1.0), b.tangent(0.0));
+	end == DVec2::ZERO || start == DVec2::ZERO || end.dot(start) >= cos_limit
+}
+
+fn sample_run(run : &[Cubic], points : &mut Vec<DVec2>) {
+	points.clear();
+	for cubic in run {
+		for i in 0..SAMPLES_PER_SEGMENT {
+			points.push(cubic.evaluate(i as f64 / SAMPLES_PER_SEGMENT as f64));
+		}
+	}
+	points.push(run[run.len() - 1].p3);
+}
+
+// Appends the simplified segments of a subpath to `out`.
+pub(crate) fn simplify_subpath(sub_path : &Subpath<EmptyId>, tolerance : f64, corner_angle : f64, out : &mut Vec<Cubic>) {
+	let cubics : Vec<Cubic> = segments::iter_cubics(sub_path).collect();
+	let tolerance_sq = tolerance * tolerance;
+	let cos_limit = if corner_angle > 0.0 { Some(corner_angle.cos()) } else { None };
+	let mut fitter = Fitter::default();
+	let mut points : Vec<DVec2> = Vec::new();
+
+	let mut start = 0;
+	while start < cubics.len() {
+		let mut merged = cubics[start];
+		let mut end = start + 1;
+		let tangent_start = cubics[start].tangent(0.0);
+		while end < cubics.len() && end - start < MAX_RUN && is_smooth(&cubics[end - 1], &cubics[end], cos_limit) {
+			let run = &cubics[start..=end];
+			sample_run(run, &mut points);
+			match fitter.fit_single(&points, tangent_start, -run[run.len() - 1].tangent(1.0), tolerance_sq) {
+				Some(cubic) => {
+					merged = cubic;
+					end += 1;
+				}
+				None => break,
+			}
+		}
+		out.push(merged);
+		start = end;
+	}
+}
@@ -0,0 +1,301 @@
+
+// Single precision shapes : cubic segments stored and evaluated in f32, for workloads that don't need f64
+// (particles, hit testing, flattening for display). Half the storage of the f64 shape, twice the SIMD lanes.
+// Segments are stored in Bernstein form, which stays accurate in f32 (the power basis loses digits by cancellation).
+// Accuracy versus the f64 path is documented in the Readme.
+
+use glam::f64::DVec2;
+
+use crate::{bezrsBezierHandleF, bezrsFillRule, bezrsPosF};
+use crate::parallel::{self, SharedMutPtr};
+use crate::segments::Cubic;
+
+// Upper bound on the amount of lines emitted per segment
+const MAX_LINES_PER_SEGMENT : usize = 4096;
+// Minimum amount of items per thread for batch kernels
+const MIN_BATCH_PER_THREAD : usize = 4096;
+// Maximum amount of horizontal bands indexing the containment pieces
+const MAX_BANDS : usize = 1024;
+
+#[derive(Debug, Copy, Clone)]
+pub(crate) struct CubicF {
+	x : [f32; 4],
+	y : [f32; 4],
+}
+
+impl CubicF {
+
+	fn from_cubic(cubic : &Cubic) -> Self {
+		let points = [cubic.p0, cubic.p1, cubic.p2, cubic.p3];
+		CubicF { x: points.map(|p| p.x as f32), y: points.map(|p| p.y as f32) }
+	}
+
+	fn from_points(p0 : bezrsPosF, p1 : bezrsPosF, p2 : bezrsPosF, p3 : bezrsPosF) -> Self {
+		CubicF { x: [p0.x, p1.x, p2.x, p3.x], y: [p0.y, p1.y, p2.y, p3.y] }
+	}
+
+	#[inline(always)]
+	fn bernstein(c : &[f32; 4], t : f32) -> f32 {
+		let mt = 1.0 - t;
+		c[0] * (mt * mt * mt) + c[1] * (3.0 * mt * mt * t) + c[2] * (3.0 * mt * t * t) + c[3] * (t * t * t)
+	}
+
+	#[inline(always)]
+	pub(crate) fn evaluate(&self, t : f32) -> bezrsPosF {
+		// Weights shared by x and y : 4-lane dot products
+		let mt = 1.0 - t;
+		let w = [mt * mt * mt, 3.0 * mt * mt * t, 3.0 * mt * t * t, t * t * t];
+		bezrsPosF {
+			x: w[0] * self.x[0] + w[1] * self.x[1] + w[2] * self.x[2] + w[3] * self.x[3],
+			y: w[0] * self.y[0] + w[1] * self.y[1] + w[2] * self.y[2] + w[3] * self.y[3],
+		}
+	}
+
+	fn to_cubic(&self) -> Cubic {
+		let p = |i : usize| DVec2::new(self.x[i] as f64, self.y[i] as f64);
+		Cubic { p0: p(0), p1: p(1), p2: p(2), p3: p(3) }
+	}
+
+	// Same bound as the f64 flattening : chord error of a step h <= max|B''| * h^2 / 8
+	fn lines_for_tolerance(&self, tolerance : f32) -> usize {
+		let dd = |c : &[f32; 4]| ((c[0] - 2.0 * c[1] + c[2]).abs(), (c[1] - 2.0 * c[2] + c[3]).abs());
+		let ((ax, bx), (ay, by)) = (dd(&self.x), dd(&self.y));
+		let dd = (ax * ax + ay * ay).sqrt().max((bx * bx + by * by).sqrt()) * 6.0;
+		let lines = (dd / (8.0 * tolerance.max(1e-6))).sqrt().ceil();
+		if lines.is_finite() { (lines as usize).clamp(1, MAX_LINES_PER_SEGMENT) } else { 1 }
+	}
+}
+
+// y-monotonic piece, for winding tests
+#[derive(Debug, Copy, Clone)]
+struct PieceF {
+	cubic : CubicF,
+	x_min : f32,
+	x_max : f32,
+	y_min : f32,
+	y_max : f32,
+	direction : i32, // +1 when y increases along the piece
+}
+
+impl PieceF {
+
+	fn new(cubic : CubicF) -> Option<Self> {
+		let (y0, y3) = (cubic.y[0], cubic.y[3]);
+		if y0 == y3 {
+			return None;
+		}
+		let x_min = cubic.x.iter().copied().fold(f32::INFINITY, f32::min);
+		let x_max = cubic.x.iter().copied().fold(f32::NEG_INFINITY, f32::max);
+		Some(PieceF { cubic, x_min, x_max, y_min: y0.min(y3), y_max: y0.max(y3), direction: if y3 > y0 { 1 } else { -1 } })
+	}
+
+	// Crossing of a +x ray with the piece (-1, 0 or 1), with the half-open rule on end points
+	#[inline]
+	fn winding(&self, px : f32, py : f32) -> i32 {
+		if py < self.y_min || py >= self.y_max || px >= self.x_max {
+			return 0;
+		}
+		if px < self.x_min {
+			return self.direction;
+		}
+		// Bisection on the monotonic y : f32 has 24 bits of mantissa
+		let increasing = self.direction > 0;
+		let (mut lo, mut hi) = (0.0f32, 1.0f32);
+		for _ in 0..24 {
+			let mid = 0.5 * (lo + hi);
+			if (CubicF::bernstein(&self.cubic.y, mid) < py) == increasing { lo = mid; } else { hi = mid; }
+		}
+		if CubicF::bernstein(&self.cubic.x, 0.5 * (lo + hi)) > px { self.direction } else { 0 }
+	}
+}
+
+// Horizontal bands over the pieces : each point only tests the pieces overlapping its band
+#[derive(Debug, Default)]
+struct Bands {
+	y_min : f32,
+	scale : f32, // bands per unit of y
+	starts : Vec<u32>, // band i lists pieces[starts[i]..starts[i+1]]
+	pieces : Vec<u32>,
+}
+
+impl Bands {
+
+	fn build(&mut self, pieces : &[PieceF]) {
+		self.starts.clear();
+		self.pieces.clear();
+		if pieces.is_empty() {
+			return;
+		}
+		let y_min = pieces.iter().map(|piece| piece.y_min).fold(f32::INFINITY, f32::min);
+		let y_max = pieces.iter().map(|piece| piece.y_max).fold(f32::NEG_INFINITY, f32::max);
+		let count = pieces.len().clamp(1, MAX_BANDS);
+		self.y_min = y_min;
+		self.scale = if y_max > y_min { count as f32 / (y_max - y_min) } else { 0.0 };
+		let band = |y : f32| (((y - y_min) * self.scale) as usize).min(count - 1);
+
+		// Counting sort of the pieces into the bands they overlap
+		self.starts.resize(count + 1, 0);
+		for piece in pieces {
+			for b in band(piece.y_min)..=band(piece.y_max) {
+				self.starts[b + 1] += 1;
+			}
+		}
+		for b in 0..count {
+			self.starts[b + 1] += self.starts[b];
+		}
+		self.pieces.resize(self.starts[count] as usize, 0);
+		let mut cursor : Vec<u32> = self.starts[..count].to_vec();
+		for (i, piece) in pieces.iter().enumerate() {
+			for b in band(piece.y_min)..=band(piece.y_max) {
+				self.pieces[cursor[b] as usize] = i as u32;
+				cursor[b] += 1;
+			}
+		}
+	}
+
+	#[inline]
+	fn candidates(&self, y : f32) -> &[u32] {
+		let count = self.starts.len().saturating_sub(1);
+		let position = (y - self.y_min) * self.scale;
+		if count == 0 || !(position >= 0.0) {
+			return &[];
+		}
+		let b = (position as usize).min(count - 1);
+		&self.pieces[self.starts[b] as usize..self.starts[b + 1] as usize]
+	}
+
+	fn memory_size(&self) -> usize {
+		(self.starts.capacity() + self.pieces.capacity()) * std::mem::size_of::<u32>()
+	}
+}
+
+#[derive(Debug, Default)]
+pub(crate) struct ShapeF {
+	segments : Vec<CubicF>,
+	closed : bool,
+	pieces : Vec<PieceF>, // Built on the first containment query, empty when dirty
+	bands : Bands,
+}
+
+impl ShapeF {
+
+	pub(crate) fn segment_count(&self) -> usize {
+		self.segments.len()
+	}
+
+	// Bytes used by the stored geometry (segments and containment data)
+	pub(crate) fn memory_size(&self) -> usize {
+		self.segments.capacity() * std::mem::size_of::<CubicF>() + self.pieces.capacity() * std::mem::size_of::<PieceF>() + self.bands.memory_size()
+	}
+
+	pub(crate) fn set_cubics<I : Iterator<Item = Cubic>>(&mut self, cubics : I, closed : bool) {
+		self.segments.clear();
+		self.segments.extend(cubics.map(|cubic| CubicF::from_cubic(&cubic)));
+		self.closed = closed;
+		self.pieces.clear();
+	}
+
+	// Same conventions as the f64 shape : the segment i goes from handle i to handle i+1, closed shapes loop back.
+	pub(crate) fn set_handles(&mut self, handles : &[bezrsBezierHandleF], closed : bool) {
+		self.segments.clear();
+		let count = if handles.len() < 2 { 0 } else if closed { handles.len() } else { handles.len() - 1 };
+		self.segments.extend((0..count).map(|i| {
+			let (a, b) = (&handles[i], &handles[(i + 1) % handles.len()]);
+			CubicF::from_points(a.pos, a.out_bez, b.in_bez, b.pos)
+		}));
+		self.closed = closed && count > 0;
+		self.pieces.clear();
+	}
+
+	#[inline]
+	fn locate(&self, t : f32) -> (usize, f32) {
+		let count = self.segments.len();
+		let scaled = t.clamp(0.0, 1.0) * count as f32;
+		let segment = (scaled as usize).min(count - 1);
+		(segment, (scaled - segment as f32).clamp(0.0, 1.0))
+	}
+
+	// Positions at global t-values (0->1 over the whole shape), multithreaded for large batches
+	pub(crate) fn evaluate(&self, ts : &[f32], out : &mut [bezrsPosF]) {
+		if self.segments.is_empty() {
+			return;
+		}
+		let len = ts.len().min(out.len());
+		let out_ptr = SharedMutPtr(out.as_mut_ptr());
+		parallel::for_each_range(len, MIN_BATCH_PER_THREAD, |range| {
+			for i in range {
+				let (segment, t) = self.locate(ts[i]);
+				unsafe { *out_ptr.get().add(i) = self.segments[segment].evaluate(t); }
+			}
+		});
+	}
+
+	fn prepare(&mut self) {
+		if !self.pieces.is_empty() || self.segments.is_empty() {
+			return;
+		}
+		// Split at the y extrema, found in f64 (stable roots) then stored in f32
+		for segment in &self.segments {
+			let cubic = segment.to_cubic();
+			let mut t0 = 0.0;
+			for t1 in cubic.extrema()[1].iter().copied().chain(std::iter::once(1.0)) {
+				self.pieces.extend(PieceF::new(CubicF::from_cubic(&cubic.trim(t0, t1))));
+				t0 = t1;
+			}
+		}
+		// Open paths are implicitly closed for containment
+		if !self.closed {
+			let (first, last) = (&self.segments[0], &self.segments[self.segments.len() - 1]);
+			let (a, b) = (bezrsPosF { x: last.x[3], y: last.y[3] }, bezrsPosF { x: first.x[0], y: first.y[0] });
+			let lerp = |s : f32| bezrsPosF { x: a.x + (b.x - a.x) * s, y: a.y + (b.y - a.y) * s };
+			self.pieces.extend(PieceF::new(CubicF::from_points(a, lerp(1.0 / 3.0), lerp(2.0 / 3.0), b)));
+		}
+		self.bands.build(&self.pieces);
+	}
+
+	// Containment of many points (1 inside, 0 outside), multithreaded for large batches
+	pub(crate) fn contains_points(&mut self, points : &[bezrsPosF], fill_rule : bezrsFillRule, out : &mut [u8]) {
+		self.prepare();
+		let len = points.len().min(out.len());
+		let (pieces, bands) = (&self.pieces, &self.bands);
+		let out_ptr = SharedMutPtr(out.as_mut_ptr());
+		parallel::for_each_range(len, MIN_BATCH_PER_THREAD / 4, |range| {
+			for i in range {
+				let p = points[i];
+				let winding : i32 = bands.candidates(p.y).iter().map(|i| pieces[*i as usize].winding(p.x, p.y)).sum();
+				let inside = match fill_rule {
+					bezrsFillRule::NonZero => winding != 0,
+					bezrsFillRule::EvenOdd => winding % 2 != 0,
+				};
+				unsafe { *out_ptr.get().add(i) = inside as u8; }
+			}
+		});
+	}
+
+	// Flattens into a polyline within `tolerance`. Closed shapes don't repeat their start point.
+	// Writes at most `out.len()` points and returns the total amount of points.
+	pub(crate) fn flatten(&self, tolerance : f32, out : &mut [bezrsPosF]) -> usize {
+		let mut count = 0;
+		let mut push = |p : bezrsPosF| {
+			if let Some(slot) = out.get_mut(count) {
+				*slot = p;
+			}
+			count += 1;
+		};
+		let last = self.segments.len();
+		for (i, segment) in self.segments.iter().enumerate() {
+			if i == 0 {
+				push(segment.evaluate(0.0));
+			}
+			let lines = segment.lines_for_tolerance(tolerance);
+			let step = 1.0 / lines as f32;
+			for j in 1..lines {
+				push(segment.evaluate(j as f32 * step));
+			}
+			if !(self.closed && i + 1 == last) {
+				push(bezrsPosF { x: segment.x[3], y: segment.y[3] });
+			}
+		}
+		count
+	}
+}
@@ -0,0 +1,137 @@
+
+// Splitting and trimming at global t-values (0->1 over the whole subpath, like `SubpathTValue::GlobalParametric`).
+// Pieces are written as real cubic segments into packed storage, so cutting into many pieces costs no per-piece allocations.
+
+use bezier_rs::Subpath;
+
+use crate::EmptyId;
+use crate::multishape::MultiShapeData;
+use crate::segments::{self, Cubic};
+
+// Pieces shorter than this (in global t) are considered degenerate and dropped.
+const T_EPSILON : f64 = 1e-9;
+
+// Segment index and local t-value of a global t-value
+fn locate(count : usize, t : f64) -> (usize, f64) {
+	let scaled = t.clamp(0.0, 1.0) * count as f64;
+	let segment = (scaled.floor() as usize).min(count - 1);
+	(segment, (scaled - segment as f64).clamp(0.0, 1.0))
+}
+
+// Appends the segments between global t-values `t0` <= `t1` to `chain`.
+fn push_range(sub_path : &Subpath<EmptyId>, count : usize, t0 : f64, t1 : f64, chain : &mut Vec<Cubic>) {
+	let local_epsilon = T_EPSILON * count as f64;
+	let ((s0, l0), (s1, l1)) = (locate(count, t0), locate(count, t1));
+	if s0 == s1 {
+		chain.push(segments::segment(sub_path, s0).trim(l0, l1));
+		return;
+	}
+	if l0 < 1.0 - local_epsilon {
+		chain.push(segments::segment(sub_path, s0).trim(l0, 1.0));
+	}
+	for i in s0 + 1..s1 {
+		chain.push(segments::segment(sub_path, i));
+	}
+	if l1 > local_epsilon {
+		chain.push(segments::segment(sub_path, s1).trim(0.0, l1));
+	}
+}
+
+// Appends the piece between `t0` and `t1` to `chain`. On closed subpaths, `t0 > t1` wraps over the start point.
+// Returns false for degenerate pieces.
+pub(crate) fn trim_subpath(sub_path : &Subpath<EmptyId>, t0 : f64, t1 : f64, chain : &mut Vec<Cubic>) -> bool {
+	let count = segments::segment_count(sub_path);
+	if count == 0 || !t0.is_finite() || !t1.is_finite() {
+		return false;
+	}
+	let (t0, t1) = (t0.clamp(0.0, 1.0), t1.clamp(0.0, 1.0));
+	if t0 <= t1 || !sub_path.closed() {
+		let (t0, t1) = if t0 <= t1 { (t0, t1) } else { (t1, t0) };
+		if t1 - t0 <= T_EPSILON {
+			return false;
+		}
+		push_range(sub_path, count, t0, t1, chain);
+	}
+	else {
+		if 1.0 - t0 > T_EPSILON {
+			push_range(sub_path, count, t0, 1.0, chain);
+		}
+		if t1 > T_EPSILON {
+			push_range(sub_path, count, 0.0, t1, chain);
+		}
+	}
+	!chain.is_empty()
+}
+
+// Extracts the pieces between pairs of t-values into `out` (which is cleared first). Returns the amount of pieces.
+pub(crate) fn extract_ranges(sub_path : &Subpath<EmptyId>, ranges : &[[f64; 2]], out : &mut MultiShapeData) -> usize {
+	out.clear();
+	let mut chain : Vec<Cubic> = Vec::new();
+	for range in ranges {
+		chain.clear();
+		if trim_subpath(sub_path, range[0], range[1], &mut chain) {
+			out.push_chain(&chain, false);
+		}
+	}
+	out.spans.len()
+}
+
+// Cuts the subpath at the given t-values into `out` (which is cleared first). Returns the amount of pieces.
+// The t-values don't need to be sorted, duplicates are ignored. An open path cut n times gives n+1 pieces, a closed one
+// gives n pieces (the last one running over the start point), or itself when there are no cuts.
+pub(crate) fn split_subpath(sub_path : &Subpath<EmptyId>, ts : &[f64], out : &mut MultiShapeData) -> usize {
+	out.clear();
+	let count = segments::segment_count(sub_path);
+	if count == 0 {
+		return 0;
+	}
+
+	let mut cuts : Vec<f64> = ts.iter().copied().filter(|t| t.is_finite()).map(|t| t.clamp(0.0, 1.0)).collect();
+	if !cuts.windows(2).all(|pair| pair[0] <= pair[1]) {
+		cuts.sort_by(|a, b| a.partial_cmp(b).unwrap());
+	}
+	cuts.dedup_by(|b, a| *b - *a <= T_EPSILON);
+
+	let mut chain : Vec<Cubic> = Vec::with_capacity(count + cuts.len());
+	let closed = sub_path.closed();
+	if closed {
+		// 0 and 1 are the same point
+		if cuts.len() > 1 && cuts[0] <= T_EPSILON && 1.0 - cuts[cuts.len() - 1] <= T_EPSILON {
+			cuts.pop();
+		}
+		if cuts.is_empty() {
+			chain.extend(segments::iter_cubics(sub_path));
+			out.push_chain(&chain, true);
+			return out.spans.len();
+		}
+		for i in 0..cuts.len() {
+			chain.clear();
+			let (t0, t1) = (cuts[i], cuts[(i + 1) % cuts.len()]);
+			let whole = cuts.len() == 1;
+			if whole {
+				// Opened at the only cut
+				if 1.0 - t0 > T_EPSILON {
+					push_range(sub_path, count, t0, 1.0, &mut chain);
+				}
+				if t0 > T_EPSILON {
+					push_range(sub_path, count, 0.0, t0, &mut chain);
+				}
+			}
+			else if !trim_subpath(sub_path, t0, t1, &mut chain) {
+				continue;
+			}
+			out.push_chain(&chain, false);
+		}
+	}
+	else {
+		let mut start = 0.0;
+		for end in cuts.iter().copied().chain(std::iter::once(1.0)) {
+			chain.clear();
+			if trim_subpath(sub_path, start, end, &mut chain) {
+				out.push_chain(&chain, false);
+			}
+			start = end;
+		}
+	}
+	out.spans.len()
+}
@@ -0,0 +1,91 @@
+
+// Strided ingestion : reads bezier handles straight from the caller's memory layout
+// (glm::vec3 floats, interleaved vertex buffers, ...) without an intermediate conversion pass.
+
+use std::ptr;
+
+use bezier_rs::ManipulatorGroup;
+use glam::f64::DVec2;
+
+use crate::{EmptyId, bezrsPointStream, bezrsScalarType, bezrsStridedHandles};
+
+// Reads x and y at the start of an element, which may be unaligned
+trait Scalar : Copy {
+	fn read_point(element : *const u8) -> DVec2;
+}
+
+impl Scalar for f32 {
+	#[inline(always)]
+	fn read_point(element : *const u8) -> DVec2 {
+		unsafe {
+			let p = element as *const f32;
+			DVec2::new(ptr::read_unaligned(p) as f64, ptr::read_unaligned(p.add(1)) as f64)
+		}
+	}
+}
+
+impl Scalar for f64 {
+	#[inline(always)]
+	fn read_point(element : *const u8) -> DVec2 {
+		unsafe {
+			let p = element as *const f64;
+			DVec2::new(ptr::read_unaligned(p), ptr::read_unaligned(p.add(1)))
+		}
+	}
+}
+
+fn element_stride(stream : &bezrsPointStream) -> usize {
+	if stream.stride != 0 {
+		return stream.stride as usize;
+	}
+	// Tightly packed
+	match stream.scalar {
+		bezrsScalarType::Float => 2 * std::mem::size_of::<f32>(),
+		bezrsScalarType::Double => 2 * std::mem::size_of::<f64>(),
+	}
+}
+
+// Resolved stream : base pointer, byte stride and reader
+#[derive(Copy, Clone)]
+struct Reader {
+	base : *const u8,
+	stride : usize,
+	read : fn(*const u8) -> DVec2,
+}
+
+impl Reader {
+	fn new(stream : &bezrsPointStream) -> Option<Reader> {
+		if stream.data.is_null() {
+			return None;
+		}
+		let read : fn(*const u8) -> DVec2 = match stream.scalar {
+			bezrsScalarType::Float => f32::read_point,
+			bezrsScalarType::Double => f64::read_point,
+		};
+		Some(Reader { base: stream.data as *const u8, stride: element_stride(stream), read })
+	}
+
+	#[inline(always)]
+	fn get(&self, i : usize) -> DVec2 {
+		(self.read)(unsafe { self.base.add(i * self.stride) })
+	}
+}
+
+// Fills manipulator groups from strided streams in a single pass (reusing `groups`). Missing handle streams collapse onto the anchors.
+pub(crate) fn read_groups(handles : &bezrsStridedHandles, groups : &mut Vec<ManipulatorGroup<EmptyId>>) {
+	groups.clear();
+	let anchors = match Reader::new(&handles.anchors) {
+		Some(anchors) => anchors,
+		None => return,
+	};
+	let (in_handles, out_handles) = (Reader::new(&handles.in_handles), Reader::new(&handles.out_handles));
+	groups.extend((0..handles.len as usize).map(|i| {
+		let anchor = anchors.get(i);
+		ManipulatorGroup {
+			anchor,
+			in_handle: Some(in_handles.map_or(anchor, |reader| reader.get(i))),
+			out_handle: Some(out_handles.map_or(anchor, |reader| reader.get(i))),
+			id: EmptyId,
+		}
+	}));
+}
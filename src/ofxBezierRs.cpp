@@ -11,6 +11,15 @@ glm::vec2 to_glmVec2(const bezrsPos& _pos){
     return glm::vec2(_pos.x, _pos.y);
 }
 
+// Note: glm matrices are column-major, `_mat[column][row]`
+bezrsAffine to_bezrsAffine(const glm::mat3& _mat){
+    return { _mat[0][0], _mat[0][1], _mat[1][0], _mat[1][1], _mat[2][0], _mat[2][1] };
+}
+
+bezrsAffine to_bezrsAffine(const glm::mat4& _mat){
+    return { _mat[0][0], _mat[0][1], _mat[1][0], _mat[1][1], _mat[3][0], _mat[3][1] };
+}
+
 std::vector<bezrsBezierHandle> bezrs_beziers_from_rect(const bezrsRect& _rect){
     std::vector<bezrsBezierHandle> ret;
     ret.push_back({{_rect.pos},{_rect.pos},{_rect.pos}});
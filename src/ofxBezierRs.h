@@ -2,17 +2,685 @@
 #include "bezier-rs-ffi.h"
 //#include <glm/vec2.hpp>
 #include <vector>
+#include <utility>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include <initializer_list>
 #include "ofGraphicsBaseTypes.h"
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
 
 // Glue
 bezrsPos to_bezrsPos(const glm::vec2& _pos);
 glm::vec2 to_glmVec2(const bezrsPos& _pos);
+bezrsAffine to_bezrsAffine(const glm::mat3& _mat); // 2D homogeneous matrix
+bezrsAffine to_bezrsAffine(const glm::mat4& _mat); // Ignores the Z axis
 std::vector<bezrsBezierHandle> bezrs_beziers_from_rect(const bezrsRect& _rect);
 
 // Overload glue (ofToString, etc)
 std::ostream & operator<< (std::ostream& out, bezrsPos const& pos);
 //inline glm::vec2::vec<2, float, glm::qualifier::defaultp>(const bezrsPos & v): x(v.x), y(v.y) {}
 
+namespace ofxBezierRs {
+
+// Read-only view over a contiguous buffer, without owning nor copying it. (a minimal std::span)
+// Views over Rust-owned data are only valid until the next call that mutates or queries the same data.
+template<typename T>
+class View {
+    public:
+    View() = default;
+    View(const T* _data, std::size_t _size) : ptr(_size>0 ? _data : nullptr), count(_data!=nullptr ? _size : 0) {}
+
+    const T* data() const { return ptr; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count==0; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + count; }
+    const T& operator[](std::size_t _i) const { return ptr[_i]; }
+
+    // Bulk copy into a caller-owned vector (reuses its capacity)
+    void copyTo(std::vector<T>& _out) const { _out.assign(begin(), end()); }
+
+    private:
+    const T* ptr = nullptr;
+    std::size_t count = 0;
+};
+
+// Strided stream over any contiguous array of vectors with float or double x,y members (glm::vec2/vec3, ofDefaultVertexType, ...)
+// The data is read in place, without converting it to `bezrsBezierHandle` first.
+template<typename Vec>
+bezrsPointStream pointStream(const Vec* _data){
+    using Scalar = typename std::remove_cv<typename std::remove_reference<decltype(_data->x)>::type>::type;
+    static_assert(std::is_same<Scalar, float>::value || std::is_same<Scalar, double>::value, "Only float or double x,y are supported");
+    return { _data, sizeof(Vec), std::is_same<Scalar, float>::value ? bezrsScalarType::Float : bezrsScalarType::Double };
+}
+
+class Shape;
+
+// Owning wrapper around a Rust-allocated `bezrsMultiShape*` (packed list of shapes), destroyed automatically.
+// Keep one around to receive results every frame : its buffers are recycled.
+class MultiShape {
+    public:
+    MultiShape() : handle(bezrs_multishape_create()) {}
+    ~MultiShape(){ if(handle != nullptr) bezrs_multishape_destroy(handle); }
+
+    MultiShape(const MultiShape&) = delete;
+    MultiShape& operator=(const MultiShape&) = delete;
+    MultiShape(MultiShape&& _other) noexcept : handle(_other.handle) { _other.handle = nullptr; }
+    MultiShape& operator=(MultiShape&& _other) noexcept {
+        std::swap(handle, _other.handle);
+        return *this;
+    }
+
+    bezrsMultiShape* get() const { return handle; }
+
+    // Zero-copy views, valid until the multi-shape is modified or destroyed.
+    View<bezrsBezierHandle> handles() const {
+        bezrsMultiShapeRaw raw = bezrs_multishape_return_data(handle);
+        return { raw.handles, static_cast<std::size_t>(raw.handles_len) };
+    }
+    View<bezrsShapeSpan> spans() const {
+        bezrsMultiShapeRaw raw = bezrs_multishape_return_data(handle);
+        return { raw.shapes, static_cast<std::size_t>(raw.shapes_len) };
+    }
+    std::size_t size() const { return spans().size(); }
+    View<bezrsBezierHandle> shape(std::size_t _index) const {
+        const bezrsShapeSpan& span = spans()[_index];
+        return { handles().data() + span.offset, static_cast<std::size_t>(span.len) };
+    }
+    // Copies one shape into its own (owned) shape handle
+    inline Shape extract(std::size_t _index) const;
+
+    private:
+    bezrsMultiShape* handle = nullptr;
+};
+
+// Owning wrapper around a Rust-allocated `bezrsShape*`, destroyed automatically.
+// Move-only : there's exactly one owner per internal handle.
+class Shape {
+    public:
+    Shape() = default;
+    // Takes ownership of an existing handle
+    explicit Shape(bezrsShape* _handle) : handle(_handle) {}
+    // `_winding` reverses the handles when needed (see `bezrs_shape_create_oriented()`), None keeps them as given.
+    Shape(const bezrsBezierHandle* _data, std::size_t _len, bool _closed = true, bezrsWinding _winding = bezrsWinding::None){
+        bezrsShapeRaw raw = { _data, _len, _closed };
+        handle = _winding == bezrsWinding::None ? bezrs_shape_create(&raw, _closed) : bezrs_shape_create_oriented(&raw, _closed, _winding);
+    }
+    Shape(const std::vector<bezrsBezierHandle>& _beziers, bool _closed = true, bezrsWinding _winding = bezrsWinding::None) : Shape(_beziers.data(), _beziers.size(), _closed, _winding) {}
+    ~Shape(){ reset(); }
+
+    Shape(const Shape&) = delete;
+    Shape& operator=(const Shape&) = delete;
+    Shape(Shape&& _other) noexcept : handle(_other.release()) {}
+    Shape& operator=(Shape&& _other) noexcept {
+        if(this != &_other) reset(_other.release());
+        return *this;
+    }
+
+    // Handle ownership
+    bezrsShape* get() const { return handle; }
+    explicit operator bool() const { return handle != nullptr; }
+    bezrsShape* release(){
+        bezrsShape* ret = handle;
+        handle = nullptr;
+        return ret;
+    }
+    void reset(bezrsShape* _handle = nullptr){
+        if(handle != nullptr) bezrs_shape_destroy(handle);
+        handle = _handle;
+    }
+    // O(1) snapshot sharing the geometry until one of them is mutated (copy on write)
+    Shape clone() const { return Shape(handle != nullptr ? bezrs_shape_clone(handle) : nullptr); }
+    bool isShared() const { return handle != nullptr && bezrs_shape_is_shared(handle); }
+
+    // Replaces all handles in one bulk copy (creates the internal handle if needed)
+    void assign(const bezrsBezierHandle* _data, std::size_t _len, bool _closed = true){
+        bezrsShapeRaw raw = { _data, _len, _closed };
+        if(handle == nullptr) handle = bezrs_shape_create(&raw, _closed);
+        else bezrs_shape_set_handle_data(handle, &raw, _closed);
+    }
+    void assign(const std::vector<bezrsBezierHandle>& _beziers, bool _closed = true){
+        assign(_beziers.data(), _beziers.size(), _closed);
+    }
+    // Replaces all handles from strided streams, in one pass (creates the internal handle if needed)
+    void assign(const bezrsStridedHandles& _handles){
+        if(handle == nullptr) handle = bezrs_shape_create_strided(&_handles);
+        else bezrs_shape_set_strided(handle, &_handles);
+    }
+    // Anchors with optional in/out handle arrays of the same length (ofPolyline::getVertices(), std::vector<glm::vec2>, ...)
+    template<typename Vec>
+    void assignPoints(const Vec* _anchors, std::size_t _len, bool _closed = false, const Vec* _inHandles = nullptr, const Vec* _outHandles = nullptr){
+        bezrsPointStream none = { nullptr, 0, bezrsScalarType::Double };
+        bezrsStridedHandles strided = {
+            pointStream(_anchors),
+            _inHandles != nullptr ? pointStream(_inHandles) : none,
+            _outHandles != nullptr ? pointStream(_outHandles) : none,
+            _len, _closed
+        };
+        assign(strided);
+    }
+    template<typename Vec>
+    void assignPoints(const std::vector<Vec>& _anchors, bool _closed = false){
+        assignPoints(_anchors.data(), _anchors.size(), _closed);
+    }
+
+    // Replaces the shape by cubic segments fitted through a dense polyline (see `bezrs_shape_fit_points()`)
+    Shape& fitPoints(const bezrsPos* _points, std::size_t _len, double _tolerance, double _cornerAngle = 0, bool _closed = false){
+        if(handle == nullptr) handle = bezrs_shape_create(nullptr, false);
+        bezrs_shape_fit_points(handle, _points, _len, _tolerance, _cornerAngle, _closed);
+        return *this;
+    }
+    Shape& fitPoints(const std::vector<bezrsPos>& _points, double _tolerance, double _cornerAngle = 0, bool _closed = false){
+        return fitPoints(_points.data(), _points.size(), _tolerance, _cornerAngle, _closed);
+    }
+
+    // Zero-copy views over the Rust-owned data, valid until the shape is mutated or destroyed.
+    View<bezrsBezierHandle> handles() const {
+        if(handle == nullptr) return {};
+        bezrsShapeRaw raw = bezrs_shape_return_handle_data(handle);
+        return { raw.data, static_cast<std::size_t>(raw.len) };
+    }
+    void copyTo(std::vector<bezrsBezierHandle>& _out) const { handles().copyTo(_out); }
+    bool isClosed() const { return handle != nullptr && bezrs_shape_is_closed(handle); }
+    std::size_t size() const { return handle ? bezrs_shape_info_size(handle) : 0; }
+    std::size_t segments() const { return handle ? bezrs_shape_info_segments(handle) : 0; }
+
+    // Float results live in a single shared Rust buffer : the views are only valid until the next float query (on any shape).
+    // Without an internal handle (default constructed or moved-from), queries return empty or default values and operations do nothing.
+    View<double> inflections() const { return handle ? floatsView(bezrs_shape_inflections(handle)) : View<double>{}; }
+    View<double> localExtrema() const { return handle ? floatsView(bezrs_shape_localextrema(handle)) : View<double>{}; }
+    View<double> selfIntersections(double _errorTreshold = 0.001, double _minDist = 0.001) const {
+        if(handle == nullptr) return {};
+        return floatsView(bezrs_shape_selfintersections(handle, _errorTreshold, _minDist));
+    }
+    // Within a budget : returns why the search stopped, the view holding what was found so far
+    bezrsStatus selfIntersections(View<double>& _out, const bezrsBudget& _budget, double _errorTreshold = 0.001, double _minDist = 0.001) const {
+        _out = {};
+        if(handle == nullptr) return bezrsStatus::Complete;
+        bezrsFloatsRaw raw = { nullptr, 0 };
+        bezrsStatus status = bezrs_shape_selfintersections_budget(handle, _errorTreshold, _minDist, &_budget, &raw);
+        _out = floatsView(raw);
+        return status;
+    }
+
+    // Operations (in place)
+    Shape& offset(double _offset, bezrsJoinType _join = bezrsJoinType::Bevel, double _mitter = 0){
+        if(handle != nullptr) bezrs_cubic_bezier_offset(handle, _offset, _join, _mitter);
+        return *this;
+    }
+    // Curve fitting offset within a budget : truncated to an open chain of `max_results` segments when `Truncated`,
+    // left untouched when `TimedOut` or `Cancelled` (see `bezrs_shape_offset_budget()`)
+    bezrsStatus tryOffset(double _offset, const bezrsBudget& _budget, bezrsJoinType _join = bezrsJoinType::Bevel, double _mitter = 0, double _tolerance = 0.1){
+        if(handle == nullptr) return bezrsStatus::Complete;
+        return bezrs_shape_offset_budget(handle, _offset, _join, _mitter, _tolerance, &_budget);
+    }
+    Shape& rotate(double _angle, bezrsPos _center = {0, 0}){
+        if(handle != nullptr) bezrs_shape_rotate(handle, _angle, &_center);
+        return *this;
+    }
+    Shape& transform(const bezrsAffine& _matrix){
+        if(handle != nullptr) bezrs_shape_transform(handle, _matrix);
+        return *this;
+    }
+    // Merges adjacent segments within a tolerance, to keep chained offsets/outlines from growing (see `bezrs_shape_simplify()`)
+    Shape& simplify(double _tolerance, double _cornerAngle = 0){
+        if(handle != nullptr) bezrs_shape_simplify(handle, _tolerance, _cornerAngle);
+        return *this;
+    }
+    Shape& reverseWinding(){
+        if(handle != nullptr) bezrs_shape_reverse_winding(handle);
+        return *this;
+    }
+
+    // Outlines the shape, consuming it. The 2nd shape is only valid (non-null) when outlining a closed shape.
+    // Usage : `auto outlines = std::move(shape).outline(10);`
+    std::pair<Shape, Shape> outline(double _distance, bezrsJoinType _join = bezrsJoinType::Bevel, bezrsCapType _cap = bezrsCapType::Butt, double _mitter = 0) && {
+        bezrsShape* second = handle != nullptr ? bezrs_shape_outline(handle, _distance, _join, _cap, _mitter) : nullptr;
+        return { Shape(release()), Shape(second) };
+    }
+    // Outlines the shape with a width profile into `_out` (see `bezrs_shape_outline_variable()`), returns the amount of paths.
+    // Fill it with the non-zero rule. Usage : `shape.outlineVariable({{0, 2}, {0.3, 12}, {1, 0}}, outlines, bezrsWidthMode::ArcLength);`
+    std::size_t outlineVariable(const std::vector<bezrsWidthSample>& _profile, MultiShape& _out, bezrsWidthMode _mode = bezrsWidthMode::ArcLength, bezrsJoinType _join = bezrsJoinType::Round, bezrsCapType _cap = bezrsCapType::Round, double _mitter = 0, double _tolerance = 1e-2) const {
+        if(handle == nullptr || _out.get() == nullptr) return 0;
+        return bezrs_shape_outline_variable(handle, _profile.data(), _profile.size(), _mode, _join, _cap, _mitter, _tolerance, _out.get());
+    }
+
+    // Evenly spaced samples (see `bezrs_shape_resample()`), returns the amount of samples. `_tangents` can be null.
+    // The vectors are resized to fit : reusing them across frames avoids a 2nd pass.
+    std::size_t resample(std::vector<bezrsPos>& _positions, std::vector<bezrsPos>* _tangents, std::size_t _count, double _spacing = 0, double _startOffset = 0) const {
+        if(handle == nullptr){ _positions.clear(); if(_tangents) _tangents->clear(); return 0; }
+        std::size_t capacity = std::max(_positions.capacity(), _count);
+        for(int pass = 0; pass < 2; ++pass){
+            _positions.resize(capacity);
+            if(_tangents) _tangents->resize(capacity);
+            const std::size_t count = bezrs_shape_resample(handle, _count, _spacing, _startOffset, _positions.data(), _tangents ? _tangents->data() : nullptr, nullptr, capacity);
+            if(count <= capacity){
+                _positions.resize(count);
+                if(_tangents) _tangents->resize(count);
+                return count;
+            }
+            capacity = count;
+        }
+        return _positions.size();
+    }
+
+    // Dashes the shape into `_out` (see `bezrs_shape_dash()`), returns the amount of dashes (0 for negligible pattern lengths).
+    std::size_t dash(const std::vector<double>& _pattern, double _phase, MultiShape& _out) const {
+        if(handle == nullptr || _out.get() == nullptr) return 0;
+        return bezrs_shape_dash(handle, _pattern.data(), _pattern.size(), _phase, _out.get());
+    }
+
+    // Cuts the shape at global t-values into `_out` (see `bezrs_shape_split()`), returns the amount of pieces.
+    std::size_t split(const std::vector<double>& _ts, MultiShape& _out) const {
+        if(handle == nullptr || _out.get() == nullptr) return 0;
+        return bezrs_shape_split(handle, _ts.data(), _ts.size(), _out.get());
+    }
+    // Extracts pieces between (t0, t1) pairs into `_out`, returns the amount of pieces.
+    std::size_t extractRanges(const std::vector<std::pair<double, double>>& _ranges, MultiShape& _out) const {
+        static_assert(sizeof(std::pair<double, double>) == 2 * sizeof(double), "Ranges need to be packed pairs of doubles");
+        if(handle == nullptr || _out.get() == nullptr) return 0;
+        return bezrs_shape_extract_ranges(handle, reinterpret_cast<const double*>(_ranges.data()), _ranges.size(), _out.get());
+    }
+    // Keeps only the piece between `_t0` and `_t1` (in place, becomes an open path)
+    bool trim(double _t0, double _t1){ return handle != nullptr && bezrs_shape_trim(handle, _t0, _t1); }
+
+    // Signed distance field into `_out` (resized to `_width` x `_height`), see `bezrs_shape_sdf()`.
+    bool sdf(std::vector<float>& _out, std::size_t _width, std::size_t _height, const bezrsAffine& _gridToShape, double _maxDistance = 0) const {
+        if(handle == nullptr) return false;
+        _out.resize(_width * _height);
+        return bezrs_shape_sdf(handle, _out.data(), _width, _height, _gridToShape, _maxDistance);
+    }
+
+    // 8-bit coverage mask into `_out` (resized to `_width` x `_height`, tightly packed), see `bezrs_shape_rasterize()`.
+    bool rasterize(std::vector<uint8_t>& _out, std::size_t _width, std::size_t _height, const bezrsAffine& _gridToShape, bezrsFillRule _fillRule = bezrsFillRule::NonZero) const {
+        if(handle == nullptr) return false;
+        _out.resize(_width * _height);
+        return bezrs_shape_rasterize(handle, _out.data(), _width, _height, _width, _gridToShape, _fillRule);
+    }
+
+    // Crossings of many lines with the shape (see `bezrs_shape_intersect_lines()`) : the sorted parameters of line i
+    // are `_params[_offsets[i] .. _offsets[i+1]]`. Both vectors are resized, reusing their capacity.
+    std::size_t intersectLines(const std::vector<bezrsLine>& _lines, std::vector<SizeTC>& _offsets, std::vector<double>& _params) const {
+        if(handle == nullptr){ _offsets.assign(_lines.size() + 1, 0); _params.clear(); return 0; }
+        _offsets.resize(_lines.size() + 1);
+        std::size_t total = bezrs_shape_intersect_lines(handle, _lines.data(), _lines.size(), _offsets.data(), _params.data(), _params.size());
+        if(total > _params.size()){
+            _params.resize(total);
+            bezrs_shape_intersect_lines(handle, _lines.data(), _lines.size(), _offsets.data(), _params.data(), _params.size());
+        }
+        _params.resize(total);
+        return total;
+    }
+    // Hatch fill segments into `_out` (see `bezrs_shape_hatch()`), returns the amount of segments.
+    // Also 0 when `_spacing` is so small that it would take more than 2^20 lines to cover the shape.
+    std::size_t hatch(double _angle, double _spacing, MultiShape& _out, double _phase = 0, bezrsFillRule _fillRule = bezrsFillRule::NonZero, bool _alternate = true) const {
+        if(handle == nullptr || _out.get() == nullptr) return 0;
+        return bezrs_shape_hatch(handle, _angle, _spacing, _phase, _fillRule, _alternate, _out.get());
+    }
+
+    // Visible runs of the shape within `_rect` grown by `_margin` into `_out` (see `bezrs_shape_clip_rect()`), returns the amount of paths.
+    std::size_t clip(const bezrsRect& _rect, MultiShape& _out, double _margin = 0) const {
+        if(handle == nullptr || _out.get() == nullptr) return 0;
+        return bezrs_shape_clip_rect(handle, _rect, _margin, _out.get());
+    }
+    // Indices of the segments crossing or within `_rect` grown by `_margin`. The vector is resized, reusing its capacity.
+    std::size_t segmentsInRect(const bezrsRect& _rect, std::vector<SizeTC>& _indices, double _margin = 0) const {
+        if(handle == nullptr){ _indices.clear(); return 0; }
+        std::size_t total = bezrs_shape_segments_in_rect(handle, _rect, _margin, _indices.data(), _indices.size());
+        if(total > _indices.size()){
+            _indices.resize(total);
+            bezrs_shape_segments_in_rect(handle, _rect, _margin, _indices.data(), _indices.size());
+        }
+        _indices.resize(total);
+        return total;
+    }
+
+    // Lines and arcs within `_tolerance` for toolpaths (see `bezrs_shape_biarcs()`), starting at the first anchor.
+    // The vector is resized, reusing its capacity.
+    std::size_t biarcs(std::vector<bezrsToolpathMove>& _out, double _tolerance) const {
+        if(handle == nullptr){ _out.clear(); return 0; }
+        std::size_t total = bezrs_shape_biarcs(handle, _tolerance, _out.data(), _out.size());
+        if(total > _out.size()){
+            _out.resize(total);
+            bezrs_shape_biarcs(handle, _tolerance, _out.data(), _out.size());
+        }
+        _out.resize(total);
+        return total;
+    }
+    // Streams the moves to `_onMoves(const bezrsToolpathMove*, std::size_t)` by chunks, which returns false to stop.
+    template<typename Callback>
+    std::size_t streamBiarcs(double _tolerance, Callback&& _onMoves) const {
+        if(handle == nullptr) return 0;
+        return bezrs_shape_biarcs_stream(handle, _tolerance, [](const bezrsToolpathMove* _moves, SizeTC _len, void* _userData) -> bool {
+            return (*static_cast<std::remove_reference_t<Callback>*>(_userData))(_moves, static_cast<std::size_t>(_len));
+        }, const_cast<void*>(static_cast<const void*>(&_onMoves)));
+    }
+
+    // Precomputes acceleration data for repeated queries (hit testing, projection, bounds, extrema).
+    // Dropped on any mutation : prepare again after editing.
+    Shape& prepare(){
+        if(handle != nullptr) bezrs_shape_prepare(handle);
+        return *this;
+    }
+    bool isPrepared() const { return handle != nullptr && bezrs_shape_is_prepared(handle); }
+
+    // Polyline within `_screenTolerance` once drawn at `_scale`, from the level of detail cache (see `bezrs_shape_lod_polyline()`).
+    // Without `_build`, the nearest cached level (empty when none, or for a zero `_scale`). Valid until the shape is edited or queried again.
+    View<bezrsPos> lodPolyline(double _screenTolerance, double _scale, bool _build = true, double* _levelTolerance = nullptr){
+        if(_levelTolerance != nullptr) *_levelTolerance = 0;
+        if(handle == nullptr) return {};
+        bezrsPolylineRaw raw = bezrs_shape_lod_polyline(handle, _screenTolerance, _scale, _build);
+        if(_levelTolerance != nullptr) *_levelTolerance = raw.tolerance;
+        return { raw.data, static_cast<std::size_t>(raw.len) };
+    }
+    // Caps the cached points (16 bytes each), evicting the least recently used levels
+    Shape& setLodMaxPoints(std::size_t _maxPoints){
+        if(handle != nullptr) bezrs_shape_lod_set_max_points(handle, _maxPoints);
+        return *this;
+    }
+    std::size_t lodCachedPoints() const { return handle ? bezrs_shape_lod_cached_points(handle) : 0; }
+
+    // Queries
+    bezrsRect boundingBox() const { return handle ? bezrs_shape_boundingbox(handle) : bezrsRect{}; }
+    // Signed area, winding, centroid, length and tight bounds in one pass
+    bezrsShapeMetrics metrics(double _lengthTolerance = 1e-3) const { return handle ? bezrs_shape_metrics(handle, _lengthTolerance) : bezrsShapeMetrics{}; }
+    bool contains(const bezrsPos& _pos) const { return handle != nullptr && bezrs_shape_containspoint(handle, _pos); }
+    bezrsPos project(const bezrsPos& _pos) const { return handle ? bezrs_shape_project_pos(handle, _pos) : _pos; }
+    bezrsPos posFromTValue(double _t) const { return handle ? bezrs_shape_posfromtvalue(handle, _t) : bezrsPos{}; }
+    bezrsPos normalFromTValue(double _t) const { return handle ? bezrs_shape_normalfromtvalue(handle, _t) : bezrsPos{}; }
+    bezrsPos tangentFromTValue(double _t) const { return handle ? bezrs_shape_tangentfromtvalue(handle, _t) : bezrsPos{}; }
+    double curvatureFromTValue(double _t) const { return handle ? bezrs_shape_curvaturefromtvalue(handle, _t) : 0; }
+
+    private:
+    static View<double> floatsView(const bezrsFloatsRaw& _raw){
+        return { _raw.data, static_cast<std::size_t>(_raw.len) };
+    }
+    bezrsShape* handle = nullptr;
+};
+
+inline Shape MultiShape::extract(std::size_t _index) const {
+    return Shape(bezrs_multishape_extract_shape(handle, _index));
+}
+
+// Owning wrapper around a Rust-allocated `bezrsIncrementalOffset*` : offsets a shape being edited, recomputing only what changed.
+// Move-only, destroyed automatically.
+class IncrementalOffset {
+    public:
+    explicit IncrementalOffset(double _offset, bezrsJoinType _join = bezrsJoinType::Bevel, double _mitter = 0, double _tolerance = 0.1)
+        : handle(bezrs_incremental_offset_create(_offset, _join, _mitter, _tolerance)) {}
+    ~IncrementalOffset(){ if(handle != nullptr) bezrs_incremental_offset_destroy(handle); }
+
+    IncrementalOffset(const IncrementalOffset&) = delete;
+    IncrementalOffset& operator=(const IncrementalOffset&) = delete;
+    IncrementalOffset(IncrementalOffset&& _other) noexcept : handle(_other.handle) { _other.handle = nullptr; }
+    IncrementalOffset& operator=(IncrementalOffset&& _other) noexcept {
+        std::swap(handle, _other.handle);
+        return *this;
+    }
+
+    bezrsIncrementalOffset* get() const { return handle; }
+
+    // Changing any parameter recomputes everything on the next update
+    void setParams(double _offset, bezrsJoinType _join = bezrsJoinType::Bevel, double _mitter = 0, double _tolerance = 0.1){
+        bezrs_incremental_offset_set_params(handle, _offset, _join, _mitter, _tolerance);
+    }
+    // Offsets `_source` into `_out`, returns the amount of recomputed segments
+    std::size_t update(const Shape& _source, Shape& _out){
+        if(!_source) return 0;
+        if(!_out) _out.reset(bezrs_shape_create(nullptr, false));
+        return bezrs_incremental_offset_update(handle, _source.get(), _out.get());
+    }
+
+    private:
+    bezrsIncrementalOffset* handle = nullptr;
+};
+
+// Owning wrapper around a Rust-allocated `bezrsStrokeFitter*` : fits a growing stroke incrementally.
+// Move-only, destroyed automatically.
+class StrokeFitter {
+    public:
+    explicit StrokeFitter(double _tolerance, double _cornerAngle = 0) : handle(bezrs_stroke_fitter_create(_tolerance, _cornerAngle)) {}
+    ~StrokeFitter(){ if(handle != nullptr) bezrs_stroke_fitter_destroy(handle); }
+
+    StrokeFitter(const StrokeFitter&) = delete;
+    StrokeFitter& operator=(const StrokeFitter&) = delete;
+    StrokeFitter(StrokeFitter&& _other) noexcept : handle(_other.handle) { _other.handle = nullptr; }
+    StrokeFitter& operator=(StrokeFitter&& _other) noexcept {
+        std::swap(handle, _other.handle);
+        return *this;
+    }
+
+    bezrsStrokeFitter* get() const { return handle; }
+
+    void clear(){ bezrs_stroke_fitter_clear(handle); }
+    // Returns the total amount of points of the stroke
+    std::size_t addPoints(const bezrsPos* _points, std::size_t _len){ return bezrs_stroke_fitter_add_points(handle, _points, _len); }
+    std::size_t addPoint(const bezrsPos& _point){ return addPoints(&_point, 1); }
+    // Writes the current fit into `_shape`, returns the amount of segments
+    std::size_t toShape(Shape& _shape) const {
+        if(!_shape) _shape.reset(bezrs_shape_create(nullptr, false));
+        return bezrs_stroke_fitter_to_shape(handle, _shape.get());
+    }
+
+    private:
+    bezrsStrokeFitter* handle = nullptr;
+};
+
+// Owning wrapper around a Rust-allocated `bezrsCompoundShape*` : several subpaths filled with a fill rule (shapes with holes).
+// Move-only, destroyed automatically.
+class CompoundShape {
+    public:
+    explicit CompoundShape(bezrsFillRule _fillRule = bezrsFillRule::NonZero) : handle(bezrs_compound_create(nullptr, _fillRule)) {}
+    // Copies all shapes of a multi-shape as subpaths
+    CompoundShape(const MultiShape& _shapes, bezrsFillRule _fillRule = bezrsFillRule::NonZero){
+        bezrsMultiShapeRaw raw = bezrs_multishape_return_data(_shapes.get());
+        handle = bezrs_compound_create(&raw, _fillRule);
+    }
+    ~CompoundShape(){ if(handle != nullptr) bezrs_compound_destroy(handle); }
+
+    CompoundShape(const CompoundShape&) = delete;
+    CompoundShape& operator=(const CompoundShape&) = delete;
+    CompoundShape(CompoundShape&& _other) noexcept : handle(_other.handle) { _other.handle = nullptr; }
+    CompoundShape& operator=(CompoundShape&& _other) noexcept {
+        std::swap(handle, _other.handle);
+        return *this;
+    }
+
+    bezrsCompoundShape* get() const { return handle; }
+
+    // Replaces all subpaths in one bulk copy : `_spans` index into `_handles`.
+    void assign(const bezrsBezierHandle* _handles, std::size_t _handlesLen, const bezrsShapeSpan* _spans, std::size_t _spansLen){
+        bezrsMultiShapeRaw raw = { _handles, _handlesLen, _spans, _spansLen };
+        bezrs_compound_set_data(handle, &raw);
+    }
+    void assign(const std::vector<bezrsBezierHandle>& _handles, const std::vector<bezrsShapeSpan>& _spans){
+        assign(_handles.data(), _handles.size(), _spans.data(), _spans.size());
+    }
+    // Appends a copy of a shape as a subpath
+    CompoundShape& add(const Shape& _shape){
+        if(_shape) bezrs_compound_add_shape(handle, _shape.get());
+        return *this;
+    }
+
+    // Zero-copy views, valid until the compound shape is mutated or destroyed.
+    View<bezrsBezierHandle> handles() const {
+        bezrsMultiShapeRaw raw = bezrs_compound_return_data(handle);
+        return { raw.handles, static_cast<std::size_t>(raw.handles_len) };
+    }
+    View<bezrsShapeSpan> spans() const {
+        bezrsMultiShapeRaw raw = bezrs_compound_return_data(handle);
+        return { raw.shapes, static_cast<std::size_t>(raw.shapes_len) };
+    }
+    std::size_t size() const { return bezrs_compound_info_size(handle); }
+
+    bezrsFillRule fillRule() const { return bezrs_compound_get_fill_rule(handle); }
+    CompoundShape& setFillRule(bezrsFillRule _fillRule){
+        bezrs_compound_set_fill_rule(handle, _fillRule);
+        return *this;
+    }
+
+    // Operations (in place, see `bezrs_compound_offset()` and `bezrs_compound_outline()`)
+    CompoundShape& offset(double _offset, bezrsJoinType _join = bezrsJoinType::Bevel, double _mitter = 0){
+        bezrs_compound_offset(handle, _offset, _join, _mitter);
+        return *this;
+    }
+    CompoundShape& outline(double _distance, bezrsJoinType _join = bezrsJoinType::Bevel, bezrsCapType _cap = bezrsCapType::Butt, double _mitter = 0){
+        bezrs_compound_outline(handle, _distance, _join, _cap, _mitter);
+        return *this;
+    }
+    CompoundShape& transform(const bezrsAffine& _matrix){
+        bezrs_compound_transform(handle, _matrix);
+        return *this;
+    }
+
+    // Hatch fill segments into `_out`, holes included (see `bezrs_compound_hatch()`), returns the amount of segments.
+    // Also 0 when `_spacing` is so small that it would take more than 2^20 lines to cover the shape.
+    std::size_t hatch(double _angle, double _spacing, MultiShape& _out, double _phase = 0, bool _alternate = true) const {
+        return bezrs_compound_hatch(handle, _angle, _spacing, _phase, _alternate, _out.get());
+    }
+
+    // Queries
+    bezrsRect boundingBox() const { return bezrs_compound_boundingbox(handle); }
+    bool contains(const bezrsPos& _pos) const { return bezrs_compound_containspoint(handle, _pos); }
+
+    private:
+    bezrsCompoundShape* handle = nullptr;
+};
+
+// Owning wrapper around a Rust-allocated `bezrsMorph*` : interpolates shapes between keyframes.
+// Set the keyframes once (their correspondence is cached), then apply it every frame. Move-only, destroyed automatically.
+class Morph {
+    public:
+    Morph() : handle(bezrs_morph_create()) {}
+    ~Morph(){ if(handle != nullptr) bezrs_morph_destroy(handle); }
+
+    Morph(const Morph&) = delete;
+    Morph& operator=(const Morph&) = delete;
+    Morph(Morph&& _other) noexcept : handle(_other.handle) { _other.handle = nullptr; }
+    Morph& operator=(Morph&& _other) noexcept {
+        std::swap(handle, _other.handle);
+        return *this;
+    }
+
+    bezrsMorph* get() const { return handle; }
+
+    // Returns false (keeping the previous keyframes) when a keyframe is null, empty or degenerate : see size() for the amount of handles
+    bool setKeyframes(std::initializer_list<const Shape*> _keyframes){
+        std::vector<const bezrsShape*> shapes;
+        shapes.reserve(_keyframes.size());
+        for(const Shape* keyframe : _keyframes){
+            if(keyframe == nullptr || !*keyframe) return false;
+            shapes.push_back(keyframe->get());
+        }
+        return bezrs_morph_set_keyframes(handle, shapes.data(), shapes.size());
+    }
+    // CSS-like timing curve (ex: 0.42,0,0.58,1 for ease-in-out)
+    void setEasing(double _x1, double _y1, double _x2, double _y2){
+        bezrsPos c1 = { _x1, _y1 };
+        bezrsPos c2 = { _x2, _y2 };
+        bezrs_morph_set_easing(handle, &c1, &c2);
+    }
+    void setLinear(){ bezrs_morph_set_easing(handle, nullptr, nullptr); }
+    std::size_t size() const { return bezrs_morph_info_size(handle); }
+    bool isResampled() const { return bezrs_morph_is_resampled(handle); }
+
+    // Writes the shape at `_t` (0 -> 1 over all keyframes)
+    void apply(double _t, Shape& _target) const {
+        if(!_target) _target.reset(bezrs_shape_create(nullptr, false));
+        bezrs_morph_apply(handle, _t, _target.get());
+    }
+    // Writes the handles at `_t` into a caller-owned vector (reuses its capacity)
+    void apply(double _t, std::vector<bezrsBezierHandle>& _out) const {
+        _out.resize(size());
+        bezrs_morph_apply_handles(handle, _t, _out.data(), _out.size());
+    }
+
+    private:
+    bezrsMorph* handle = nullptr;
+};
+
+// Owning wrapper around a Rust-allocated `bezrsShapeF*` : a single precision copy of a shape for batch evaluation,
+// hit testing and flattening (about 1e-7 relative accuracy). Move-only, destroyed automatically.
+class ShapeF {
+    public:
+    ShapeF() : handle(bezrs_shapef_create(nullptr)) {}
+    explicit ShapeF(const Shape& _shape) : handle(bezrs_shapef_create(_shape.get())) {}
+    ShapeF(const std::vector<bezrsBezierHandleF>& _handles, bool _closed) : handle(bezrs_shapef_create_from_handles(_handles.data(), _handles.size(), _closed)) {}
+    ~ShapeF(){ if(handle != nullptr) bezrs_shapef_destroy(handle); }
+
+    ShapeF(const ShapeF&) = delete;
+    ShapeF& operator=(const ShapeF&) = delete;
+    ShapeF(ShapeF&& _other) noexcept : handle(_other.handle) { _other.handle = nullptr; }
+    ShapeF& operator=(ShapeF&& _other) noexcept {
+        std::swap(handle, _other.handle);
+        return *this;
+    }
+
+    bezrsShapeF* get() const { return handle; }
+
+    // Replaces the geometry (reusing the internal storage)
+    void assign(const Shape& _shape){ if(_shape) bezrs_shapef_set_shape(handle, _shape.get()); }
+    void assign(const std::vector<bezrsBezierHandleF>& _handles, bool _closed){
+        bezrs_shapef_set_handles(handle, _handles.data(), _handles.size(), _closed);
+    }
+
+    std::size_t getNumSegments() const { return bezrs_shapef_info_segments(handle); }
+    std::size_t memorySize() const { return bezrs_shapef_memory_size(handle); }
+
+    // Positions at global t-values (0 -> 1 over the whole shape), reusing the capacity of `_out`
+    void evaluate(const std::vector<float>& _ts, std::vector<bezrsPosF>& _out) const {
+        _out.resize(_ts.size());
+        bezrs_shapef_evaluate(handle, _ts.data(), _ts.size(), _out.data());
+    }
+    // 1 (inside) or 0 (outside) per point
+    void contains(const std::vector<bezrsPosF>& _points, std::vector<std::uint8_t>& _out, bezrsFillRule _fillRule = bezrsFillRule::NonZero) const {
+        _out.resize(_points.size());
+        bezrs_shapef_containspoints(handle, _points.data(), _points.size(), _fillRule, _out.data());
+    }
+    // Polyline within `_tolerance` of the curve
+    void flatten(float _tolerance, std::vector<bezrsPosF>& _out) const {
+        _out.resize(bezrs_shapef_flatten(handle, _tolerance, nullptr, 0));
+        bezrs_shapef_flatten(handle, _tolerance, _out.data(), _out.size());
+    }
+
+    private:
+    bezrsShapeF* handle = nullptr;
+};
+
+// Owning wrapper around a Rust-allocated `bezrsCancelToken*` : cancel() can be called from any thread while an operation
+// runs with `budget()`. Move-only, destroyed automatically (after the operations using it returned).
+class CancelToken {
+    public:
+    CancelToken() : handle(bezrs_cancel_token_create()) {}
+    ~CancelToken(){ if(handle != nullptr) bezrs_cancel_token_destroy(handle); }
+
+    CancelToken(const CancelToken&) = delete;
+    CancelToken& operator=(const CancelToken&) = delete;
+    CancelToken(CancelToken&& _other) noexcept : handle(_other.handle) { _other.handle = nullptr; }
+    CancelToken& operator=(CancelToken&& _other) noexcept {
+        std::swap(handle, _other.handle);
+        return *this;
+    }
+
+    bezrsCancelToken* get() const { return handle; }
+
+    void cancel() const { bezrs_cancel_token_cancel(handle); }
+    void reset() const { bezrs_cancel_token_reset(handle); }
+    bool isCancelled() const { return bezrs_cancel_token_is_cancelled(handle); }
+
+    // Budget using this token, with an optional deadline and result cap
+    bezrsBudget budget(double _timeLimitMs = 0, std::size_t _maxResults = 0) const {
+        return { _timeLimitMs, _maxResults, handle };
+    }
+
+    private:
+    bezrsCancelToken* handle = nullptr;
+};
+
+} // namespace ofxBezierRs
+
 #ifdef OFXBEZRS_DEFINE_IMGUI_HELPERS
 namespace ImGuiEx {
     void ofxBezierRsJointCombo(const char* _name, bezrsJoinType& _joinType, double* _mitter = nullptr);
@@ -0,0 +1,136 @@
+#pragma once
+#include "bezier-rs-ffi.h"
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+namespace ofxBezierRs {
+
+// Local (FFI-free) evaluator for shapes exported with `bezrs_shape_compile()`.
+// Takes the same global t-values as `bezrs_shape_posfromtvalue()` and friends.
+// Positions match the Rust side within 1e-12 of the shape's coordinate range (power basis vs de Casteljau rounding),
+// tangents and relative curvatures within 1e-9 : checked by libs/bezier-rs-ffi/tests/compiled_header.cpp.
+// The compiled data is a snapshot : recompile after mutating the shape.
+class CompiledShape {
+    public:
+    CompiledShape() = default;
+    explicit CompiledShape(bezrsShape* _shape, double _lengthTolerance = 0.001){
+        compile(_shape, _lengthTolerance);
+    }
+
+    void compile(bezrsShape* _shape, double _lengthTolerance = 0.001){
+        segments.resize(bezrs_shape_compile(_shape, nullptr, 0, _lengthTolerance));
+        if(!segments.empty()) bezrs_shape_compile(_shape, segments.data(), segments.size(), _lengthTolerance);
+    }
+
+    const std::vector<bezrsCompiledSegment>& data() const { return segments; }
+    std::size_t size() const { return segments.size(); }
+    bool empty() const { return segments.empty(); }
+    double length() const { return segments.empty() ? 0. : segments.back().length_start + segments.back().length; }
+
+    // Global t-value (0->1) to segment index + local t-value
+    std::size_t segmentFromTValue(double _t, double& _localT) const {
+        const std::size_t count = segments.size();
+        if(count == 0){ _localT = 0.; return 0; }
+        if(_t >= 1.){ _localT = 1.; return count-1; }
+        if(_t <= 0.){ _localT = 0.; return 0; }
+        const double scaled = _t * count;
+        const std::size_t index = std::min(static_cast<std::size_t>(scaled), count-1);
+        _localT = scaled - index;
+        return index;
+    }
+
+    // Segment containing a given arc length (binary search over the length prefix)
+    std::size_t segmentFromLength(double _length) const {
+        auto it = std::upper_bound(segments.begin(), segments.end(), _length, [](double l, const bezrsCompiledSegment& s){ return l < s.length_start; });
+        return it == segments.begin() ? 0 : static_cast<std::size_t>(it - segments.begin()) - 1;
+    }
+
+    // Per-segment evaluation (Horner)
+    static bezrsPos position(const bezrsCompiledSegment& _s, double _t){
+        return { ((_s.x[3]*_t + _s.x[2])*_t + _s.x[1])*_t + _s.x[0], ((_s.y[3]*_t + _s.y[2])*_t + _s.y[1])*_t + _s.y[0] };
+    }
+    static bezrsPos derivative(const bezrsCompiledSegment& _s, double _t){
+        return { (3.*_s.x[3]*_t + 2.*_s.x[2])*_t + _s.x[1], (3.*_s.y[3]*_t + 2.*_s.y[2])*_t + _s.y[1] };
+    }
+    static bezrsPos secondDerivative(const bezrsCompiledSegment& _s, double _t){
+        return { 6.*_s.x[3]*_t + 2.*_s.x[2], 6.*_s.y[3]*_t + 2.*_s.y[2] };
+    }
+    // Signed curvature, same convention as `bezrs_shape_curvaturefromtvalue()` (0 where the derivative vanishes)
+    static double curvature(const bezrsCompiledSegment& _s, double _t){
+        const bezrsPos d = derivative(_s, _t), dd = secondDerivative(_s, _t);
+        const double speed = std::sqrt(d.x*d.x + d.y*d.y);
+        const double denominator = speed*speed*speed;
+        return denominator > 0. ? (d.x*dd.y - d.y*dd.x) / denominator : 0.;
+    }
+
+    // Global t-value evaluation
+    bezrsPos position(double _t) const {
+        if(segments.empty()) return {0., 0.};
+        double lt; const std::size_t i = segmentFromTValue(_t, lt);
+        return position(segments[i], lt);
+    }
+    bezrsPos derivative(double _t) const {
+        if(segments.empty()) return {0., 0.};
+        double lt; const std::size_t i = segmentFromTValue(_t, lt);
+        return derivative(segments[i], lt);
+    }
+    bezrsPos tangent(double _t) const {
+        const bezrsPos d = derivative(_t);
+        const double l = std::sqrt(d.x*d.x + d.y*d.y);
+        return l > 0. ? bezrsPos{ d.x/l, d.y/l } : bezrsPos{ 0., 0. };
+    }
+    double curvature(double _t) const {
+        if(segments.empty()) return 0.;
+        double lt; const std::size_t i = segmentFromTValue(_t, lt);
+        return curvature(segments[i], lt);
+    }
+
+    // Batch evaluation over contiguous buffers. Each t-value looks up its own segment, so this doesn't vectorize :
+    // prefer positionsSorted() for ordered t-values, or sampleSegment() for dense sampling of a single segment.
+    void positions(const double* _t, std::size_t _count, bezrsPos* _out) const {
+        if(segments.empty()){ std::fill(_out, _out+_count, bezrsPos{0., 0.}); return; }
+        for(std::size_t i = 0; i < _count; ++i){
+            double lt; const std::size_t s = segmentFromTValue(_t[i], lt);
+            _out[i] = position(segments[s], lt);
+        }
+    }
+    // Same results as positions() for ascending t-values : they're split into runs per segment by walking forward,
+    // then each run goes through a branch-free Horner loop without lookups, which compilers vectorize.
+    void positionsSorted(const double* _t, std::size_t _count, bezrsPos* _out) const {
+        if(segments.empty()){ std::fill(_out, _out+_count, bezrsPos{0., 0.}); return; }
+        const std::size_t count = segments.size();
+        const double scale = static_cast<double>(count);
+        std::size_t i = 0;
+        for(std::size_t s = 0; s < count && i < _count; ++s){
+            std::size_t end = i;
+            if(s+1 == count) end = _count;
+            else while(end < _count && _t[end]*scale < s+1) ++end;
+            positionsInSegment(segments[s], static_cast<double>(s), scale, _t+i, end-i, _out+i);
+            i = end;
+        }
+    }
+    // Samples a single segment at `_count` evenly spaced local t-values (including both ends).
+    void sampleSegment(std::size_t _segment, std::size_t _count, bezrsPos* _out) const {
+        if(_count == 0) return;
+        const bezrsCompiledSegment& s = segments[_segment];
+        const double step = _count > 1 ? 1. / (_count-1) : 0.;
+        for(std::size_t i = 0; i < _count; ++i){
+            _out[i] = position(s, i * step);
+        }
+    }
+
+    private:
+    // Run of global t-values within one segment : local t = clamp(t * _scale - _offset, 0, 1)
+    static void positionsInSegment(const bezrsCompiledSegment& _s, double _offset, double _scale, const double* _t, std::size_t _count, bezrsPos* _out){
+        for(std::size_t i = 0; i < _count; ++i){
+            const double lt = std::min(std::max(_t[i]*_scale - _offset, 0.), 1.);
+            _out[i] = position(_s, lt);
+        }
+    }
+
+    std::vector<bezrsCompiledSegment> segments;
+};
+
+} // namespace ofxBezierRs